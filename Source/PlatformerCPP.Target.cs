@@ -10,5 +10,12 @@ public class PlatformerCPPTarget : TargetRules
 		Type = TargetType.Game;
 
 		ExtraModuleNames.AddRange( new string[] { "PlatformerCPP" } );
+
+		//Keep "stat Dimense" available in Test builds (stats are compiled out of Test by default). Needs a source build of the engine.
+		if (Target.Configuration == UnrealTargetConfiguration.Test)
+		{
+			BuildEnvironment = TargetBuildEnvironment.Unique;
+			GlobalDefinitions.Add("FORCE_USE_STATS=1");
+		}
 	}
 }
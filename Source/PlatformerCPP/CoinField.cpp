@@ -0,0 +1,198 @@
+// Copyright 2020 Ryan Gourley
+
+#include "CoinField.h"
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/Engine/StaticMesh.h"
+#include "Runtime/Engine/Classes/Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "PlatformerCPP.h"
+#include "DimenseCharacter.h"
+
+// Sets default values
+ACoinField::ACoinField(){
+	PrimaryActorTick.bCanEverTick = true;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	CollectRadius = 60.0f;
+	bRequireLineOfSight = true;
+	CellSize = 200.0f;
+	NumCollected = 0;
+}
+
+// Called when the game starts or when spawned
+void ACoinField::BeginPlay(){
+	Super::BeginPlay();
+	CreateTypeComponents();
+}
+
+void ACoinField::CreateTypeComponents(){
+	for (int32 Type = 0; Type < CoinTypes.Num(); Type++) {
+		UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, *FString::Printf(TEXT("Coins_%d"), Type));
+		Component->SetStaticMesh(CoinTypes[Type].Mesh);
+		if (CoinTypes[Type].Material) {
+			Component->SetMaterial(0, CoinTypes[Type].Material);
+		}
+		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Component->SetCastShadow(false);
+		Component->NumCustomDataFloats = 2;
+		Component->SetupAttachment(RootComponent);
+		Component->RegisterComponent();
+		TypeComponents.Add(Component);
+	}
+}
+
+int32 ACoinField::AddCoin(const FVector& Location, const int32 Type){
+	if (!TypeComponents.IsValidIndex(Type) || Type > MAX_uint8) {
+		UE_LOG(LogDimense, Error, TEXT("%s has no coin type %d"), *GetName(), Type);
+		return INDEX_NONE;
+	}
+	int32 Coin = Locations.Add(Location);
+	Types.Add(uint8(Type));
+	States.Add(0);
+	int32 Instance = TypeComponents[Type]->AddInstanceWorldSpace(FTransform(Location));
+	Instances.Add(Instance);
+	//Seeded by the coin so the same level animates the same way
+	TypeComponents[Type]->SetCustomDataValue(Instance, 0, FRandomStream(Coin).FRand(), false);
+	TypeComponents[Type]->SetCustomDataValue(Instance, 1, float(Type), true);
+	CellsAlongX.FindOrAdd(ToCell(Location.Y, Location.Z)).Add(Coin);
+	CellsAlongY.FindOrAdd(ToCell(Location.X, Location.Z)).Add(Coin);
+	return Coin;
+}
+
+int32 ACoinField::AddCoins(const TArray<FVector>& NewLocations, const int32 Type){
+	Locations.Reserve(Locations.Num() + NewLocations.Num());
+	Types.Reserve(Types.Num() + NewLocations.Num());
+	States.Reserve(States.Num() + NewLocations.Num());
+	Instances.Reserve(Instances.Num() + NewLocations.Num());
+	int32 First = INDEX_NONE;
+	for (const FVector& Location : NewLocations) {
+		int32 Coin = AddCoin(Location, Type);
+		if (Coin == INDEX_NONE) {
+			break;
+		}
+		if (First == INDEX_NONE) {
+			First = Coin;
+		}
+	}
+	return First;
+}
+
+void ACoinField::ResetCoins(){
+	for (int32 Coin = 0; Coin < States.Num(); Coin++) {
+		if (States[Coin] & Collected) {
+			States[Coin] &= ~Collected;
+			SetInstanceVisible(Coin, true);
+		}
+	}
+	NumCollected = 0;
+}
+
+int32 ACoinField::GetNumCoins() const{
+	return Locations.Num();
+}
+
+int32 ACoinField::GetNumCollected() const{
+	return NumCollected;
+}
+
+FVector ACoinField::GetCoinLocation(const int32 Coin) const{
+	return Locations.IsValidIndex(Coin) ? Locations[Coin] : FVector::ZeroVector;
+}
+
+bool ACoinField::IsCoinCollected(const int32 Coin) const{
+	return States.IsValidIndex(Coin) && (States[Coin] & Collected) != 0;
+}
+
+void ACoinField::GetCoinsInRadius(const FVector& Center, const float Radius, TArray<int32>& OutCoins) const{
+	OutCoins.Reset();
+	//The (X, Z) grid covers every coin, Y is checked per coin
+	FIntPoint MinCell = ToCell(Center.X - Radius, Center.Z - Radius);
+	FIntPoint MaxCell = ToCell(Center.X + Radius, Center.Z + Radius);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Z = MinCell.Y; Z <= MaxCell.Y; Z++) {
+			if (const TArray<int32>* Cell = CellsAlongY.Find(FIntPoint(X, Z))) {
+				for (int32 Coin : *Cell) {
+					if (!(States[Coin] & Collected) && FVector::DistSquared(Locations[Coin], Center) <= FMath::Square(Radius)) {
+						OutCoins.Add(Coin);
+					}
+				}
+			}
+		}
+	}
+}
+
+void ACoinField::CollectCoin(const int32 Coin){
+	if (!States.IsValidIndex(Coin) || (States[Coin] & Collected)) {
+		return;
+	}
+	States[Coin] |= Collected;
+	NumCollected++;
+	SetInstanceVisible(Coin, false);
+	OnCoinCollected.Broadcast(Coin, Types[Coin], CoinTypes[Types[Coin]].Value);
+}
+
+FIntPoint ACoinField::ToCell(const float Across, const float Z) const{
+	return FIntPoint(FMath::FloorToInt(Across / CellSize), FMath::FloorToInt(Z / CellSize));
+}
+
+void ACoinField::SetInstanceVisible(const int32 Coin, const bool bVisible){
+	//Collected coins shrink to nothing, so instance indices never change
+	FTransform Transform(FQuat::Identity, Locations[Coin], bVisible ? FVector::OneVector : FVector::ZeroVector);
+	TypeComponents[Types[Coin]]->UpdateInstanceTransform(Instances[Coin], Transform, true, true);
+}
+
+bool ACoinField::HasLineOfSight(const int32 Coin, const FVector& PlayerLocation, const FVector& CameraForward) const{
+	//From the coin to the player's depth along the camera axis, blocked by the same object types APickup checks
+	FVector Start = Locations[Coin];
+	FVector End = Start + CameraForward * FVector::DotProduct(PlayerLocation - Start, CameraForward);
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectParams.AddObjectTypesToQuery(ECC_Platform);
+	DIMENSE_COUNT_LINE_TRACES(1);
+	return !GetWorld()->LineTraceTestByObjectType(Start, End, ObjectParams, FCollisionQueryParams(SCENE_QUERY_STAT(CoinLineOfSight), false, this));
+}
+
+// Called every frame
+void ACoinField::Tick(float DeltaTime){
+	Super::Tick(DeltaTime);
+	ADimenseCharacter* Player = Cast<ADimenseCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (!Player || NumCollected == Locations.Num()) {
+		return;
+	}
+	DIMENSE_SCOPE(STAT_DimenseCoinField, CoinField);
+	//Only the cells under the player on the current view, so the cost doesn't grow with the number of coins
+	int32 AcrossAxis = FMath::Abs(Player->CamForwardVector.X) > 0.5f ? 1 : 0;
+	const TMap<FIntPoint, TArray<int32>>& Cells = AcrossAxis == 1 ? CellsAlongX : CellsAlongY;
+	FVector PlayerLocation = Player->GetActorLocation();
+	FVector2D Projected(PlayerLocation[AcrossAxis], PlayerLocation.Z);
+	float Reach = CollectRadius + FMath::Max(Player->MyWidth, Player->MyHeight) / 2;
+	FIntPoint MinCell = ToCell(Projected.X - Reach, Projected.Y - Reach);
+	FIntPoint MaxCell = ToCell(Projected.X + Reach, Projected.Y + Reach);
+	FBox2D PlayerRect(Projected - FVector2D(Player->MyWidth / 2, Player->MyHeight / 2), Projected + FVector2D(Player->MyWidth / 2, Player->MyHeight / 2));
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y));
+			if (!Cell) {
+				continue;
+			}
+			for (int32 Coin : *Cell) {
+				if (States[Coin] & Collected) {
+					continue;
+				}
+				FVector2D CoinProjected(Locations[Coin][AcrossAxis], Locations[Coin].Z);
+				if (PlayerRect.ComputeSquaredDistanceToPoint(CoinProjected) > FMath::Square(CollectRadius)) {
+					continue;
+				}
+				if (bRequireLineOfSight && !HasLineOfSight(Coin, PlayerLocation, Player->CamForwardVector)) {
+					continue;
+				}
+				Reached.Add(Coin);
+			}
+		}
+	}
+	//Collected after the walk, OnCoinCollected handlers may add coins
+	for (int32 Coin : Reached) {
+		CollectCoin(Coin);
+	}
+	Reached.Reset();
+}
@@ -0,0 +1,117 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CoinField.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FCoinCollectedSignature, int32, Coin, int32, Type, int32, Value);
+
+//One kind of coin, drawn by a single instanced mesh
+USTRUCT(BlueprintType)
+struct FCoinType {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Coin")
+		UStaticMesh* Mesh = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Coin", meta = (Tooltip = "Spin and bob belong in this material's world position offset. Per instance custom data 0 is a random phase (0-1) and 1 is the type index."))
+		UMaterialInterface* Material = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Coin")
+		int32 Value = 1;
+};
+
+/**
+ * Coins as plain data instead of one APickup actor each: position, state and type live in parallel arrays, every type is drawn by
+ * one hierarchical instanced mesh without collision and the animation is done by the material.
+ * Collection is resolved here once per tick: coins are hashed by where they show up on the 2D view (like UPickupSubsystem), only
+ * the cells around the player are looked at, and a coin is collected when it overlaps the player on the view. With
+ * bRequireLineOfSight, the few overlapping coins also need a clear line along the camera axis to the player, like APickup.
+ * A coin costs its arrays (about 30 bytes) plus its instance in the mesh.
+ */
+UCLASS()
+class PLATFORMERCPP_API ACoinField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ACoinField();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Coins")
+		TArray<FCoinType> CoinTypes;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Coins", meta = (Tooltip = "Distance on the 2D view from the player's center at which a coin is collected."))
+		float CollectRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Coins", meta = (Tooltip = "Coins behind a wall along the camera axis can't be collected."))
+		bool bRequireLineOfSight;
+
+	UPROPERTY(BlueprintAssignable, Category = "Coins")
+		FCoinCollectedSignature OnCoinCollected;
+
+	UFUNCTION(BlueprintCallable, Category = "Coins", meta = (Tooltip = "Places a coin and returns its index, or -1 for an unknown type."))
+		int32 AddCoin(const FVector& Location, const int32 Type);
+
+	UFUNCTION(BlueprintCallable, Category = "Coins", meta = (Tooltip = "Places a coin of Type at every location. Returns the index of the first one."))
+		int32 AddCoins(const TArray<FVector>& Locations, const int32 Type);
+
+	UFUNCTION(BlueprintCallable, Category = "Coins", meta = (Tooltip = "Brings every collected coin back."))
+		void ResetCoins();
+
+	UFUNCTION(BlueprintCallable, Category = "Coins")
+		int32 GetNumCoins() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Coins")
+		int32 GetNumCollected() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Coins")
+		FVector GetCoinLocation(const int32 Coin) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Coins")
+		bool IsCoinCollected(const int32 Coin) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Coins", meta = (Tooltip = "Coins not yet collected within Radius of Center."))
+		void GetCoinsInRadius(const FVector& Center, const float Radius, TArray<int32>& OutCoins) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Coins", meta = (Tooltip = "Collects a coin as if the player reached it."))
+		void CollectCoin(const int32 Coin);
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+private:
+	enum ECoinState : uint8 {
+		Collected = 1 << 0,
+	};
+
+	//One entry per coin in each
+	TArray<FVector> Locations;
+	TArray<uint8> Types;
+	TArray<uint8> States;
+	TArray<int32> Instances;
+
+	UPROPERTY()
+		TArray<UHierarchicalInstancedStaticMeshComponent*> TypeComponents;
+
+	TMap<FIntPoint, TArray<int32>> CellsAlongX; //Keyed by (Y, Z), for cameras looking along X
+	TMap<FIntPoint, TArray<int32>> CellsAlongY; //Keyed by (X, Z), for cameras looking along Y
+	TArray<int32> Reached;
+	float CellSize;
+	int32 NumCollected;
+
+	FIntPoint ToCell(const float Across, const float Z) const;
+	void CreateTypeComponents();
+	void SetInstanceVisible(const int32 Coin, const bool bVisible);
+	bool HasLineOfSight(const int32 Coin, const FVector& PlayerLocation, const FVector& CameraForward) const;
+};
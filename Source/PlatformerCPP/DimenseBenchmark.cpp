@@ -0,0 +1,219 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseBenchmark.h"
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/Components/BoxComponent.h"
+#include "Runtime/Engine/Classes/GameFramework/CharacterMovementComponent.h"
+#include "Runtime/Engine/Classes/GameFramework/PlayerController.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PlatformerCPP.h"
+#include "DimenseCharacter.h"
+#include "DimenseDebug.h"
+#include "NonPlatformMaster.h"
+#include "PlatformMaster.h"
+#include "SurfacePlatformComponent.h"
+
+// Sets default values
+ADimenseBenchmark::ADimenseBenchmark(){
+	PrimaryActorTick.bCanEverTick = true;
+	PlatformCounts = { 100, 1000, 10000, 100000 };
+	TicksPerRun = 1200; //Two loops of the scripted input
+	PlatformClass = APlatformMaster::StaticClass();
+	PlatformSize = FVector(200.0f, 200.0f, 50.0f);
+	PlatformSpacing = 400.0f;
+	DecorationsPerPlatform = 0;
+	DecorationSize = FVector(50.0f, 50.0f, 100.0f);
+	Seed = 1;
+	bQuitWhenDone = false;
+	Player = nullptr;
+	Decorations = nullptr;
+	RunIndex = 0;
+	RunTick = 0;
+}
+
+// Called when the game starts or when spawned
+void ADimenseBenchmark::BeginPlay(){
+	Super::BeginPlay();
+	Player = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	if (!Player || PlatformCounts.Num() == 0) {
+		UE_LOG(LogDimense, Error, TEXT("Benchmark needs a DimenseCharacter player and at least one platform count"));
+		SetActorTickEnabled(false);
+		return;
+	}
+	//Input for a tick has to be in before the character ticks
+	Player->AddTickPrerequisiteActor(this);
+	//Debug drawing would be most of the cost
+#if DIMENSE_DEBUG_ENABLED
+	DimenseDebug::SetEnabled(false);
+#endif
+	Csv = TEXT("Platforms,Decorations,Ticks,SpawnMs,TickMsMean,TickMsP50,TickMsP99,TracesPerTick,IndexQueriesPerTick,ChecksMsP50,ChecksMsP99,TransportCalls,TransportMsP50,TransportMsP99,MoveAroundCalls,MoveAroundMsP50,MoveAroundMsP99\n");
+	StartRun();
+}
+
+// Called every frame
+void ADimenseBenchmark::Tick(float DeltaTime){
+	Super::Tick(DeltaTime);
+	//The character ticked after us last frame, so its profile belongs to the input driven then
+	if (RunTick > 0) {
+		const FDimenseTickProfile& Profile = Player->GetTickProfile();
+		Samples.TickMs.Add(Profile.TickMs);
+		Samples.ChecksMs.Add(Profile.ChecksMs);
+		if (Profile.TransportCalls > 0) {
+			Samples.TransportMs.Add(Profile.TransportMs);
+		}
+		if (Profile.MoveAroundCalls > 0) {
+			Samples.MoveAroundMs.Add(Profile.MoveAroundMs);
+		}
+		Samples.Traces += Profile.Traces;
+		Samples.IndexQueries += Profile.IndexQueries;
+	}
+	if (RunTick == TicksPerRun) {
+		FinishRun();
+		if (++RunIndex < PlatformCounts.Num()) {
+			StartRun();
+		}else{
+			ClearGrid();
+			WriteCsv();
+			SetActorTickEnabled(false);
+			if (bQuitWhenDone || FApp::IsUnattended()) {
+				FPlatformMisc::RequestExit(false);
+			}
+		}
+		return;
+	}
+	DriveInput();
+	RunTick++;
+}
+
+void ADimenseBenchmark::StartRun(){
+	RunTick = 0;
+	Samples = FRunSamples();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	SpawnGrid(PlatformCounts[RunIndex]);
+	Samples.SpawnMs = float(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+	UE_LOG(LogDimense, Log, TEXT("Benchmark run %d: %d platforms spawned in %.1f ms"), RunIndex, PlatformCounts[RunIndex], Samples.SpawnMs);
+}
+
+void ADimenseBenchmark::FinishRun(){
+	int32 Ticks = FMath::Max(Samples.TickMs.Num(), 1);
+	float TickMsTotal = 0.0f;
+	for (float Ms : Samples.TickMs) {
+		TickMsTotal += Ms;
+	}
+	Csv += FString::Printf(TEXT("%d,%d,%d,%.3f,%.4f,%.4f,%.4f,%.2f,%.2f,%.4f,%.4f,%d,%.4f,%.4f,%d,%.4f,%.4f\n"),
+		PlatformCounts[RunIndex], PlatformCounts[RunIndex] * DecorationsPerPlatform, Samples.TickMs.Num(), Samples.SpawnMs,
+		TickMsTotal / Ticks, Percentile(Samples.TickMs, 0.5f), Percentile(Samples.TickMs, 0.99f),
+		float(Samples.Traces) / Ticks, float(Samples.IndexQueries) / Ticks,
+		Percentile(Samples.ChecksMs, 0.5f), Percentile(Samples.ChecksMs, 0.99f),
+		Samples.TransportMs.Num(), Percentile(Samples.TransportMs, 0.5f), Percentile(Samples.TransportMs, 0.99f),
+		Samples.MoveAroundMs.Num(), Percentile(Samples.MoveAroundMs, 0.5f), Percentile(Samples.MoveAroundMs, 0.99f));
+}
+
+void ADimenseBenchmark::SpawnGrid(const int32 Count){
+	ClearGrid();
+	//Square grid across X/Y with seeded heights, so the character finds platforms to Transport to and walls to MoveAround
+	FRandomStream Stream(Seed);
+	int32 Side = FMath::CeilToInt(FMath::Sqrt(float(Count)));
+	FVector Origin = GetActorLocation() - FVector(Side * PlatformSpacing / 2, Side * PlatformSpacing / 2, 0.0f);
+	FVector PlayerStart = Origin;
+	Platforms.Reserve(Count);
+	for (int32 i = 0; i < Count; i++) {
+		int32 X = i % Side;
+		int32 Y = i / Side;
+		FVector Location = Origin + FVector(X * PlatformSpacing, Y * PlatformSpacing, Stream.RandRange(0, 3) * PlatformSize.Z * 2);
+		FTransform Transform(Location);
+		APlatformMaster* Platform = GetWorld()->SpawnActorDeferred<APlatformMaster>(PlatformClass, Transform);
+		if (!Cast<UPrimitiveComponent>(Platform->GetRootComponent())) {
+			UBoxComponent* Box = NewObject<UBoxComponent>(Platform, TEXT("BenchmarkCollision"));
+			Box->SetBoxExtent(PlatformSize / 2);
+			Box->SetCollisionProfileName(TEXT("PlatformStatic"));
+			Box->SetWorldTransform(Transform);
+			Platform->SetRootComponent(Box);
+			Box->RegisterComponent();
+			NewObject<USurfacePlatformComponent>(Platform, TEXT("BenchmarkSurface"))->RegisterComponent();
+		}
+		UGameplayStatics::FinishSpawningActor(Platform, Transform);
+		Platforms.Add(Platform);
+		if (X == Side / 2 && Y == Side / 2) {
+			PlayerStart = FVector(Location.X, Location.Y, Platform->GetTopZ());
+		}
+	}
+	if (DecorationsPerPlatform > 0) {
+		SpawnDecorations(Origin, Side, Stream);
+	}
+	//Start every run standing still on the middle platform
+	Player->SetActorLocation(PlayerStart + FVector(0.0f, 0.0f, Player->MyHeight), false, nullptr, ETeleportType::TeleportPhysics);
+	Player->GetCharacterMovement()->Velocity = FVector::ZeroVector;
+}
+
+void ADimenseBenchmark::SpawnDecorations(const FVector& Origin, const int32 Side, FRandomStream& Stream){
+	//One actor holding every box, scattered through the cells at platform heights so the probes have scenery to pass through
+	Decorations = GetWorld()->SpawnActor<ANonPlatformMaster>(ANonPlatformMaster::StaticClass(), FTransform(Origin));
+	USceneComponent* Root = NewObject<USceneComponent>(Decorations, TEXT("BenchmarkDecorationRoot"));
+	Decorations->SetRootComponent(Root);
+	Root->RegisterComponent();
+	int32 Count = Platforms.Num() * DecorationsPerPlatform;
+	for (int32 i = 0; i < Count; i++) {
+		int32 Cell = i / DecorationsPerPlatform;
+		FVector Location = Origin + FVector(
+			((Cell % Side) + Stream.FRandRange(-0.5f, 0.5f)) * PlatformSpacing,
+			((Cell / Side) + Stream.FRandRange(-0.5f, 0.5f)) * PlatformSpacing,
+			Stream.FRandRange(0.0f, 8.0f) * PlatformSize.Z);
+		UBoxComponent* Box = NewObject<UBoxComponent>(Decorations);
+		Box->SetBoxExtent(DecorationSize / 2);
+		Box->SetCollisionProfileName(TEXT("Decoration"));
+		Box->SetupAttachment(Root);
+		Box->SetWorldLocation(Location);
+		Box->RegisterComponent();
+	}
+}
+
+void ADimenseBenchmark::ClearGrid(){
+	for (APlatformMaster* Platform : Platforms) {
+		if (Platform) {
+			Platform->Destroy();
+		}
+	}
+	Platforms.Reset();
+	if (Decorations) {
+		Decorations->Destroy();
+		Decorations = nullptr;
+	}
+}
+
+void ADimenseBenchmark::DriveInput(){
+	//600 tick loop: walk right, jump, walk left, jump down, walk right, rotate the camera, walk left
+	int32 Step = RunTick % 600;
+	if (Step == 150) {
+		Player->Jump();
+	}else if (Step == 160) {
+		Player->StopJumping();
+	}else if (Step == 300) {
+		Player->JumpDown();
+	}else if (Step == 450) {
+		Player->RotateCamera(90.0f);
+	}
+	Player->MoveLeftRight(Step < 150 || (Step >= 300 && Step < 450) ? 1.0f : -1.0f);
+}
+
+void ADimenseBenchmark::WriteCsv() const{
+	FString Path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Dimense"), FString::Printf(TEXT("Benchmark-%s.csv"), *FDateTime::Now().ToString()));
+	if (FFileHelper::SaveStringToFile(Csv, *Path)) {
+		UE_LOG(LogDimense, Log, TEXT("Benchmark written to %s"), *Path);
+	}else{
+		UE_LOG(LogDimense, Error, TEXT("Could not write benchmark to %s"), *Path);
+	}
+}
+
+float ADimenseBenchmark::Percentile(TArray<float> Values, const float Fraction){
+	//Nearest rank
+	if (Values.Num() == 0) {
+		return 0.0f;
+	}
+	Values.Sort();
+	int32 Rank = FMath::Clamp(FMath::CeilToInt(Fraction * Values.Num()) - 1, 0, Values.Num() - 1);
+	return Values[Rank];
+}
@@ -0,0 +1,98 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "DimenseBenchmark.generated.h"
+
+class ADimenseCharacter;
+class APlatformMaster;
+class ANonPlatformMaster;
+
+/**
+ * Measures what the movement system costs as levels grow.
+ * For every entry in PlatformCounts it spawns a seeded grid of platforms, drives the player with a scripted input loop (walk, jump,
+ * jump down, rotate camera) for TicksPerRun ticks and writes one CSV row per run to Saved/Profiling/Dimense.
+ * DecorationsPerPlatform fills the grid with scenery (Decoration profile) to measure what it adds to the movement queries.
+ * Headless: UE4Editor PlatformerCPP.uproject Level01 -game -nullrhi -unattended -ExecCmds="DimenseBenchmark"
+ */
+UCLASS()
+class PLATFORMERCPP_API ADimenseBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ADimenseBenchmark();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (Tooltip = "Number of platforms in each run."))
+		TArray<int32> PlatformCounts;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = "1"))
+		int32 TicksPerRun;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (Tooltip = "Platform to spawn. Classes without a collision root (the C++ base class) get a box collider and a surface component."))
+		TSubclassOf<APlatformMaster> PlatformClass;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+		FVector PlatformSize;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (Tooltip = "Distance between platform centers on the grid."))
+		float PlatformSpacing;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = "0", Tooltip = "Scenery boxes scattered around each platform, in the gaps the Transport, MoveAround and visibility probes cross."))
+		int32 DecorationsPerPlatform;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+		FVector DecorationSize;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (Tooltip = "Seed for the platform heights, keep it fixed to compare runs across commits."))
+		int32 Seed;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (Tooltip = "Quit the game when every run is written (always on with -unattended)."))
+		bool bQuitWhenDone;
+
+	//Nearest rank percentile (Fraction 0-1) of Values, 0 if empty
+	static float Percentile(TArray<float> Values, const float Fraction);
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+private:
+	struct FRunSamples {
+		TArray<float> TickMs;
+		TArray<float> ChecksMs;
+		TArray<float> TransportMs;
+		TArray<float> MoveAroundMs;
+		int64 Traces = 0;
+		int64 IndexQueries = 0;
+		float SpawnMs = 0.0f;
+	};
+
+	UPROPERTY()
+		ADimenseCharacter* Player;
+
+	UPROPERTY()
+		TArray<APlatformMaster*> Platforms;
+
+	UPROPERTY()
+		ANonPlatformMaster* Decorations;
+
+	int32 RunIndex;
+	int32 RunTick;
+	FRunSamples Samples;
+	FString Csv;
+
+	void StartRun();
+	void FinishRun();
+	void SpawnGrid(const int32 Count);
+	void SpawnDecorations(const FVector& Origin, const int32 Side, FRandomStream& Stream);
+	void ClearGrid();
+	void DriveInput();
+	void WriteCsv() const;
+};
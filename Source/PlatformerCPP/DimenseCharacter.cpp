@@ -15,31 +15,84 @@
 #include "Runtime/Engine/Classes/Components/SkeletalMeshComponent.h"
 #include "Runtime/Engine/Classes/Engine/World.h"
 #include "Runtime/Engine/Classes/Engine/Engine.h"
+#include "Runtime/Engine/Classes/GameFramework/WorldSettings.h"
 #include "Runtime/Engine/Public/WorldCollision.h"
+#include "Net/UnrealNetwork.h"
 #include "DrawDebugHelpers.h"
+#include "PlatformerCPP.h"
+#include "DimenseMovementRules.h"
 #include "DimensePlayerController.h"
 #include "PlatformMaster.h"
-#include "SurfacePlatformComponent.h"
+#include "PlatformProjectionSubsystem.h"
+
+namespace {
+	//Adds the time spent in its scope to a FDimenseTickProfile field
+	struct FProfileScope {
+		float& Ms;
+		const uint64 StartCycles;
+		explicit FProfileScope(float& InMs) : Ms(InMs), StartCycles(FPlatformTime::Cycles64()) {}
+		~FProfileScope() { Ms += float(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)); }
+	};
+}
 
 // Sets default values
-ADimenseCharacter::ADimenseCharacter(){
+ADimenseCharacter::ADimenseCharacter(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer.SetDefaultSubobjectClass<UDimenseMovementComponent>(ACharacter::CharacterMovementComponentName)){
 	//Unreal Variables
 	PrimaryActorTick.bCanEverTick = true;
+	NetUpdateFrequency = 30.0f; //Simulated proxies interpolate between updates, the owner predicts, so half the frame rate is plenty
 
 	//My Variables
-	bDebug = true; //Is debug print, views, control panel, etc. enabled?
-	bDebugVisibility = false;
-	bDebugGround = true;
-	bDebugTransport = true;
-	bDebugAbovePlatform = true;
-	bDebugMoveAround = true;
-	bDebugInvalidation = true;
-	bDebugCachedInvalidation = false;
-	bDebugPlatformRemote = true; //Is debug drawing for platform checks by platforms?
+	bDebug = false; //Mirrors dimense.Debug (debug print, views, control panel, etc.)
+	bDebugPlatformRemote = true; //Mirrors dimense.Debug.PlatformRemote (debug drawing for platform checks by platforms)
+	bDebugSynced = bDebug;
+	bDebugPlatformRemoteSynced = bDebugPlatformRemote;
 	bCanMoveAround = true; //Can the movement system move the character around walls?
 	bCanTransport = true; //Can the movement system move the character to platforms "based on a 2 dimensional view"?
 	bSpinning = false; //Is the camera actively spinning to a new 90 degree view?
+	SpinTime = 0.6f; //Time it takes the camera to turn to a new 90 degree view
+	bShortSpin = false; //Does the camera turn quickly without pausing movement?
+	ShortSpinTime = 0.15f;
+	SpinTargetYaw = 0.0f;
+	bSpinPausedMovement = false;
+	MaxRewindSeconds = 5.0f; //Seconds of movement that can be rewound
+	HistoryRate = 60.0f; //Movement states kept per second
+	RewindSpeed = 1.0f; //Seconds rewound per second of holding Rewind
+	bAutoCheckpoint = true;
+	bHasCheckpoint = false;
+	NetTeleportTolerance = 50.0f;
+	NetRespawnFallDepth = 1000.0f;
+	bDiedOnServer = false;
+	ServerViewIndex = 0;
+	SentViewIndex = 0;
+	TeleportCount = 0;
+	NumTeleportsRejected = 0;
+	bRewinding = false;
+	HistoryClock = 0.0f;
+	RewindClock = 0.0f;
 	bIsInside = false;
+	bAsyncMovementQueries = true; //Are the movement probes traced as one async batch (results used the next tick)?
+	SyncQuerySampleInterval = 120; //Every Nth tick runs synchronously while async, to keep the "ms saved" stat current
+	AsyncProbeTolerance = 15.0f; //About a frame of walking
+	bUsePlatformIndex = true; //Are Transport/MoveAround platforms looked up in the projection index instead of swept for?
+	bUseOcclusionBuffer = true; //Is the player's visibility read from the projection index's occlusion buffers instead of traced?
+	ProjectionIndex = nullptr;
+	bDeferredQueriesThisTick = false;
+	TicksUntilSyncSample = 0;
+	SyncQueryMs = 0.0f;
+	AsyncQueryMs = 0.0f;
+	bFixedStepSimulation = false; //Is movement simulated in fixed steps (frame rate independent decisions) instead of once per frame?
+	FixedStepRate = 60.0f; //Steps per second while bFixedStepSimulation
+	MaxStepsPerFrame = 8; //Steps beyond this in one frame are dropped
+	bFixedStepScriptedInput = false;
+	SimulationStep = 0;
+	bFixedStepActive = false;
+	bSnapRenderLocation = false;
+	StepAccumulator = 0.0f;
+	DecisionChecksum = 0;
+	HeldMovementInput = FVector::ZeroVector;
+	PreviousStepLocation = FVector::ZeroVector;
+	MeshBaseRelativeLocation = FVector::ZeroVector;
+	CameraBaseRelativeLocation = FVector::ZeroVector;
 	PhysicsComp = GetCapsuleComponent(); //Set the physics component
 	MyHeight = PhysicsComp->GetScaledCapsuleHalfHeight(); //Player Height
 	MyWidth = PhysicsComp->GetScaledCapsuleRadius(); //Player Width
@@ -62,6 +115,8 @@ ADimenseCharacter::ADimenseCharacter(){
 	//Debug Trace Tagging
 	TraceTag = FName(TEXT("TraceTag"));
 	QParams = FCollisionQueryParams(TraceTag, false, this);
+	PlatformObjectParams = FCollisionObjectQueryParams(ECC_Platform);
+	ViewOrientation = DimenseCore::EViewOrientation::PosX;
 
 	//SubObjects------------------------------------------------------------------------------------------------------------------>>>
 
@@ -112,12 +167,25 @@ ADimenseCharacter::ADimenseCharacter(){
 // Called when the game starts or when spawned
 void ADimenseCharacter::BeginPlay(){
 	Super::BeginPlay(); // DO NOT remove
+	ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>();
+	MeshBaseRelativeLocation = GetMesh()->GetRelativeLocation();
+	CameraBaseRelativeLocation = RotationSpringArm->GetRelativeLocation();
+	MovementHistory.Reset(FMath::CeilToInt(MaxRewindSeconds * HistoryRate) + 1);
+	NetCheckpointLocation = GetActorLocation();
+	ServerViewIndex = GetViewIndex(); //Both ends spawn with the same arm
+	SentViewIndex = ServerViewIndex;
 	InitDebug();
 }
 
 // Called every frame
 void ADimenseCharacter::Tick(float DeltaTime){
+	TickProfile.Reset();
+	DIMENSE_SCOPE(STAT_DimenseTick, DimenseTick);
+	FProfileScope ProfileScope(TickProfile.TickMs);
 	Super::Tick(DeltaTime); // DO NOT remove
+	if (ADimensePlayerController* DimenseController = Cast<ADimensePlayerController>(GetController())) {
+		DimenseController->GetInputRecorder().TickCharacter(this, DeltaTime); //Ends the recorded input frame, or plays the next one back
+	}
 
 	//Keep track of the order of things here. The following order is most logical.
 	//1: add movement from input (needs to happen before platform checks so they can happen in the same frame, in that order)
@@ -126,31 +194,67 @@ void ADimenseCharacter::Tick(float DeltaTime){
 	//4: set ground location if on platform (need the platform first)
 	//5: rotate the character mesh to the player movement (this could change if platform checks moves the character, so it should be after)
 
-	if (!bSpinning) {
-		//Some variables need to be updated every frame, but only while not spinning/rotating camera because movement is paused
-		AddMovementInput(GetMovementInputFRI()); //Player movement. This should remain at the beginning of tick
-		UpdateMovementSystemVariables();
-		DoLineTracesAndPlatformChecks(); //Line traces used by the movement system to determine when and where to move the player from/to platforms
+	//Fixed steps tick the movement component outside of its own tick, which the network prediction can't follow
+	if ((bFixedStepSimulation && !IsNetworked()) != bFixedStepActive) {
+		SetFixedStepActive(bFixedStepSimulation && !IsNetworked());
+	}
+	if (!RunsMovementSystem()) {
+		//Someone else's character, its owner decides where it goes and the movement component replicates that
+	}else if (bRewinding) {
+		TickRewind(DeltaTime);
+	}else if (!bSpinning || !bSpinPausedMovement) {
+		if (bFixedStepActive) {
+			TickFixedStep(DeltaTime); //Steps 1-3 below run once per fixed step instead of once per frame
+		}else{
+			//Some variables need to be updated every frame, but only while movement isn't paused by a camera spin (a short spin doesn't pause it)
+			AddMovementInput(GetMovementInputFRI()); //Player movement. This should remain at the beginning of tick
+			SCOPE_CYCLE_COUNTER(STAT_DimenseMovementQueries);
+			const uint32 QueryStartCycles = FPlatformTime::Cycles();
+			BeginMovementQueries(); //Pick up the async probe results from last tick (if any)
+			UpdateMovementSystemVariables();
+			DoLineTracesAndPlatformChecks(); //Line traces used by the movement system to determine when and where to move the player from/to platforms
+			EndMovementQueries(QueryStartCycles); //Queue the next tick's probes
+		}
+	}else{
+		StepAccumulator = 0.0f; //Movement is paused while spinning, don't catch up afterwards
+		PrepareSpinTarget();
 	}
 	if (GroundPlatform) { //If valid ground platform found
-		FVector Origin; FVector Extent;
-		GroundPlatform->GetActorBounds(true, Origin, Extent);
-		float GroundZ = GroundPlatform->GetActorLocation().Z + Extent.Z;
+		float GroundZ = GroundPlatform->GetTopZ();
 		FVector PlayerLocation = GetActorLocation();
 		GroundLocation = FVector(PlayerLocation.X, PlayerLocation.Y, GroundZ); //Set the ground location
+		if (bAutoCheckpoint && !bRewinding && !GetCharacterMovement()->IsFalling() && (!bHasCheckpoint || Checkpoint.Platforms[FDimenseMovementState::Ground].Get() != GroundPlatform)) {
+			SetCheckpoint(); //Landed on a new platform
+		}
+	}
+	if (IsNetworked() && (HasAuthority() || IsLocallyControlled())) {
+		UpdateNetCheckpoint();
+	}
+	if (GetLocalRole() == ROLE_AutonomousProxy) {
+		SendViewIndex();
+	}
+	if (RunsMovementSystem() && !bRewinding && (!bSpinning || !bSpinPausedMovement)) {
+		RecordHistory(DeltaTime);
 	}
 	if (GroundPlatform || FacingDirection != 0) {
 		RotateMeshToMovement();
 	}
 	//Enable/Disable custom debug drawing/output (Platform outlines for example)
-	if (bDebug) {
+#if DIMENSE_DEBUG_ENABLED
+	SyncDebugMirrors();
+	if (DIMENSE_DEBUG(Panel)) {
 		Debug();
+	}else{
+		DebugPanel.Hide();
 	}
+#endif
 }
 
 void ADimenseCharacter::DoLineTracesAndPlatformChecks(){
+	DIMENSE_SCOPE(STAT_DimensePlatformChecks, DoLineTracesAndPlatformChecks);
+	FProfileScope ProfileScope(TickProfile.ChecksMs);
 	//Check if the player is on the ground...
-	if (BoxTraceVertical(FootLocation, GroundHitResult, FVector(MyWidth/2, MyWidth/2, GroundTraceLength), GroundTraceLength, -1, TEXT("Ground"), 0, true)) { //if you are on the ground
+	if (BoxTraceVertical(FootLocation, GroundHitResult, FVector(MyWidth/2, MyWidth/2, GroundTraceLength), GroundTraceLength, -1, TEXT("Ground"), 0, true, EDimenseProbe::Ground)) { //if you are on the ground
 		//if (PlayerAbovePlatformCheck(Cast<APlatformMaster>(GroundHitResult.GetActor()))) {
 			SetPlatform(GroundPlatform, CachedGroundPlatform, GroundHitResult, FColor::FromHex(TEXT("240B00FF")), true); //brown
 		//}
@@ -163,8 +267,8 @@ void ADimenseCharacter::DoLineTracesAndPlatformChecks(){
 			}else{
 				//Check if there is something above and if so, move "around" it (forward or backward)
 				if (VisibilitySide != 0) {
-					if (BoxTraceVertical(HeadLocation, HeadHitResult, FVector(MyWidth/2, MyWidth/2, HeadTraceLength), 1, 1, TEXT("Head"), 1, true)) {
-						TryMoveAround(HeadHitResult, FVector(0.0f, 0.0f, HeadTraceLength));
+					if (BoxTraceVertical(HeadLocation, HeadHitResult, FVector(MyWidth/2, MyWidth/2, HeadTraceLength), 1, 1, TEXT("Head"), 1, true, EDimenseProbe::Head)) {
+						TryMoveAround(HeadHitResult, FVector(0.0f, 0.0f, HeadTraceLength), EDimenseProbe::MoveAroundHead);
 					}
 				}
 			}
@@ -173,82 +277,274 @@ void ADimenseCharacter::DoLineTracesAndPlatformChecks(){
 
 	if (MovementDirection == 0 || VisibilitySide == 0 || bIsInside) { return; }
 	if (HorizontalHitCheck(LeftRightHitResult)) {
-		TryMoveAround(LeftRightHitResult, NullVector);
+		TryMoveAround(LeftRightHitResult, NullVector, EDimenseProbe::MoveAroundSide);
 	}
 }
 
-bool ADimenseCharacter::HorizontalHitCheck(FHitResult& HitResult){
+void ADimenseCharacter::BeginMovementQueries(){
+	bDeferredQueriesThisTick = false;
+	if (!bAsyncMovementQueries) {
+		return;
+	}
+	MovementQueries.Gather(GetWorld());
+	//Every SyncQuerySampleInterval ticks run synchronously, so the cost of the blocking path stays measured while async is on
+	if (SyncQuerySampleInterval > 0 && --TicksUntilSyncSample <= 0) {
+		TicksUntilSyncSample = SyncQuerySampleInterval;
+		return;
+	}
+	bDeferredQueriesThisTick = true;
+}
+
+void ADimenseCharacter::EndMovementQueries(const uint32 StartCycles){
+	//Smoothed cost of the query phase (variables, probes and platform checks) for each path
+	uint32 EndCycles = FPlatformTime::Cycles();
+	if (bAsyncMovementQueries) {
+		SubmitMovementQueries();
+		//The submit is part of what the async path costs, a sync sample stops before it
+		if (bDeferredQueriesThisTick) {
+			EndCycles = FPlatformTime::Cycles();
+		}
+	}else{
+		MovementQueries.Invalidate();
+		AsyncQueryMs = 0.0f; //Measured again from scratch when async comes back on
+		SET_FLOAT_STAT(STAT_DimenseQueryMsSaved, 0.0f);
+	}
+	float QueryMs = FPlatformTime::ToMilliseconds(EndCycles - StartCycles);
+	float& SmoothedMs = bDeferredQueriesThisTick ? AsyncQueryMs : SyncQueryMs;
+	SmoothedMs = SmoothedMs > 0.0f ? FMath::Lerp(SmoothedMs, QueryMs, 0.1f) : QueryMs;
+	SET_FLOAT_STAT(STAT_DimenseSyncQueryMs, SyncQueryMs);
+	SET_FLOAT_STAT(STAT_DimenseAsyncQueryMs, AsyncQueryMs);
+	if (SyncQueryMs > 0.0f && AsyncQueryMs > 0.0f) {
+		SET_FLOAT_STAT(STAT_DimenseQueryMsSaved, SyncQueryMs - AsyncQueryMs);
+	}
+}
+
+void ADimenseCharacter::SubmitMovementQueries(){
+	//Queue every probe the next tick could ask for. Positions are taken after this tick's platform checks, so any Transport/MoveAround offset is already applied.
+	FootLocation = GetActorLocation() - (FVector(0.0f, 0.0f, MyHeight / 2));
+	HeadLocation = FootLocation + FVector(0.0f, 0.0f, MyHeight);
+	FQuat CameraQuat = GetViewQuat();
 	FVector Start;
 	FVector End;
-	FVector Distance = FVector(MoveAroundTraceLength, MoveAroundTraceLength, 0.0f) * CamRightVector;
-	float debugLifeTime = 0.01f;
-	float debugThickness = 10.0f;
 
-	Start = FootLocation + (CamRightVector + CamForwardVector) * (MyWidth / 2) * MovementDirection;
-	End = Start + Distance * MovementDirection;
-	if (SingleTrace(HitResult, Start, End)) {
-		//UE_LOG(LogTemp, Warning, TEXT("LeftHit0"));
-		return true;
-	}
-	if (bDebug && bDebugMoveAround) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
-	}
-	Start = FootLocation + (CamRightVector - CamForwardVector) * (MyWidth / 2) * MovementDirection;
-	End = Start + Distance * MovementDirection;
-	if (SingleTrace(HitResult, Start, End)) {
-		//UE_LOG(LogTemp, Warning, TEXT("LeftHit1"));
-		return true;
+	//Ground (same box as DoLineTracesAndPlatformChecks)
+	MovementQueries.AddSweep(EDimenseProbe::Ground, FootLocation, FootLocation - FVector(0.0f, 0.0f, GroundTraceLength), FQuat(0, 0, 0, 0), ECC_Platform, FCollisionShape::MakeBox(FVector(MyWidth / 2, MyWidth / 2, GroundTraceLength)));
+	//Visibility from the camera and from the opposite side, unless the occlusion buffers are answering it
+	if (!bUseOcclusionBuffer || !ProjectionIndex) {
+		FVector FrontStart = GetViewLocation(MainCamera);
+		FVector BackStart = GetViewLocation(AntiCameraSceneComponent);
+		for (int32 i = 0; i < 4; i++) {
+			End = GetVisibilityProbeEnd(i);
+			MovementQueries.AddLineTrace(FDimenseMovementQueries::OffsetProbe(EDimenseProbe::VisibilityFront0, i), FrontStart, End, ECC_Platform);
+			MovementQueries.AddLineTrace(FDimenseMovementQueries::OffsetProbe(EDimenseProbe::VisibilityBack0, i), BackStart, End, ECC_Platform);
+		}
 	}
-	if (bDebug && bDebugMoveAround) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
+	if (!bIsInside) {
+		MovementQueries.AddSweep(EDimenseProbe::Head, HeadLocation, HeadLocation + FVector(0.0f, 0.0f, 1.0f), FQuat(0, 0, 0, 0), ECC_Platform, FCollisionShape::MakeBox(FVector(MyWidth / 2, MyWidth / 2, HeadTraceLength)));
+		//One orientation for the whole batch, placing the probes is then picking axes and flipping signs
+		DimenseCore::DispatchView(ViewOrientation, [&](auto View){
+			using FView = decltype(View);
+			//Horizontal probes only exist while moving
+			if (MovementDirection != 0) {
+				for (int32 i = 0; i < 6; i++) {
+					GetHorizontalProbe<FView>(i, Start, End);
+					MovementQueries.AddLineTrace(FDimenseMovementQueries::OffsetProbe(EDimenseProbe::Horizontal0, i), Start, End, ECC_Platform, MovementDirection);
+				}
+			}
+			//The camera axis sweeps are only needed when the projection index isn't answering them
+			if (!bUsePlatformIndex || !ProjectionIndex) {
+				GetTransportSweep<FView>(TransportTraceZOffset, Start, End);
+				MovementQueries.AddSweep(EDimenseProbe::Transport, Start, End, CameraQuat, ECC_Platform, FCollisionShape::MakeBox(FVector(MyWidth / 2, MyWidth / 2, 0.0f)), VisibilitySide);
+				GetMoveAroundSweep<FView>(FVector(0.0f, 0.0f, HeadTraceLength), Start, End);
+				MovementQueries.AddSweep(EDimenseProbe::MoveAroundHead, Start, End, CameraQuat, ECC_Platform, FCollisionShape::MakeBox(MoveAroundBoxSize), VisibilitySide);
+				if (MovementDirection != 0) {
+					GetMoveAroundSweep<FView>(NullVector, Start, End);
+					MovementQueries.AddSweep(EDimenseProbe::MoveAroundSide, Start, End, CameraQuat, ECC_Platform, FCollisionShape::MakeBox(MoveAroundBoxSize), VisibilitySide);
+				}
+			}
+		});
 	}
+	int32 Submitted = MovementQueries.Submit(GetWorld(), QParams);
+	TickProfile.Traces += Submitted;
+	INC_DWORD_STAT_BY(STAT_DimenseAsyncProbes, Submitted);
+}
 
-	Start = GetActorLocation() + (CamRightVector + CamForwardVector) * (MyWidth / 2) * MovementDirection;
-	End = Start + Distance * MovementDirection;
-	if (SingleTrace(HitResult, Start, End)) {
-		//UE_LOG(LogTemp, Warning, TEXT("LeftHit2"));
-		return true;
-	}
-	if (bDebug && bDebugMoveAround) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
-	}
-	Start = GetActorLocation() + (CamRightVector - CamForwardVector) * (MyWidth / 2) * MovementDirection;
-	End = Start + Distance * MovementDirection;
-	if (SingleTrace(HitResult, Start, End)) {
-		//UE_LOG(LogTemp, Warning, TEXT("LeftHit3"));
-		return true;
-	}
-	if (bDebug && bDebugMoveAround) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
-	}
+void ADimenseCharacter::SetFixedStepActive(const bool bActive){
+	//While fixed, the movement component is ticked by the steps, so its own frame tick is turned off
+	bFixedStepActive = bActive;
+	GetCharacterMovement()->SetComponentTickEnabled(!bActive);
+	StepAccumulator = 0.0f;
+	PreviousStepLocation = GetActorLocation();
+	SetRenderOffset(NullVector);
+	MovementQueries.Invalidate(); //Steps trace synchronously, async results would lag a frame behind the step
+	ResetDecisionChecksum();
+}
 
-	Start = HeadLocation + (CamRightVector + CamForwardVector) * (MyWidth / 2) * MovementDirection;
-	End = Start + Distance * MovementDirection;
-	if (SingleTrace(HitResult, Start, End)) {
-		//UE_LOG(LogTemp, Warning, TEXT("LeftHit4"));
-		return true;
+void ADimenseCharacter::TickFixedStep(const float DeltaTime, const int32 StepLimit){
+	//Input is sampled once per frame and held for every step until the next frame
+	HeldMovementInput = ConsumeMovementInputVector();
+	SetRenderOffset(NullVector); //Step from the simulated location, not the drawn one
+	const float StepSeconds = 1.0f / FixedStepRate;
+	StepAccumulator += DeltaTime;
+	int32 Steps = 0;
+	while (StepAccumulator >= StepSeconds && Steps < FMath::Min(MaxStepsPerFrame, StepLimit)) {
+		PreviousStepLocation = GetActorLocation();
+		SimulateMovementStep(StepSeconds);
+		StepAccumulator -= StepSeconds;
+		Steps++;
+	}
+	if (StepAccumulator >= StepSeconds) {
+		StepAccumulator = FMath::Fmod(StepAccumulator, StepSeconds);
+	}
+	//Transport/MoveAround/Respawn are teleports, don't slide the mesh across them
+	if (bSnapRenderLocation) {
+		PreviousStepLocation = GetActorLocation();
+		bSnapRenderLocation = false;
+	}
+	//Draw the character between the last two steps
+	FVector RenderLocation = FMath::Lerp(PreviousStepLocation, GetActorLocation(), StepAccumulator / StepSeconds);
+	SetRenderOffset(RenderLocation - GetActorLocation());
+}
+
+void ADimenseCharacter::SimulateMovementStep(const float StepSeconds){
+	SCOPE_CYCLE_COUNTER(STAT_DimenseMovementQueries);
+	UpdateMovementSystemVariables();
+	if (bFixedStepScriptedInput) {
+		//Walk right for 3 seconds, then left for 3 seconds (at 60 steps per second)
+		FacingDirection = (SimulationStep / 180) % 2 == 0 ? 1 : -1;
+		AddMovementInput(StepSeconds * CamRightVector * FacingDirection * WalkAcceleration);
+	}else{
+		AddMovementInput(StepSeconds * HeldMovementInput * WalkAcceleration);
 	}
-	if (bDebug && bDebugMoveAround) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
+	DoLineTracesAndPlatformChecks();
+	GetCharacterMovement()->TickComponent(StepSeconds, LEVELTICK_All, nullptr);
+
+	DecisionChecksum = HashCombine(DecisionChecksum, HashDecisions());
+	SimulationStep++;
+	if (bFixedStepScriptedInput && SimulationStep % 600 == 0) {
+		UE_LOG(LogDimense, Log, TEXT("Fixed step %d: decision checksum %08x"), SimulationStep, DecisionChecksum);
 	}
-	Start = HeadLocation + (CamRightVector - CamForwardVector) * (MyWidth / 2) * MovementDirection;
-	End = Start + Distance * MovementDirection;
-	if (SingleTrace(HitResult, Start, End)) {
-		//UE_LOG(LogTemp, Warning, TEXT("LeftHit5"));
-		return true;
+}
+
+void ADimenseCharacter::SetRenderOffset(const FVector& WorldOffset){
+	//The capsule stays on the simulated location, only the mesh and the camera chassis are moved
+	FVector LocalOffset = GetActorTransform().InverseTransformVectorNoScale(WorldOffset);
+	GetMesh()->SetRelativeLocation(MeshBaseRelativeLocation + LocalOffset);
+	if (!bSpinning) { //The spin's MoveComponentTo owns the chassis until it ends
+		RotationSpringArm->SetRelativeLocation(CameraBaseRelativeLocation + LocalOffset);
 	}
-	if (bDebug && bDebugMoveAround) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
+}
+
+uint32 ADimenseCharacter::HashDecisions() const{
+	//Platform names instead of pointers, so runs of the same map hash the same
+	uint32 Hash = HashCombine(GetTypeHash(VisibilitySide), GetTypeHash(MovementDirection));
+	Hash = HashCombine(Hash, FCrc::StrCrc32(*GetNameSafe(GroundPlatform)));
+	Hash = HashCombine(Hash, FCrc::StrCrc32(*GetNameSafe(TransportPlatform)));
+	Hash = HashCombine(Hash, FCrc::StrCrc32(*GetNameSafe(MoveAroundPlatform)));
+	return Hash;
+}
+
+int32 ADimenseCharacter::GetDecisionChecksum() const{
+	return int32(DecisionChecksum);
+}
+
+void ADimenseCharacter::ResetDecisionChecksum(){
+	DecisionChecksum = 0;
+	SimulationStep = 0;
+}
+
+bool ADimenseCharacter::CheckFixedStepDeterminism(const int32 Steps, int32& Checksum30, int32& Checksum60, int32& Checksum240){
+	Checksum30 = 0;
+	Checksum60 = 0;
+	Checksum240 = 0;
+	if (IsNetworked() || bSpinning || bRewinding || Steps <= 0) {
+		return false;
 	}
+	//All three runs happen within this frame, so anything outside the movement state (moving platforms, timers) is the same for each
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	FDimenseMovementState Start;
+	CaptureMovementState(Start);
+	const bool bWasActive = bFixedStepActive;
+	const bool bWasScripted = bFixedStepScriptedInput;
+	SetFixedStepActive(true);
+	bFixedStepScriptedInput = true;
+	const float FrameRates[3] = { 30.0f, 60.0f, 240.0f };
+	int32* Checksums[3] = { &Checksum30, &Checksum60, &Checksum240 };
+	bool bAllSteps = true;
+	for (int32 Run = 0; Run < 3; Run++) {
+		//Through MOVE_None so the movement component finds its floor again at the start location
+		Movement->SetMovementMode(MOVE_None);
+		Movement->ClearAccumulatedForces();
+		RestoreMovementState(Start);
+		ConsumeMovementInputVector();
+		ResetDecisionChecksum();
+		StepAccumulator = 0.0f;
+		//Frames of this rate through the same accumulator as play, each run stops after exactly Steps steps
+		const float FrameSeconds = 1.0f / FrameRates[Run];
+		const int32 MaxFrames = FMath::CeilToInt(Steps * FrameRates[Run] / FixedStepRate) + 2;
+		for (int32 Frame = 0; Frame < MaxFrames && SimulationStep < Steps; Frame++) {
+			TickFixedStep(FrameSeconds, Steps - SimulationStep);
+		}
+		bAllSteps &= SimulationStep == Steps;
+		uint32 Checksum = HashCombine(DecisionChecksum, GetTypeHash(GetActorLocation()));
+		*Checksums[Run] = int32(HashCombine(Checksum, GetTypeHash(GetActorRotation().Yaw)));
+	}
+	Movement->SetMovementMode(MOVE_None);
+	RestoreMovementState(Start);
+	ConsumeMovementInputVector();
+	bFixedStepScriptedInput = bWasScripted;
+	SetFixedStepActive(bWasActive);
+	return bAllSteps && Checksum30 == Checksum60 && Checksum60 == Checksum240;
+}
+
+bool ADimenseCharacter::ConsumeProbe(const EDimenseProbe Probe, const FVector& Start, FHitResult& HitResult, const int32 Context) const{
+	//Only hands out a result when this tick is running on last tick's async batch, otherwise the caller traces synchronously
+	return bDeferredQueriesThisTick && MovementQueries.GetResult(Probe, Start, AsyncProbeTolerance, HitResult, Context);
+}
+
+bool ADimenseCharacter::HorizontalHitCheck(FHitResult& HitResult){
+	DIMENSE_SCOPE(STAT_DimenseHorizontalHitCheck, HorizontalHitCheck);
+	FVector Start;
+	FVector End;
+	float debugLifeTime = 0.01f;
+	float debugThickness = 10.0f;
 
+	//Two lines (front and back edge of the player) at the foot, middle and head
+	for (int32 i = 0; i < 6; i++) {
+		GetHorizontalProbe(i, Start, End);
+		if (SingleTrace(HitResult, Start, End, FDimenseMovementQueries::OffsetProbe(EDimenseProbe::Horizontal0, i))) {
+			return true;
+		}
+		if (DIMENSE_DEBUG(MoveAround)) {
+			DrawDebugLine(GetWorld(), Start, End, FColor::Orange, false, debugLifeTime, 0, debugThickness);
+		}
+	}
 	return false;
 }
 
+void ADimenseCharacter::GetHorizontalProbe(const int32 Index, FVector& Start, FVector& End) const{
+	DimenseCore::DispatchView(ViewOrientation, [&](auto View){ GetHorizontalProbe<decltype(View)>(Index, Start, End); });
+}
+
+template <typename FView>
+void ADimenseCharacter::GetHorizontalProbe(const int32 Index, FVector& Start, FVector& End) const{
+	//Even indices trace from the camera side of the player, odd indices from the far side. Index / 2 picks foot, middle or head.
+	FVector Base = Index < 2 ? FootLocation : (Index < 4 ? GetActorLocation() : HeadLocation);
+	float HalfWidth = (MyWidth / 2) * MovementDirection;
+	Start = Base + FDimenseMovementRules::FromCore(FView::RightAndForward(HalfWidth, Index % 2 == 0 ? HalfWidth : -HalfWidth));
+	End = Start + FDimenseMovementRules::FromCore(FView::Right(MoveAroundTraceLength * MovementDirection));
+}
+
 bool ADimenseCharacter::TryTransport(){
+	DIMENSE_SCOPE(STAT_DimenseTryTransport, TryTransport);
+	FProfileScope ProfileScope(TickProfile.TransportMs);
+	TickProfile.TransportCalls++;
 	if (bCanTransport) {
-		if (!BoxTraceForTransportHit(TransportTraceZOffset)) { return false; }
-		if (!Cast<USurfacePlatformComponent>(TransportHitResult.GetActor()->FindComponentByClass(USurfacePlatformComponent::StaticClass()))) { return false; }
-		if (TryTransportPlatform == TransportHitResult.GetActor()) { return false; }
+		if (!BoxTraceForTransportHit(TransportTraceZOffset, EDimenseProbe::Transport)) { return false; }
+		APlatformMaster* HitPlatform = APlatformMaster::FromHit(TransportHitResult);
+		if (!HitPlatform) { return false; }
+		if (!HitPlatform->IsSurface()) { return false; }
+		if (TryTransportPlatform == HitPlatform) { return false; }
 		if (!SetPlatform(TryTransportPlatform, CachedTryTransportPlatform, TransportHitResult, FColor::Green, false)) { return false; }
 		//if (GroundPlatform && GroundPlatform->GetActorLocation().Z == TryTransportPlatform->GetActorLocation().Z) {
 		//	Transport();
@@ -267,44 +563,57 @@ bool ADimenseCharacter::TryTransport(){
 	return false;
 }
 
-bool ADimenseCharacter::BoxTraceForTransportHit(const float& ZOffset){
+bool ADimenseCharacter::BoxTraceForTransportHit(const float& ZOffset, const EDimenseProbe Probe){
 	FVector BoxSize = FVector((MyWidth / 2), (MyWidth / 2), 0);
-	FCollisionShape Box = FCollisionShape::MakeBox(BoxSize);
-	FVector LineVector = FromCameraLineVector * CamForwardVector * VisibilitySide;
-	FVector FootZ = FootLocation - FVector(0, 0, ZOffset);
-	FVector Start = FootZ - LineVector;
-	FVector End = FootZ + LineVector;
-	if (bDebug && bDebugTransport) {
+	FVector LineVector = GetCameraLineVector();
+	FVector Start; FVector End; GetTransportSweep(ZOffset, Start, End);
+	if (DIMENSE_DEBUG(Transport)) {
 		FVector Length = Start + End;
 		FVector Center = Length / 2;
 		FVector Extent = BoxSize + LineVector * 2;
 		DrawDebugBox(GetWorld(), Center, Extent, FColor::Green, false, 0.01f, 0, 3.0f);
 	}
-	return GetWorld()->SweepSingleByChannel(TransportHitResult, Start, End, MainCamera->GetComponentQuat(), ECollisionChannel::ECC_WorldStatic, Box, QParams);
+	return SweepAlongCameraAxis(TransportHitResult, Start, End, BoxSize, Probe);
+}
+
+void ADimenseCharacter::GetTransportSweep(const float& ZOffset, FVector& Start, FVector& End) const{
+	DimenseCore::DispatchView(ViewOrientation, [&](auto View){ GetTransportSweep<decltype(View)>(ZOffset, Start, End); });
+}
+
+template <typename FView>
+void ADimenseCharacter::GetTransportSweep(const float& ZOffset, FVector& Start, FVector& End) const{
+	FVector LineVector = GetCameraLineVector<FView>();
+	FVector FootZ = FootLocation - FVector(0, 0, ZOffset);
+	Start = FootZ - LineVector;
+	End = FootZ + LineVector;
 }
 
 void ADimenseCharacter::Transport(){
-	if (bDebug && bDebugTransport) {
+	if (DIMENSE_DEBUG(Transport)) {
 		GEngine->AddOnScreenDebugMessage(-1, 1, FColor::Green, (TEXT("Transport")));
 	}
-	PhysicsComp->AddWorldOffset(GetTransportOffset(TryTransportPlatform));
-	SetPlatform(TransportPlatform, CachedTransportPlatform, TransportHitResult, FColor::Green, bDebugTransport);
+	ApplyMovementOffset(GetTransportOffset(TryTransportPlatform), EDimenseTeleport::Transport);
+	SetPlatform(TransportPlatform, CachedTransportPlatform, TransportHitResult, FColor::Green, DIMENSE_DEBUG(Transport));
 	StartCanMoveAroundTimer();
 }
 
 FVector ADimenseCharacter::GetTransportOffset(const APlatformMaster* Platform) const{
-	FVector Origin; FVector Extent; Platform->GetActorBounds(true, Origin, Extent);
-	FVector Offset = FVector(TransportHitResult.Location.X, TransportHitResult.Location.Y, Origin.Z + Extent.Z) - GetActorLocation();
-	FVector TransportOffset = CamForwardVector.GetAbs() * (Offset + LandingOffsetPadding * CamSide * CamSign * VisibilitySide);
-	if (bDebug && bDebugTransport) {
+	FVector TransportOffset = DimenseCore::DispatchView(ViewOrientation, [&](auto View){
+		return FDimenseMovementRules::FromCore(decltype(View)::TransportOffset(FDimenseMovementRules::ToCore(TransportHitResult.Location), FDimenseMovementRules::ToCore(GetActorLocation()), FDimenseMovementRules::ToCore(LandingOffsetPadding), VisibilitySide));
+	});
+	if (DIMENSE_DEBUG(Transport)) {
+		FVector Origin; FVector Extent; Platform->GetCachedBounds(Origin, Extent);
 		DrawDebugBox(GetWorld(), Origin, Extent, FColor::Green, false, 0.5f, 0,10.0f);
 	}
 	return TransportOffset;
 }
 
-bool ADimenseCharacter::TryMoveAround(UPARAM(ref) FHitResult& HitResult, FVector BoxTraceOffset){
+bool ADimenseCharacter::TryMoveAround(UPARAM(ref) FHitResult& HitResult, FVector BoxTraceOffset, const EDimenseProbe Probe){
+	DIMENSE_SCOPE(STAT_DimenseTryMoveAround, TryMoveAround);
+	FProfileScope ProfileScope(TickProfile.MoveAroundMs);
+	TickProfile.MoveAroundCalls++;
 	if (bCanMoveAround) {
-		if (BoxTraceForMoveAroundHit(HitResult, BoxTraceOffset)) {
+		if (BoxTraceForMoveAroundHit(HitResult, BoxTraceOffset, Probe)) {
 			if (SetPlatform(MoveAroundPlatform, CachedMoveAroundPlatform, MoveAroundHitResult, FColor::Orange, true)) {
 				MoveAround();
 				return true;
@@ -314,33 +623,77 @@ bool ADimenseCharacter::TryMoveAround(UPARAM(ref) FHitResult& HitResult, FVector
 	return false;
 }
 
-bool ADimenseCharacter::BoxTraceForMoveAroundHit(FHitResult& HitResult, FVector Offset){
-	FCollisionShape Box = FCollisionShape::MakeBox(MoveAroundBoxSize);
-	FVector LineVector = FromCameraLineVector * CamForwardVector * VisibilitySide;
-	FVector Start = GetActorLocation() - LineVector + Offset;
-	FVector End = GetActorLocation() + LineVector + Offset;
-	if (bDebug && bDebugMoveAround) {
+bool ADimenseCharacter::BoxTraceForMoveAroundHit(FHitResult& HitResult, FVector Offset, const EDimenseProbe Probe){
+	FVector LineVector = GetCameraLineVector();
+	FVector Start; FVector End; GetMoveAroundSweep(Offset, Start, End);
+	if (DIMENSE_DEBUG(MoveAround)) {
 		FVector Length = Start + End;
 		FVector SweepCenter = Length / 2;
 		FVector SweepExtent = MoveAroundBoxSize + LineVector / 2;
 		DrawDebugBox(GetWorld(), SweepCenter, SweepExtent, FColor::Orange, false, 0.5f, 0, 3.0f);
 	}
-	return GetWorld()->SweepSingleByChannel(MoveAroundHitResult, Start, End, MainCamera->GetComponentQuat(), ECollisionChannel::ECC_WorldStatic, Box, QParams);
+	return SweepAlongCameraAxis(MoveAroundHitResult, Start, End, MoveAroundBoxSize, Probe);
+}
+
+bool ADimenseCharacter::SweepAlongCameraAxis(FHitResult& HitResult, const FVector& Start, const FVector& End, const FVector& BoxSize, const EDimenseProbe Probe){
+	//The projection index answers without touching physics. Otherwise use last tick's async result, and sweep synchronously as the last resort.
+	if (bUsePlatformIndex && ProjectionIndex) {
+		bool bHit = ProjectionIndex->SweepAlongAxis(Start, End, BoxSize, HitResult);
+		TickProfile.IndexQueries++;
+		if (ProjectionIndex->bValidate) {
+			FHitResult SweepResult;
+			GetWorld()->SweepSingleByObjectType(SweepResult, Start, End, GetViewQuat(), PlatformObjectParams, FCollisionShape::MakeBox(BoxSize), QParams);
+			DIMENSE_COUNT_SWEEPS(1);
+			if (bHit != SweepResult.bBlockingHit || HitResult.GetActor() != SweepResult.GetActor() || (bHit && HitResult.Item != SweepResult.Item) || (bHit && !HitResult.Location.Equals(SweepResult.Location, 1.0f))) {
+				UE_LOG(LogDimense, Warning, TEXT("Platform index mismatch: index %s at %s, sweep %s at %s"),
+					*GetNameSafe(HitResult.GetActor()), *HitResult.Location.ToString(), *GetNameSafe(SweepResult.GetActor()), *SweepResult.Location.ToString());
+			}
+		}
+		return bHit;
+	}
+	if (ConsumeProbe(Probe, Start, HitResult, VisibilitySide)) {
+		return HitResult.bBlockingHit;
+	}
+	TickProfile.Traces++;
+	DIMENSE_COUNT_SWEEPS(1);
+	return GetWorld()->SweepSingleByObjectType(HitResult, Start, End, GetViewQuat(), PlatformObjectParams, FCollisionShape::MakeBox(BoxSize), QParams);
+}
+
+void ADimenseCharacter::GetMoveAroundSweep(const FVector& Offset, FVector& Start, FVector& End) const{
+	DimenseCore::DispatchView(ViewOrientation, [&](auto View){ GetMoveAroundSweep<decltype(View)>(Offset, Start, End); });
+}
+
+template <typename FView>
+void ADimenseCharacter::GetMoveAroundSweep(const FVector& Offset, FVector& Start, FVector& End) const{
+	FVector LineVector = GetCameraLineVector<FView>();
+	Start = GetActorLocation() - LineVector + Offset;
+	End = GetActorLocation() + LineVector + Offset;
+}
+
+FVector ADimenseCharacter::GetCameraLineVector() const{
+	return DimenseCore::DispatchView(ViewOrientation, [this](auto View){ return GetCameraLineVector<decltype(View)>(); });
+}
+
+template <typename FView>
+FVector ADimenseCharacter::GetCameraLineVector() const{
+	//FromCameraLineLength along the camera axis, towards the VisibilitySide
+	return FDimenseMovementRules::FromCore(FView::Forward(FromCameraLineVector.X * VisibilitySide));
 }
 
 void ADimenseCharacter::MoveAround(){
-	if (bDebug && bDebugMoveAround) {
+	if (DIMENSE_DEBUG(MoveAround)) {
 		GEngine->AddOnScreenDebugMessage(-1, 1, FColor::Orange, (TEXT("MoveAround")));
 	}
-	PhysicsComp->AddWorldOffset(GetMoveAroundOffset(MoveAroundHitResult.Location));
+	ApplyMovementOffset(GetMoveAroundOffset(MoveAroundHitResult.Location), EDimenseTeleport::MoveAround);
 	//StartCanTransportTimer();
 }
 
 FVector ADimenseCharacter::GetMoveAroundOffset(const FVector& Location) const{
-	FVector Offset = Location - GetActorLocation();
-	FVector MoveAroundOffset = CamForwardVector.GetAbs() * (Offset - LandingOffsetPadding * CamSide * CamSign * VisibilitySide);
-	if (bDebug && bDebugMoveAround) {
-		FVector Origin; FVector Extent; MoveAroundPlatform->GetActorBounds(true, Origin, Extent);
+	FVector MoveAroundOffset = DimenseCore::DispatchView(ViewOrientation, [&](auto View){
+		return FDimenseMovementRules::FromCore(decltype(View)::MoveAroundOffset(FDimenseMovementRules::ToCore(Location), FDimenseMovementRules::ToCore(GetActorLocation()), FDimenseMovementRules::ToCore(LandingOffsetPadding), VisibilitySide));
+	});
+	if (DIMENSE_DEBUG(MoveAround)) {
+		FVector Origin; FVector Extent; MoveAroundPlatform->GetCachedBounds(Origin, Extent);
 		DrawDebugDirectionalArrow(GetWorld(), GetActorLocation() - FVector(0.0f, 0.0f, MyHeight / 2), GetActorLocation() - FVector(0.0f, 0.0f, MyHeight / 2) + MoveAroundOffset, 500.0f, FColor::Orange, false, 5.0f, 54, 3.0f);
 		DrawDebugBox(GetWorld(), Origin, Extent, FColor::Orange, false, 0.5f, 0, 10.0f);
 	}
@@ -352,14 +705,16 @@ bool ADimenseCharacter::BoxTraceHorizontal(FHitResult& HitResult, const float& T
 	FCollisionShape Box = FCollisionShape::MakeBox(BoxSize);
 	FVector Start = GetActorLocation();
 	FVector End = Start + ((FVector(0.0f, 0.0f, TraceLength) * UpOrDown));
-	if (GetWorld()->SweepSingleByChannel(HitResult, Start, End, PhysicsComp->GetComponentQuat(), ECollisionChannel::ECC_WorldStatic, Box, QParams)) {
-		if (bDebug && bDebugLocal) {
+	TickProfile.Traces++;
+	DIMENSE_COUNT_SWEEPS(1);
+	if (GetWorld()->SweepSingleByObjectType(HitResult, Start, End, PhysicsComp->GetComponentQuat(), PlatformObjectParams, Box, QParams)) {
+		if (DIMENSE_DEBUG(MoveAround) && bDebugLocal) {
 			GEngine->AddOnScreenDebugMessage(-1, 1, FColor::Black, (TEXT("%s was hit"), DebugPhrase));
 			DrawDebugBox(GetWorld(), Start, Box.GetExtent(), FColor::Red, false, 0.1f, 0, 1.0f); //Brown
 		}
 		return true;
 	}
-	if (bDebug && bDebugLocal) {
+	if (DIMENSE_DEBUG(MoveAround) && bDebugLocal) {
 		DrawDebugBox(GetWorld(), Start, Box.GetExtent(), FColor::Orange, false, 0.1f, 0, 1.0f);
 	}
 	return false;
@@ -387,19 +742,27 @@ bool ADimenseCharacter::BoxTraceHorizontal(FHitResult& HitResult, const float& T
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions below this line are considered complete and have no known problems /////////////////////////////////////////////////////////////////////////////////////////
 
-bool ADimenseCharacter::BoxTraceVertical(const FVector& Location, FHitResult& HitResult, const FVector BoxSize, const float& TraceLength, const int32 UpOrDown, const FString DebugPhrase, const int32 DebugTime, const bool bDebugLocal){
+bool ADimenseCharacter::BoxTraceVertical(const FVector& Location, FHitResult& HitResult, const FVector BoxSize, const float& TraceLength, const int32 UpOrDown, const FString DebugPhrase, const int32 DebugTime, const bool bDebugLocal, const EDimenseProbe Probe){
 	//UpOrDown should be 1 or -1
 	FCollisionShape Box = FCollisionShape::MakeBox(BoxSize);
 	FVector End = Location + ((FVector(0.0f, 0.0f, TraceLength) * UpOrDown));
-	if (GetWorld()->SweepSingleByChannel(HitResult, Location, End, FQuat(0,0,0,0), ECollisionChannel::ECC_WorldStatic, Box, QParams)) {
-		if (bDebug && bDebugLocal) {
+	bool bHit;
+	if (ConsumeProbe(Probe, Location, HitResult)) {
+		bHit = HitResult.bBlockingHit;
+	}else{
+		bHit = GetWorld()->SweepSingleByObjectType(HitResult, Location, End, FQuat(0,0,0,0), PlatformObjectParams, Box, QParams);
+		TickProfile.Traces++;
+		DIMENSE_COUNT_SWEEPS(1);
+	}
+	if (bHit) {
+		if (DIMENSE_DEBUG(Ground) && bDebugLocal) {
 			GEngine->AddOnScreenDebugMessage(-1, DebugTime, FColor::Black, (TEXT("%s"), DebugPhrase+FString(TEXT(" was hit"))));
 			FVector DebugBoxOffset = FVector(0.0f, 0.0f, (End.Z - Location.Z) / 2);
 			DrawDebugBox(GetWorld(), Location + DebugBoxOffset, Box.GetExtent() + DebugBoxOffset, FColor::Red, false, 0.1f, 0,1.0f); //Brown
 		}
 		return true;
 	}
-	if (bDebug && bDebugLocal) {
+	if (DIMENSE_DEBUG(Ground) && bDebugLocal) {
 		FVector DebugBoxOffset = FVector(0.0f, 0.0f, (End.Z - Location.Z) / 2);
 		DrawDebugBox(GetWorld(), Location + DebugBoxOffset, Box.GetExtent() + DebugBoxOffset, FColor::Green, false, 0.1f, 0,1.0f);
 	}
@@ -407,13 +770,13 @@ bool ADimenseCharacter::BoxTraceVertical(const FVector& Location, FHitResult& Hi
 }
 
 bool ADimenseCharacter::SetPlatform(UPARAM(ref) APlatformMaster*& Platform, UPARAM(ref) APlatformMaster*& CachedPlatform, UPARAM(ref) FHitResult& HitResult, const FColor DebugColor, const bool bDebugLocal){
-	APlatformMaster* NewPlatform = Cast<APlatformMaster>(HitResult.GetActor());
+	APlatformMaster* NewPlatform = APlatformMaster::FromHit(HitResult);
 	if (NewPlatform) {
 		if (Platform != NewPlatform) {
 			InvalidatePlatform(Platform, CachedPlatform);
 			Platform = NewPlatform;
-			if (bDebug && bDebugLocal) {
-				FVector Origin; FVector Extent; Platform->GetActorBounds(true, Origin, Extent);
+			if (DIMENSE_DEBUG(Ground) && bDebugLocal) {
+				FVector Origin; FVector Extent; Platform->GetCachedBounds(Origin, Extent);
 				DrawDebugBox(GetWorld(), Origin, Extent, DebugColor, false, 0.5f, 255, 5.0f);
 			}
 			return true;
@@ -425,17 +788,14 @@ bool ADimenseCharacter::SetPlatform(UPARAM(ref) APlatformMaster*& Platform, UPAR
 }
 
 bool ADimenseCharacter::PlayerAbovePlatformCheck(const APlatformMaster* Platform) const{
-	if (bDebug && bDebugAbovePlatform) {
+	if (DIMENSE_DEBUG(AbovePlatform)) {
 		GEngine->AddOnScreenDebugMessage(-1, 0.01f, FColor::FromHex(TEXT("0081FFFF")), (TEXT("Player Above Platform Check"))); //Blue
 	}
-	FVector Origin;
-	FVector Extent;
-	Platform->GetActorBounds(true, Origin, Extent);
-	FVector Top = Origin + FVector(0.0f, 0.0f, Extent.Z);
-	if (Platform == GroundPlatform || FootLocation.Z >= Top.Z) {
+	if (DimenseCore::IsAbovePlatform(FootLocation.Z, Platform->GetTopZ(), Platform == GroundPlatform)) {
 		return true;
 	}
-	if (bDebug && bDebugAbovePlatform) {
+	if (DIMENSE_DEBUG(AbovePlatform)) {
+		FVector Origin; FVector Extent; Platform->GetCachedBounds(Origin, Extent);
 		DrawDebugBox(GetWorld(), Origin, Extent, FColor::FromHex(TEXT("0081FFFF")), false, 0.5f, 0, 10.0f); //Blue
 	}
 	return false;
@@ -443,8 +803,8 @@ bool ADimenseCharacter::PlayerAbovePlatformCheck(const APlatformMaster* Platform
 
 void ADimenseCharacter::InvalidatePlatform(UPARAM(ref) APlatformMaster*& Platform, UPARAM(ref) APlatformMaster*& CachedPlatform, const FColor DebugColor){
 	if (Platform) {
-		if (bDebug && bDebugInvalidation) {
-			FVector Origin;	FVector Extent;	Platform->GetActorBounds(true, Origin, Extent);
+		if (DIMENSE_DEBUG(Invalidation)) {
+			FVector Origin;	FVector Extent;	Platform->GetCachedBounds(Origin, Extent);
 			DrawDebugBox(GetWorld(), Origin, Extent, DebugColor, false, 0.25f, 0,10.0f);
 		}
 		CachedPlatform = Platform;
@@ -454,8 +814,8 @@ void ADimenseCharacter::InvalidatePlatform(UPARAM(ref) APlatformMaster*& Platfor
 
 void ADimenseCharacter::InvalidateCachedPlatform(UPARAM(ref) APlatformMaster*& CachedPlatform, const FColor DebugColor){
 	if (CachedPlatform) {
-		if (bDebug && bDebugCachedInvalidation) {
-			FVector Origin;	FVector Extent;	CachedPlatform->GetActorBounds(true, Origin, Extent);
+		if (DIMENSE_DEBUG(CachedInvalidation)) {
+			FVector Origin;	FVector Extent;	CachedPlatform->GetCachedBounds(Origin, Extent);
 			DrawDebugBox(GetWorld(), Origin, Extent, DebugColor, false, 0.25f, 0,10.0f);
 		}
 		CachedPlatform = nullptr;
@@ -463,15 +823,17 @@ void ADimenseCharacter::InvalidateCachedPlatform(UPARAM(ref) APlatformMaster*& C
 }
 
 void ADimenseCharacter::UpdateMovementSystemVariables(){
+	DIMENSE_SCOPE(STAT_DimenseUpdateVariables, UpdateMovementSystemVariables);
 	//The Cam* variables are used by the movement system to determine which vectors apply based on the camera angle, and also direction based on +/- values
-	CamForwardVector = RoundVector(FVector(MainCamera->GetForwardVector()));
-	CamRightVector = RoundVector(FVector(MainCamera->GetRightVector()));
-	CamSign = FMath::Sign(CamRightVector.Y + CamRightVector.X);
-	if (!FMath::IsNearlyZero(double(CamForwardVector.X), 0.1)) {
-		CamSide = 1;
-	}else{
-		CamSide = -1;
-	}
+	//While the camera spins these are already the view it is turning to. The camera only stops at multiples of 90 degrees, so its yaw / 90 names the orientation without rounding camera vectors.
+	ViewOrientation = DimenseCore::GetViewOrientation(FMath::RoundToInt((MainCamera->GetComponentRotation().Yaw + GetSpinRemainingYaw()) / 90.0f));
+	DimenseCore::DispatchView(ViewOrientation, [this](auto View){
+		using FView = decltype(View);
+		CamForwardVector = FDimenseMovementRules::FromCore(FView::Forward(1.0f));
+		CamRightVector = FDimenseMovementRules::FromCore(FView::Right(1.0f));
+		CamSign = FView::CamSign;
+		CamSide = FView::CamSide;
+	});
 
 	//Head and foot location used by the movement system
 	FootLocation = GetActorLocation() - (FVector(0.0f, 0.0f, MyHeight/2));
@@ -481,18 +843,10 @@ void ADimenseCharacter::UpdateMovementSystemVariables(){
 }
 
 void ADimenseCharacter::SetMovementDirection(){
-	//Check if the player is moving to the right
-	if (PhysicsComp->GetComponentVelocity().X * CamSign > 0 || PhysicsComp->GetComponentVelocity().Y * CamSign > 0) {
-		MovementDirection = 1;
-	}
-	//Check if the player is moving to the left
-	else if (PhysicsComp->GetComponentVelocity().X * CamSign < 0 || PhysicsComp->GetComponentVelocity().Y * CamSign < 0) {
-		MovementDirection = -1;
-	}
-	//Check if the player is not moving
-	else if (PhysicsComp->GetComponentVelocity().X == 0.0f && PhysicsComp->GetComponentVelocity().Y == 0.0f) {
-		MovementDirection = 0;
-	}
+	//While a spin has movement paused, the velocity that matters is the one it resumes with
+	FVector Velocity = bSpinning && bSpinPausedMovement ? CachedComponentVelocity : PhysicsComp->GetComponentVelocity();
+	//Right, left or standing still on the view
+	MovementDirection = DimenseCore::GetMovementDirection(FDimenseMovementRules::ToCore(Velocity), CamSign, MovementDirection);
 }
 
 FVector ADimenseCharacter::GetMovementInputFRI(){ //(FRI = Frame Rate Independent)
@@ -500,22 +854,201 @@ FVector ADimenseCharacter::GetMovementInputFRI(){ //(FRI = Frame Rate Independen
 }
 
 int32 ADimenseCharacter::MoveLeftRight(const float& AxisValue){
+	if (!PassInput(EDimenseRecordedInput::Axis, AxisValue)) {
+		return FacingDirection;
+	}
 	GetCharacterMovement()->AddInputVector(CamRightVector * AxisValue);
 	FacingDirection = FMath::Sign(AxisValue);
 	return FacingDirection;
 }
 
+void ADimenseCharacter::Jump(){
+	if (PassInput(EDimenseRecordedInput::Jump)) {
+		Super::Jump();
+	}
+}
+
+void ADimenseCharacter::StopJumping(){
+	if (PassInput(EDimenseRecordedInput::StopJumping)) {
+		Super::StopJumping();
+	}
+}
+
+bool ADimenseCharacter::PassInput(const EDimenseRecordedInput Input, const float Value){
+	//The recorder sees every input first, and holds back the player's own while it plays a recording back
+	ADimensePlayerController* DimenseController = Cast<ADimensePlayerController>(GetController());
+	return !DimenseController || DimenseController->GetInputRecorder().OnInput(Input, Value);
+}
+
 void ADimenseCharacter::JumpDown(){
+	if (bRewinding || !PassInput(EDimenseRecordedInput::JumpDown)) {
+		return;
+	}
 	if (GroundPlatform) {
 		InvalidatePlatform(TryTransportPlatform, CachedTryTransportPlatform);
 		if (BoxTraceForTransportHit(TransportTraceZOffset)) {
 			FVector Offset = FVector(1.0f, 1.0f, 0.0f) * (TransportHitResult.Location - GetActorLocation() - LandingOffsetPadding * CamForwardVector * VisibilitySide);
-			PhysicsComp->AddWorldOffset(Offset);
+			ApplyMovementOffset(Offset, EDimenseTeleport::JumpDown);
 			StartCanTransportTimer();
 		}
 	}
 }
 
+bool ADimenseCharacter::IsNetworked() const{
+	return GetNetMode() != NM_Standalone;
+}
+
+bool ADimenseCharacter::RunsMovementSystem() const{
+	//Only where the character is controlled: the owning client predicts, the server checks what it sends
+	return !IsNetworked() || IsLocallyControlled();
+}
+
+void ADimenseCharacter::ApplyMovementOffset(const FVector& Offset, const EDimenseTeleport Kind){
+	FVector Applied = Offset;
+	if (IsNetworked()) {
+		//Rounded the way FVector_NetQuantize10 sends it, so the server moves by exactly the same amount
+		Applied = FVector(FMath::RoundToFloat(Offset.X * 10.0f), FMath::RoundToFloat(Offset.Y * 10.0f), FMath::RoundToFloat(Offset.Z * 10.0f)) / 10.0f;
+	}
+	PhysicsComp->AddWorldOffset(Applied);
+	bSnapRenderLocation = true;
+	if (HasAuthority()) {
+		TeleportCount++; //Standalone, or the listen server's own character
+	}else if (GetLocalRole() == ROLE_AutonomousProxy) {
+		UDimenseMovementComponent* Movement = Cast<UDimenseMovementComponent>(GetCharacterMovement());
+		SendViewIndex(); //A spin started this tick must reach the server before the teleport made in its view
+		Movement->PredictTeleport(Applied);
+		if (Kind == EDimenseTeleport::Respawn) {
+			ServerRespawn(Movement->GetClientTimeStamp());
+		}else{
+			ServerRequestTeleport(Movement->GetClientTimeStamp(), Applied, Kind);
+		}
+	}
+}
+
+bool ADimenseCharacter::ServerRequestTeleport_Validate(const float ClientTimeStamp, const FVector_NetQuantize10& Offset, const EDimenseTeleport Kind){
+	return !Offset.ContainsNaN();
+}
+
+void ADimenseCharacter::ServerRequestTeleport_Implementation(const float ClientTimeStamp, const FVector_NetQuantize10& Offset, const EDimenseTeleport Kind){
+	if (!IsTeleportPlausible(Offset, Kind)) {
+		RejectTeleport(Offset, Kind);
+		return;
+	}
+	Cast<UDimenseMovementComponent>(GetCharacterMovement())->QueueTeleport(ClientTimeStamp, Offset);
+}
+
+bool ADimenseCharacter::ServerRespawn_Validate(const float ClientTimeStamp){
+	return true;
+}
+
+void ADimenseCharacter::ServerRespawn_Implementation(const float ClientTimeStamp){
+	//Only when the server sees the death itself, otherwise a client could pull itself out of any fall
+	if (!CanServerRespawn()) {
+		RejectTeleport(NetCheckpointLocation - GetActorLocation(), EDimenseTeleport::Respawn);
+		return;
+	}
+	bDiedOnServer = false;
+	//Taken at the time of the request, the character lands back on that platform so it doesn't change before it is applied
+	Cast<UDimenseMovementComponent>(GetCharacterMovement())->QueueTeleportTo(ClientTimeStamp, NetCheckpointLocation);
+}
+
+bool ADimenseCharacter::ServerSetViewIndex_Validate(const uint8 ViewIndex){
+	return ViewIndex < 4;
+}
+
+void ADimenseCharacter::ServerSetViewIndex_Implementation(const uint8 ViewIndex){
+	ServerViewIndex = ViewIndex;
+}
+
+void ADimenseCharacter::SendViewIndex(){
+	int32 ViewIndex = GetViewIndex();
+	if (ViewIndex != SentViewIndex) {
+		SentViewIndex = ViewIndex;
+		ServerSetViewIndex(uint8(ViewIndex));
+	}
+}
+
+bool ADimenseCharacter::CanServerRespawn() const{
+	if (bDiedOnServer) {
+		return true;
+	}
+	//Falling out of the level: well below the checkpoint, or closing on the world's KillZ
+	float Z = GetActorLocation().Z;
+	const AWorldSettings* WorldSettings = GetWorld()->GetWorldSettings();
+	return GetCharacterMovement()->IsFalling() && (Z < NetCheckpointLocation.Z - NetRespawnFallDepth || (WorldSettings && Z < WorldSettings->KillZ + NetRespawnFallDepth));
+}
+
+void ADimenseCharacter::RejectTeleport(const FVector& Offset, const EDimenseTeleport Kind){
+	//Not queued, and the client is sent the server's position right away instead of waiting for its moves to drift
+	NumTeleportsRejected++;
+	INC_DWORD_STAT(STAT_DimenseNetTeleportsRejected);
+	CSV_CUSTOM_STAT(Dimense, NetTeleportsRejected, 1, ECsvCustomStatOp::Accumulate);
+	UE_LOG(LogDimense, Verbose, TEXT("%s: rejected teleport %d by %s"), *GetName(), int32(Kind), *Offset.ToString());
+	if (FNetworkPredictionData_Server_Character* ServerData = GetCharacterMovement()->GetPredictionData_Server_Character()) {
+		ServerData->bForceClientUpdate = true;
+	}
+}
+
+void ADimenseCharacter::UpdateNetCheckpoint(){
+	//The server doesn't run the movement system, so its checkpoint comes from what both ends have: the movement component's floor.
+	//A new floor platform moves it to where the character first stands on it, like bAutoCheckpoint does with GroundPlatform.
+	const UCharacterMovementComponent* Movement = GetCharacterMovement();
+	if (!Movement->IsMovingOnGround() || !Movement->CurrentFloor.IsWalkableFloor()) {
+		return;
+	}
+	APlatformMaster* Floor = APlatformMaster::FromHit(Movement->CurrentFloor.HitResult);
+	if (Floor && Floor != NetCheckpointPlatform.Get()) {
+		NetCheckpointPlatform = Floor;
+		NetCheckpointLocation = GetActorLocation();
+	}
+}
+
+bool ADimenseCharacter::IsTeleportPlausible(const FVector& Offset, const EDimenseTeleport Kind) const{
+	if (Kind == EDimenseTeleport::Respawn) {
+		return false; //Respawns go through ServerRespawn, a client never picks where it respawns
+	}
+	//Everything else moves along the camera axis of the view the client last reported, never across the screen or up
+	int32 Axis = ServerViewIndex % 2;
+	if (!FMath::IsNearlyZero(Offset.Z) || !FMath::IsNearlyZero(Offset[1 - Axis]) || !ProjectionIndex) {
+		return false;
+	}
+	//And lands within reach of a platform: nothing past the indexed platforms along that axis is ever a target
+	float Slack = MyWidth * 2 + NetTeleportTolerance;
+	float TargetOnAxis = GetActorLocation()[Axis] + Offset[Axis];
+	const FBox& Reachable = ProjectionIndex->GetIndexedBounds();
+	if (!Reachable.IsValid || TargetOnAxis < Reachable.Min[Axis] - Slack || TargetOnAxis > Reachable.Max[Axis] + Slack) {
+		return false;
+	}
+	//The server has the client a move or so behind, so the platform is looked for within the tolerance around where it lands.
+	//Platforms are spawned on each end and can't be sent by reference, the server's own index has to find them.
+	FVector Target = GetActorLocation() + Offset;
+	FVector Reach = FVector::ZeroVector;
+	Reach[Axis] = MyWidth * 2 + NetTeleportTolerance;
+	FPlatformIndexHit Hit;
+	switch (Kind) {
+	case EDimenseTeleport::Transport: {
+		//A surface platform under the landing spot, its top no higher than the foot
+		float Foot = Target.Z - MyHeight / 2;
+		FVector2D HalfSize(MyWidth / 2 + NetTeleportTolerance, MyWidth / 2 + NetTeleportTolerance);
+		return ProjectionIndex->FindGroundBelow(FBox2D(FVector2D(Target) - HalfSize, FVector2D(Target) + HalfSize), Foot - TransportTraceZOffset - NetTeleportTolerance, Foot + NetTeleportTolerance, Hit) && Hit.bSurface;
+	}
+	case EDimenseTeleport::MoveAround:
+		//A platform right past the landing spot along the camera axis, beside or over the player
+		return ProjectionIndex->SweepBoundsAlongAxis(Target - Reach, Target + Reach, MoveAroundBoxSize + FVector(0.0f, 0.0f, HeadTraceLength + NetTeleportTolerance), Hit);
+	case EDimenseTeleport::JumpDown: {
+		FVector FootZ = Target - FVector(0.0f, 0.0f, MyHeight / 2 + TransportTraceZOffset);
+		return ProjectionIndex->SweepBoundsAlongAxis(FootZ - Reach, FootZ + Reach, FVector(MyWidth / 2, MyWidth / 2, NetTeleportTolerance), Hit);
+	}
+	default:
+		return false;
+	}
+}
+
+void ADimenseCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME_CONDITION(ADimenseCharacter, TeleportCount, COND_SimulatedOnly);
+}
+
 bool ADimenseCharacter::IsFallingDownward() const{
 	return PhysicsComp->GetComponentVelocity().Z < 0.0f;
 }
@@ -539,63 +1072,76 @@ bool ADimenseCharacter::CheckDeathByFallDistance(){
 
 void ADimenseCharacter::SetVisibilitySide(){
 	//If something is in between the camera and player: 1 if player is visible, -1 if visible from the back, 0 if not visible from either side
-	if (VisibilityCheck(MainCamera->GetComponentLocation())) { //visible from the front?
+	if (VisibilityCheck(GetViewLocation(MainCamera), EDimenseProbe::VisibilityFront0)) { //visible from the front?
 		VisibilitySide = 1;
 	}else{
 		VisibilitySide = -1;
-		if (!VisibilityCheck(AntiCameraSceneComponent->GetComponentLocation())) { //visible from the back side?
+		if (!VisibilityCheck(GetViewLocation(AntiCameraSceneComponent), EDimenseProbe::VisibilityBack0)) { //visible from the back side?
 			VisibilitySide = 0;
 		}
 	}
 }
 
-bool ADimenseCharacter::VisibilityCheck(const FVector& Start){
+bool ADimenseCharacter::VisibilityCheck(const FVector& Start, const EDimenseProbe FirstProbe){
+	DIMENSE_SCOPE(STAT_DimenseVisibilityCheck, VisibilityCheck);
+	//Lines to the foot, head and both sides of the player. More than 2 blocked lines means the player is hidden from Start.
 	int32 HitCount = 0;
-	float Distance = MainCameraSpringArm->TargetArmLength;
-	float X = CamSide * PhysicsComp->Bounds.BoxExtent.X;
-	float Y = CamSide * PhysicsComp->Bounds.BoxExtent.Y;
-	FVector PlayerLocation = GetActorLocation();
 	FVector End;
 
-	End = FootLocation;
-	if (bDebug && bDebugVisibility) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::White, false, 0.0f, 0, 5.0f);
-	}
-	if (SingleTrace(FrontHitResult, Start, End)) {
-		HitCount++;
-	}
-	End = HeadLocation;
-	if (bDebug && bDebugVisibility) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::White, false, 0.0f, 0, 5.0f);
-	}
-	if (SingleTrace(FrontHitResult, Start, End)) {
-		HitCount++;
-	}
-	End = PlayerLocation + FVector(X, Y, 0.0f);
-	if (bDebug && bDebugVisibility) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::White, false, 0.0f, 0, 5.0f);
-	}
-	if (SingleTrace(FrontHitResult, Start, End)) {
-		HitCount++;
-	}
-	End = PlayerLocation - FVector(X, Y, 0.0f);
-	if (bDebug && bDebugVisibility) {
-		DrawDebugLine(GetWorld(), Start, End, FColor::White, false, 0.0f, 0, 5.0f);
-	}
-	if (HitCount > 2) {
-		return false;
+	for (int32 i = 0; i < 4; i++) {
+		End = GetVisibilityProbeEnd(i);
+		if (DIMENSE_DEBUG(Visibility)) {
+			DrawDebugLine(GetWorld(), Start, End, FColor::White, false, 0.0f, 0, 5.0f);
+		}
+		if (IsVisibilityProbeBlocked(Start, End, FDimenseMovementQueries::OffsetProbe(FirstProbe, i))) {
+			HitCount++;
+		}
+		if (HitCount > 2) {
+			return false;
+		}
 	}
-	if (SingleTrace(FrontHitResult, Start, End)) {
-		HitCount++;
+	return true;
+}
+
+bool ADimenseCharacter::IsVisibilityProbeBlocked(const FVector& Start, const FVector& End, const EDimenseProbe Probe){
+	//The occlusion buffer is an orthographic view along the camera axis, so only the depth of End matters, not where Start is
+	if (bUseOcclusionBuffer && ProjectionIndex) {
+		bool bOccluded = ProjectionIndex->IsOccludedAlongAxis(End - Start, End);
+		TickProfile.IndexQueries++;
+		if (ProjectionIndex->bValidate) {
+			bool bTraced = GetWorld()->LineTraceSingleByObjectType(FrontHitResult, Start, End, PlatformObjectParams, QParams);
+			DIMENSE_COUNT_LINE_TRACES(1);
+			if (bOccluded != bTraced) {
+				UE_LOG(LogDimense, Warning, TEXT("Occlusion buffer mismatch at %s: buffer %d, trace %d (%s)"),
+					*End.ToString(), bOccluded, bTraced, *GetNameSafe(FrontHitResult.GetActor()));
+			}
+		}
+		return bOccluded;
 	}
-	if (HitCount > 2) {
-		return false;
+	return SingleTrace(FrontHitResult, Start, End, Probe);
+}
+
+FVector ADimenseCharacter::GetVisibilityProbeEnd(const int32 Index) const{
+	float X = CamSide * PhysicsComp->Bounds.BoxExtent.X;
+	float Y = CamSide * PhysicsComp->Bounds.BoxExtent.Y;
+	switch (Index) {
+		case 0: return FootLocation;
+		case 1: return HeadLocation;
+		case 2: return GetActorLocation() + FVector(X, Y, 0.0f);
+		default: return GetActorLocation() - FVector(X, Y, 0.0f);
 	}
-	return true;
 }
 
-bool ADimenseCharacter::SingleTrace(UPARAM(ref) FHitResult& HitResult, const FVector& Start, const FVector& End) const{
-	GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECollisionChannel::ECC_Visibility, QParams);
+bool ADimenseCharacter::SingleTrace(UPARAM(ref) FHitResult& HitResult, const FVector& Start, const FVector& End, const EDimenseProbe Probe) const{
+	int32 Context = 0;
+	if (Probe >= EDimenseProbe::Horizontal0 && Probe <= EDimenseProbe::Horizontal5) {
+		Context = MovementDirection;
+	}
+	if (!ConsumeProbe(Probe, Start, HitResult, Context)) {
+		GetWorld()->LineTraceSingleByObjectType(HitResult, Start, End, PlatformObjectParams, QParams);
+		TickProfile.Traces++;
+		DIMENSE_COUNT_LINE_TRACES(1);
+	}
 	if (HitResult.IsValidBlockingHit()) {
 		return true;
 	}
@@ -637,17 +1183,25 @@ void ADimenseCharacter::RotateMeshToMovement(){
 }
 
 void ADimenseCharacter::RotateCamera(const float& Rotation){
-	if (!bSpinning) {
+	if (!bSpinning && !bRewinding && PassInput(Rotation < 0.0f ? EDimenseRecordedInput::RotateLeft : EDimenseRecordedInput::RotateRight)) {
 		for (int32 i = 1; i < 5; i++) {
 			if (UKismetMathLibrary::EqualEqual_RotatorRotator(RotationSpringArm->GetRelativeRotation(), FRotator(0.0f, i * 90.0f, 0.0f), 0.001f)) {
-				RotationSpringArmLatentInfo.ExecutionFunction = FName(TEXT("ResumeMovement"));
+				if (bFixedStepActive) {
+					SetRenderOffset(NullVector); //The spin keeps the arm's current location, so drop the interpolation offset first
+				}
+				RotationSpringArmLatentInfo.ExecutionFunction = FName(TEXT("EndSpin"));
 				RotationSpringArmLatentInfo.UUID = 123;
 				RotationSpringArmLatentInfo.Linkage = 1;
 				RotationSpringArmLatentInfo.CallbackTarget = this;
-				UKismetSystemLibrary::MoveComponentTo(RotationSpringArm, RotationSpringArm->GetRelativeLocation(), FRotator(0.0f, i * 90.0f + Rotation, 0.0f), true, true, 0.6f, true, EMoveComponentAction::Move, RotationSpringArmLatentInfo);
+				UKismetSystemLibrary::MoveComponentTo(RotationSpringArm, RotationSpringArm->GetRelativeLocation(), FRotator(0.0f, i * 90.0f + Rotation, 0.0f), true, true, bShortSpin ? ShortSpinTime : SpinTime, true, EMoveComponentAction::Move, RotationSpringArmLatentInfo);
+				SpinTargetYaw = i * 90.0f + Rotation;
 				bSpinning = true;
-				PauseMovement();
-				InvalidatePlatform(GroundPlatform, CachedGroundPlatform);
+				bSpinPausedMovement = !bShortSpin && !IsNetworked(); //The server doesn't pause, so networked spins are always short ones
+				if (bSpinPausedMovement) {
+					PauseMovement();
+				}
+				MovementQueries.Invalidate(); //Every probe is aimed along the old camera axis
+				//The ground probe is vertical and holds in any view, the rest are along the camera axis
 				InvalidatePlatform(MoveAroundPlatform, CachedMoveAroundPlatform);
 				InvalidatePlatform(TransportPlatform, CachedTransportPlatform);
 				InvalidatePlatform(TryTransportPlatform, CachedTryTransportPlatform);
@@ -656,10 +1210,48 @@ void ADimenseCharacter::RotateCamera(const float& Rotation){
 	}
 }
 
+void ADimenseCharacter::PrepareSpinTarget(){
+	DIMENSE_SCOPE(STAT_DimenseSpinPrepare, PrepareSpinTarget);
+	//The player stands still while the camera turns, so the target view's variables and visibility are worked out now and its probes
+	//are kept in flight on the async trace workers. The first tick after EndSpin then decides on warm results instead of tracing cold.
+	BeginMovementQueries();
+	UpdateMovementSystemVariables();
+	SetVisibilitySide(); //The Transport/MoveAround probes are keyed on it, they must carry the target view's side to be used after EndSpin
+	if (bAsyncMovementQueries) {
+		SubmitMovementQueries();
+	}
+}
+
+void ADimenseCharacter::EndSpin(){
+	bSpinning = false;
+	if (bSpinPausedMovement) {
+		bSpinPausedMovement = false;
+		ResumeMovement();
+	}
+}
+
+float ADimenseCharacter::GetSpinRemainingYaw() const{
+	return bSpinning ? FRotator::NormalizeAxis(SpinTargetYaw - RotationSpringArm->GetRelativeRotation().Yaw) : 0.0f;
+}
+
+FQuat ADimenseCharacter::GetViewQuat() const{
+	//The camera's rotation once the current spin (if any) is over
+	return FQuat(FVector::UpVector, FMath::DegreesToRadians(GetSpinRemainingYaw())) * MainCamera->GetComponentQuat();
+}
+
+FVector ADimenseCharacter::GetViewLocation(const USceneComponent* Component) const{
+	//Where a component of the camera chassis will be once the current spin (if any) is over
+	FVector Pivot = RotationSpringArm->GetComponentLocation();
+	return Pivot + (Component->GetComponentLocation() - Pivot).RotateAngleAxis(GetSpinRemainingYaw(), FVector::UpVector);
+}
+
 void ADimenseCharacter::Die(){
 	FTransform Spawn = PhysicsComp->GetComponentTransform();
 	PauseMovement();
 	UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), DeathParticle, Spawn);
+	if (IsNetworked() && HasAuthority()) {
+		bDiedOnServer = true; //Lets the owning client's next ServerRespawn through
+	}
 	InvalidatePlatform(GroundPlatform, CachedGroundPlatform);
 	InvalidatePlatform(TransportPlatform, CachedTransportPlatform);
 	InvalidatePlatform(TryTransportPlatform, CachedTryTransportPlatform);
@@ -667,15 +1259,156 @@ void ADimenseCharacter::Die(){
 }
 
 void ADimenseCharacter::Respawn(){
+	if (IsNetworked()) {
+		//The server decides where a respawn goes (ServerRespawn), the owning client predicts the same spot from its own copy
+		ApplyMovementOffset(NetCheckpointLocation - GetActorLocation(), EDimenseTeleport::Respawn);
+	}else if (bHasCheckpoint) {
+		RestoreMovementState(Checkpoint); //Exactly as the player was at the checkpoint
+	}else{
+		PhysicsComp->SetWorldLocation(GroundLocation+FVector(0.0f,0.0f,MyHeight/2));
+		bSnapRenderLocation = true;
+	}
+	//The timers that would reset these are not part of the state
 	bCanMoveAround = true;
 	bCanTransport = true;
-	PhysicsComp->SetWorldLocation(GroundLocation+FVector(0.0f,0.0f,MyHeight/2));
 	GetCharacterMovement()->GravityScale = 1.0f;
 	EnableInput(GetWorld()->GetFirstPlayerController());
 }
 
+void ADimenseCharacter::CaptureMovementState(FDimenseMovementState& State) const{
+	const UCharacterMovementComponent* Movement = GetCharacterMovement();
+	State.Time = HistoryClock;
+	State.Location = GetActorLocation();
+	State.Velocity = Movement->Velocity;
+	State.GroundLocation = GroundLocation;
+	State.Platforms[FDimenseMovementState::Ground] = GroundPlatform;
+	State.Platforms[FDimenseMovementState::CachedGround] = CachedGroundPlatform;
+	State.Platforms[FDimenseMovementState::Transport] = TransportPlatform;
+	State.Platforms[FDimenseMovementState::CachedTransport] = CachedTransportPlatform;
+	State.Platforms[FDimenseMovementState::TryTransport] = TryTransportPlatform;
+	State.Platforms[FDimenseMovementState::CachedTryTransport] = CachedTryTransportPlatform;
+	State.Platforms[FDimenseMovementState::MoveAround] = MoveAroundPlatform;
+	State.Platforms[FDimenseMovementState::CachedMoveAround] = CachedMoveAroundPlatform;
+	State.JumpKeyHoldTime = JumpKeyHoldTime;
+	State.JumpCurrentCount = int8(JumpCurrentCount);
+	State.MovementMode = uint8(Movement->MovementMode);
+	State.ViewIndex = int8(GetViewIndex());
+	State.CamSide = int8(CamSide);
+	State.CamSign = int8(CamSign);
+	State.VisibilitySide = int8(VisibilitySide);
+	State.MovementDirection = int8(MovementDirection);
+	State.FacingDirection = int8(FacingDirection);
+	State.Flags = (bCanTransport ? FDimenseMovementState::CanTransport : 0) | (bCanMoveAround ? FDimenseMovementState::CanMoveAround : 0)
+		| (bJumpPressed ? FDimenseMovementState::JumpPressed : 0) | (bMoveDownPressed ? FDimenseMovementState::MoveDownPressed : 0)
+		| (bPressedJump ? FDimenseMovementState::PressedJump : 0);
+}
+
+void ADimenseCharacter::RestoreMovementState(const FDimenseMovementState& State){
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	SetActorLocation(State.Location, false, nullptr, ETeleportType::TeleportPhysics);
+	Movement->SetMovementMode(EMovementMode(State.MovementMode));
+	Movement->Velocity = State.Velocity;
+	GroundLocation = State.GroundLocation;
+	//Platforms destroyed since come back as nullptr
+	GroundPlatform = State.Platforms[FDimenseMovementState::Ground].Get();
+	CachedGroundPlatform = State.Platforms[FDimenseMovementState::CachedGround].Get();
+	TransportPlatform = State.Platforms[FDimenseMovementState::Transport].Get();
+	CachedTransportPlatform = State.Platforms[FDimenseMovementState::CachedTransport].Get();
+	TryTransportPlatform = State.Platforms[FDimenseMovementState::TryTransport].Get();
+	CachedTryTransportPlatform = State.Platforms[FDimenseMovementState::CachedTryTransport].Get();
+	MoveAroundPlatform = State.Platforms[FDimenseMovementState::MoveAround].Get();
+	CachedMoveAroundPlatform = State.Platforms[FDimenseMovementState::CachedMoveAround].Get();
+	JumpKeyHoldTime = State.JumpKeyHoldTime;
+	JumpCurrentCount = State.JumpCurrentCount;
+	SetViewIndex(State.ViewIndex);
+	ViewOrientation = DimenseCore::GetViewOrientation(State.ViewIndex);
+	CamSide = State.CamSide;
+	CamSign = State.CamSign;
+	VisibilitySide = State.VisibilitySide;
+	MovementDirection = State.MovementDirection;
+	FacingDirection = State.FacingDirection;
+	bCanTransport = (State.Flags & FDimenseMovementState::CanTransport) != 0;
+	bCanMoveAround = (State.Flags & FDimenseMovementState::CanMoveAround) != 0;
+	bJumpPressed = (State.Flags & FDimenseMovementState::JumpPressed) != 0;
+	bMoveDownPressed = (State.Flags & FDimenseMovementState::MoveDownPressed) != 0;
+	bPressedJump = (State.Flags & FDimenseMovementState::PressedJump) != 0;
+	MovementQueries.Invalidate(); //The probes were aimed from somewhere else
+	bSnapRenderLocation = true;
+}
+
+int32 ADimenseCharacter::GetViewIndex() const{
+	//A spin counts as the view it is turning to
+	float Yaw = bSpinning ? SpinTargetYaw : RotationSpringArm->GetRelativeRotation().Yaw;
+	return (FMath::RoundToInt(Yaw / 90.0f) % 4 + 4) % 4;
+}
+
+void ADimenseCharacter::SetViewIndex(const int32 ViewIndex){
+	if (!bSpinning && ViewIndex != GetViewIndex()) {
+		RotationSpringArm->SetRelativeRotation(FRotator(0.0f, ViewIndex * 90.0f, 0.0f));
+	}
+}
+
+void ADimenseCharacter::RecordHistory(const float DeltaTime){
+	HistoryClock += DeltaTime;
+	const FDimenseMovementState* Newest = MovementHistory.Newest();
+	if (Newest && HistoryClock - Newest->Time < 1.0f / HistoryRate) {
+		return;
+	}
+	FDimenseMovementState State;
+	CaptureMovementState(State);
+	MovementHistory.Push(State);
+}
+
+void ADimenseCharacter::StartRewind(){
+	//The server can't follow a rewind, it stays a single player feature
+	if (bRewinding || bSpinning || IsNetworked() || MovementHistory.Num() == 0) {
+		return;
+	}
+	bRewinding = true;
+	RewindClock = MovementHistory.Newest()->Time;
+	GetCharacterMovement()->DisableMovement(); //The states are played back as teleports, nothing else moves the character meanwhile
+}
+
+void ADimenseCharacter::TickRewind(const float DeltaTime){
+	//Drop the states newer than the rewind clock, the oldest one is kept to carry on from
+	RewindClock -= DeltaTime * RewindSpeed;
+	while (MovementHistory.Num() > 1 && MovementHistory.Newest()->Time > RewindClock) {
+		MovementHistory.Pop();
+	}
+	const FDimenseMovementState* Newest = MovementHistory.Newest();
+	SetActorLocation(Newest->Location, false, nullptr, ETeleportType::TeleportPhysics);
+	SetViewIndex(Newest->ViewIndex);
+	bSnapRenderLocation = true;
+}
+
+void ADimenseCharacter::StopRewind(){
+	if (!bRewinding) {
+		return;
+	}
+	bRewinding = false;
+	RestoreMovementState(*MovementHistory.Newest());
+	HistoryClock = MovementHistory.Newest()->Time; //New states carry on from the one rewound to
+}
+
+bool ADimenseCharacter::IsRewinding() const{
+	return bRewinding;
+}
+
+void ADimenseCharacter::SetCheckpoint(){
+	CaptureMovementState(Checkpoint);
+	bHasCheckpoint = true;
+}
+
+void ADimenseCharacter::ClearCheckpoint(){
+	bHasCheckpoint = false;
+}
+
+bool ADimenseCharacter::HasCheckpoint() const{
+	return bHasCheckpoint;
+}
+
 FVector ADimenseCharacter::RoundVector(const FVector& Vector) const{
-	return FVector(FMath::RoundToInt(Vector.X), FMath::RoundToInt(Vector.Y), FMath::RoundToInt(Vector.Z));
+	return FDimenseMovementRules::FromCore(DimenseCore::RoundVector(FDimenseMovementRules::ToCore(Vector)));
 }
 
 void ADimenseCharacter::ResetCanMoveAround_Implementation() {}
@@ -718,118 +1451,86 @@ bool ADimenseCharacter::SingleBoxTrace(UPARAM(ref) FHitResult& HitResult, const
 // Called to bind functionality to input
 void ADimenseCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent){
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
+	PlayerInputComponent->BindAction(TEXT("Rewind"), IE_Pressed, this, &ADimenseCharacter::StartRewind);
+	PlayerInputComponent->BindAction(TEXT("Rewind"), IE_Released, this, &ADimenseCharacter::StopRewind);
 }
 
 void ADimenseCharacter::InitDebug(){
-	//Enable/Disable debug printing, views, control panel, etc.
-	if (!bDebug) {
-		bDebugPlatformRemote = false;
-	}
+	//Enable/Disable debug printing, views, control panel, etc. A bDebug set on the Blueprint defaults turns the channels on at start.
+#if DIMENSE_DEBUG_ENABLED
+	if (bDebug) {
+		DimenseDebug::SetEnabled(true);
+	}
+	bDebugSynced = bDebug;
+	bDebugPlatformRemoteSynced = bDebugPlatformRemote;
+	SyncDebugMirrors();
+#else
+	bDebug = false;
+	bDebugPlatformRemote = false;
+#endif
+}
+
+void ADimenseCharacter::SyncDebugMirrors(){
+#if DIMENSE_DEBUG_ENABLED
+	//A Blueprint write to a mirror is pushed to its console variable, otherwise the mirror follows the console variable
+	if (bDebug != bDebugSynced) {
+		DimenseDebug::SetEnabled(bDebug);
+	}
+	bDebug = DimenseDebug::IsEnabled();
+	bDebugSynced = bDebug;
+	if (bDebugPlatformRemote != bDebugPlatformRemoteSynced) {
+		DimenseDebug::SetEnabled(EDimenseDebugChannel::PlatformRemote, bDebugPlatformRemote);
+	}
+	bDebugPlatformRemote = DIMENSE_DEBUG(PlatformRemote);
+	bDebugPlatformRemoteSynced = bDebugPlatformRemote;
+#endif
 }
 
 void ADimenseCharacter::Debug() const{
-	FString TransportPlatformText = TEXT("TransportPlatform: ");
-	FString TryTransportPlatformText = TEXT("TryTransportPlatform: ");
-	FString GroundPlatformText = TEXT("GroundPlatform: ");
-	FString MoveAroundPlatformText = TEXT("MoveAroundPlatform: ");
-	FString CachedMoveAroundPlatformText = TEXT("MoveAroundPlatform_CACHED: ");
-	FString CachedTransportPlatformText = TEXT("TransportPlatform_CACHED: ");
-	FString CachedTryTransportPlatformText = TEXT("TryTransportPlatform_CACHED: ");
-	FString CachedGroundPlatformText = TEXT("GroundPlatform_CACHED: ");
-	bool bIsFalling = GetCharacterMovement()->IsFalling();
-
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::White, (TEXT(""))); //Blank Line for Spacing
-	//Cached Move Around Edge Platform debug
-	if (CachedMoveAroundPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Yellow, (TEXT("%s"), CachedMoveAroundPlatformText + CachedMoveAroundPlatform->GetName()));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), CachedMoveAroundPlatformText + FString(TEXT("NULL"))));
-	}
-	//Move Around Edge Platform debug
-	if (MoveAroundPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), MoveAroundPlatformText + MoveAroundPlatform->GetName()));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), MoveAroundPlatformText + FString(TEXT("NULL"))));
-	}
-	//Transport Platform debug
-	if (TransportPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), TransportPlatformText + TransportPlatform->GetName()));
-	}else if (CachedTransportPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Yellow, (TEXT("%s"), CachedTransportPlatformText + CachedTransportPlatform->GetName()));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), TransportPlatformText + FString(TEXT("NULL"))));
-	}
-	if (TryTransportPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), TryTransportPlatformText + TryTransportPlatform->GetName()));
-	}
-	else if (CachedTryTransportPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Yellow, (TEXT("%s"), CachedTryTransportPlatformText + CachedTryTransportPlatform->GetName()));
-	}
-	else {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), TransportPlatformText + FString(TEXT("NULL"))));
-	}
-	//Recent Ground Platform debug
-	if (GroundPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), GroundPlatformText + GroundPlatform->GetName()));
-	}else if (CachedGroundPlatform) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Yellow, (TEXT("%s"), CachedGroundPlatformText + CachedGroundPlatform->GetName()));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), GroundPlatformText + FString(TEXT("NULL"))));
-	}
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::White, (TEXT(""))); //Blank Line for Spacing
-	if (bSpinning) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("Spinning: true")));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("Spinning: false")));
-	}
-	//Can Move Around Edge debug
-	if (bCanMoveAround) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("CanMoveAround: true")));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("CanMoveAround: false")));
-	}
-	//Can Transport debug
-	if (bCanTransport) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("CanTransport: true")));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("CanTransport: false")));
-	}
-	//Is Falling debug
-	if (bIsFalling) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("OnGround: false")));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("OnGround: true")));
-	}
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::White, (TEXT(""))); //Blank Line for Spacing
-	//Cam Sign debug
-	if (CamSign == 1) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), FString(TEXT("CameraSign: ")) + FString::FromInt(CamSign)));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), FString(TEXT("CameraSign: ")) + FString::FromInt(CamSign)));
-	}
-	//Cam Side debug
-	if (CamSide == 1) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), FString(TEXT("CameraSide: ")) + FString::FromInt(CamSide)));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), FString(TEXT("CameraSide: ")) + FString::FromInt(CamSide)));
-	}
-	//Visibility Side debug
-	if (VisibilitySide == 1) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("%s"), FString(TEXT("Visibility: ")) + FString::FromInt(VisibilitySide)));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("%s"), FString(TEXT("Visibility: ")) + FString::FromInt(VisibilitySide)));
-	}
-	//Movement Direction debug
-	if (MovementDirection == 1) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("Moving Right")));
-	}else if (MovementDirection == -1) {
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Green, (TEXT("Moving Left")));
-	}else{
-		GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, (TEXT("Not Moving")));
-	}
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Turquoise, (TEXT("%s"), FString(TEXT("Movement Direction: ")) + FString::FromInt(MovementDirection)));
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Turquoise, (TEXT("%s"), FString(TEXT("FootLocation: ")) + FootLocation.ToString()));
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Turquoise, (TEXT("%s"), FString(TEXT("HeadLocation: ")) + HeadLocation.ToString()));
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Turquoise, (TEXT("%s"), FString(TEXT("GroundLocation: ")) + *GroundLocation.ToString()));
-	GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Turquoise, (TEXT("%s"), FString(TEXT("CameraForwardVector: ")) + *CamForwardVector.ToString()));
-}
\ No newline at end of file
+	//Retained panel: each line hashes what it shows and only rebuilds its text when that changed
+	auto PlatformLine = [this](const int32 Line, const TCHAR* Label, const APlatformMaster* Platform, const TCHAR* CachedLabel, const APlatformMaster* CachedPlatform) {
+		if (Platform) {
+			DebugPanel.SetLine(Line, GetTypeHash(Platform), FColor::Green, [&]() { return FString(Label) + Platform->GetName(); });
+		}else if (CachedPlatform) {
+			DebugPanel.SetLine(Line, GetTypeHash(CachedPlatform), FColor::Yellow, [&]() { return FString(CachedLabel) + CachedPlatform->GetName(); });
+		}else{
+			DebugPanel.SetLine(Line, 0, FColor::Red, [&]() { return FString(Label) + TEXT("NULL"); });
+		}
+	};
+	auto BoolLine = [this](const int32 Line, const TCHAR* Label, const bool bValue, const bool bGood) {
+		DebugPanel.SetLine(Line, bValue, bValue == bGood ? FColor::Green : FColor::Red, [&]() { return FString(Label) + (bValue ? TEXT("true") : TEXT("false")); });
+	};
+	auto IntLine = [this](const int32 Line, const TCHAR* Label, const int32 Value, const FColor& Color) {
+		DebugPanel.SetLine(Line, GetTypeHash(Value), Color, [&]() { return FString(Label) + FString::FromInt(Value); });
+	};
+	auto VectorLine = [this](const int32 Line, const TCHAR* Label, const FVector& Value) {
+		DebugPanel.SetLine(Line, GetTypeHash(Value), FColor::Turquoise, [&]() { return FString(Label) + Value.ToString(); });
+	};
+	auto BlankLine = [this](const int32 Line) { //Blank Line for Spacing
+		DebugPanel.SetLine(Line, 0, FColor::White, []() { return FString(); });
+	};
+
+	BlankLine(0);
+	PlatformLine(1, TEXT("MoveAroundPlatform_CACHED: "), nullptr, TEXT("MoveAroundPlatform_CACHED: "), CachedMoveAroundPlatform);
+	PlatformLine(2, TEXT("MoveAroundPlatform: "), MoveAroundPlatform, TEXT("MoveAroundPlatform: "), nullptr);
+	PlatformLine(3, TEXT("TransportPlatform: "), TransportPlatform, TEXT("TransportPlatform_CACHED: "), CachedTransportPlatform);
+	PlatformLine(4, TEXT("TryTransportPlatform: "), TryTransportPlatform, TEXT("TryTransportPlatform_CACHED: "), CachedTryTransportPlatform);
+	PlatformLine(5, TEXT("GroundPlatform: "), GroundPlatform, TEXT("GroundPlatform_CACHED: "), CachedGroundPlatform);
+	BlankLine(6);
+	BoolLine(7, TEXT("Spinning: "), bSpinning, false);
+	BoolLine(8, TEXT("CanMoveAround: "), bCanMoveAround, true);
+	BoolLine(9, TEXT("CanTransport: "), bCanTransport, true);
+	BoolLine(10, TEXT("OnGround: "), !GetCharacterMovement()->IsFalling(), true);
+	BlankLine(11);
+	IntLine(12, TEXT("CameraSign: "), CamSign, CamSign == 1 ? FColor::Green : FColor::Red);
+	IntLine(13, TEXT("CameraSide: "), CamSide, CamSide == 1 ? FColor::Green : FColor::Red);
+	IntLine(14, TEXT("Visibility: "), VisibilitySide, VisibilitySide == 1 ? FColor::Green : FColor::Red);
+	DebugPanel.SetLine(15, GetTypeHash(MovementDirection), MovementDirection == 0 ? FColor::Red : FColor::Green, [&]() {
+		return FString(MovementDirection == 1 ? TEXT("Moving Right") : MovementDirection == -1 ? TEXT("Moving Left") : TEXT("Not Moving"));
+	});
+	IntLine(16, TEXT("Movement Direction: "), MovementDirection, FColor::Turquoise);
+	VectorLine(17, TEXT("FootLocation: "), FootLocation);
+	VectorLine(18, TEXT("HeadLocation: "), HeadLocation);
+	VectorLine(19, TEXT("GroundLocation: "), GroundLocation);
+	VectorLine(20, TEXT("CameraForwardVector: "), CamForwardVector);
+}
@@ -4,6 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "DimenseMovementQueries.h"
+#include "DimenseDebug.h"
+#include "DimenseInputRecorder.h"
+#include "DimenseMovementState.h"
+#include "DimenseMovementComponent.h"
+#include "DimenseCore.h"
 #include "DimenseCharacter.generated.h"
 
 class USpringArmComponent;
@@ -11,6 +17,7 @@ class UCameraComponent;
 class UWorld;
 class UParticleSystem;
 class APlatformMaster;
+class UPlatformProjectionSubsystem;
 
 UCLASS()
 class PLATFORMERCPP_API ADimenseCharacter : public ACharacter
@@ -48,38 +55,122 @@ public:
 		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
 			int32 VisibilitySide;
 
-		//Debug
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
+		//Debug (the channels are console variables, see DimenseDebug.h)
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (Tooltip = "Mirror of dimense.Debug for Blueprints. Writing it sets the console variable. Always false in Test/Shipping."))
 			bool bDebug;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug", meta = (Tooltip = "Mirror of dimense.Debug.PlatformRemote for Blueprints. Writing it sets the console variable."))
 			bool bDebugPlatformRemote;
 
 		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugVisibility;
+			bool bIsInside;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugGround;
+		//Movement Queries
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement Queries", meta = (Tooltip = "Submit the movement probes of each tick as one async trace batch and decide on the results next tick. Off = synchronous traces."))
+			bool bAsyncMovementQueries;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugTransport;
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement Queries", meta = (Tooltip = "While async, run every Nth tick synchronously to measure the game thread time saved (0 = never)."))
+			int32 SyncQuerySampleInterval;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugAbovePlatform;
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement Queries", meta = (ClampMin = "0", Tooltip = "An async result is only used if its probe started within this distance of where this tick's probe starts, otherwise it is traced again."))
+			float AsyncProbeTolerance;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugMoveAround;
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement Queries", meta = (Tooltip = "Answer the Transport and MoveAround sweeps from the platform projection index instead of the physics scene."))
+			bool bUsePlatformIndex;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugInvalidation;
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement Queries", meta = (Tooltip = "Answer the VisibilitySide checks from the platform occlusion buffers instead of ray casts. Only platforms occlude."))
+			bool bUseOcclusionBuffer;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bDebugCachedInvalidation;
+		//Fixed Step
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fixed Step", meta = (Tooltip = "Run input, platform checks and the movement component in fixed steps instead of once per frame. The mesh and camera are interpolated between steps."))
+			bool bFixedStepSimulation;
 
-		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
-			bool bIsInside;
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fixed Step", meta = (ClampMin = "1", Tooltip = "Simulation steps per second."))
+			float FixedStepRate;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fixed Step", meta = (ClampMin = "1", Tooltip = "Most steps run in one frame. Time beyond that is dropped so a hitch can't snowball."))
+			int32 MaxStepsPerFrame;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Fixed Step", meta = (Tooltip = "Replace player input with a left/right pattern driven by the step count, to compare decision checksums between frame rates."))
+			bool bFixedStepScriptedInput;
+
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Fixed Step")
+			int32 SimulationStep;
+
+		//Camera Spin
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Spin", meta = (ClampMin = "0", Tooltip = "Seconds the camera takes to turn to the next 90 degree view. Movement is paused meanwhile."))
+			float SpinTime;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Spin", meta = (Tooltip = "Turn over ShortSpinTime without pausing movement or input. The movement system switches to the new view as the spin starts."))
+			bool bShortSpin;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera Spin", meta = (ClampMin = "0", Tooltip = "Seconds the camera takes to turn in short spin mode."))
+			float ShortSpinTime;
+
+		//Rewind
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind", meta = (ClampMin = "0", Tooltip = "Seconds of movement kept for rewinding. Read on BeginPlay."))
+			float MaxRewindSeconds;
+
+		UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rewind", meta = (ClampMin = "1", Tooltip = "Movement states kept per second. Read on BeginPlay."))
+			float HistoryRate;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind", meta = (ClampMin = "0", Tooltip = "Seconds of movement scrubbed back per second of holding Rewind."))
+			float RewindSpeed;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rewind", meta = (Tooltip = "Set a checkpoint every time the player lands on a new ground platform. Respawn returns to the last checkpoint."))
+			bool bAutoCheckpoint;
+
+		//Network
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ClampMin = "0", Tooltip = "How far the server lets a client's Transport/MoveAround land from where the server would put it."))
+			float NetTeleportTolerance;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Network", meta = (ClampMin = "0", Tooltip = "The server only accepts a respawn once it has the character this far below its checkpoint (or this close to the world's KillZ), or after the character died on the server."))
+			float NetRespawnFallDepth;
+
+		UPROPERTY(Replicated)
+			uint8 TeleportCount; //Teleports the server applied, lets other clients snap instead of smoothing across them
+
+		UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Network")
+			int32 NumTeleportsRejected;
 
 	//Functions
+		UFUNCTION(BlueprintCallable, Category = "Fixed Step", meta = (Tooltip = "Hash of the platform decisions (ground/transport/move around platform, visibility side, direction) of every step since fixed step started."))
+			int32 GetDecisionChecksum() const;
+
+		UFUNCTION(BlueprintCallable, Category = "Fixed Step")
+			void ResetDecisionChecksum();
+
+		UFUNCTION(BlueprintCallable, Category = "Fixed Step", meta = (Tooltip = "Runs Steps fixed steps of scripted input from the current state three times, fed by 30, 60 and 240 fps frames, and compares the decision and end transform checksums, then puts the player back. False on a mismatch, or when networked."))
+			bool CheckFixedStepDeterminism(const int32 Steps, int32& Checksum30, int32& Checksum60, int32& Checksum240);
+
+		UFUNCTION(BlueprintCallable, Category = "Rewind", meta = (Tooltip = "Scrub the movement back in time until StopRewind."))
+			void StartRewind();
+
+		UFUNCTION(BlueprintCallable, Category = "Rewind", meta = (Tooltip = "Carry on from where the rewind got to."))
+			void StopRewind();
+
+		UFUNCTION(BlueprintCallable, Category = "Rewind")
+			bool IsRewinding() const;
+
+		UFUNCTION(BlueprintCallable, Category = "Rewind", meta = (Tooltip = "Respawn returns to the movement state of this moment."))
+			void SetCheckpoint();
+
+		UFUNCTION(BlueprintCallable, Category = "Rewind", meta = (Tooltip = "Respawn goes back to the last ground location."))
+			void ClearCheckpoint();
+
+		UFUNCTION(BlueprintCallable, Category = "Rewind")
+			bool HasCheckpoint() const;
+
+		void CaptureMovementState(FDimenseMovementState& State) const;
+		void RestoreMovementState(const FDimenseMovementState& State);
+
+		//Recorded by the possessing ADimensePlayerController
+		virtual void Jump() override;
+		virtual void StopJumping() override;
+
+		//Cost of the movement system in the last tick
+		const FDimenseTickProfile& GetTickProfile() const { return TickProfile; }
+
 		UFUNCTION(BlueprintCallable, Category = "Movement") 
 			FVector GetTransportOffset(const APlatformMaster* Platform) const;
 
@@ -110,14 +201,21 @@ public:
 			UCameraComponent* MainCamera;
 
 private:
+	//The benchmark and the input recorder drive the character through its input functions
+	friend class ADimenseBenchmark;
+	friend class FDimenseInputRecorder;
+
 	//Default Required
-		ADimenseCharacter(); // Sets default values for this character's properties		
+		ADimenseCharacter(const FObjectInitializer& ObjectInitializer); // Sets default values for this character's properties		
 		virtual void BeginPlay() override; // Called when the game starts or when spawned		
 		virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override; // Called to bind functionality to input		
 		virtual void Tick(float DeltaTime) override; // Called every frame
+		virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override; // Called to list the replicated properties
 
 	//Variables
 		float CachedJumpKeyHoldTime;
+		FCollisionObjectQueryParams PlatformObjectParams; //Only platforms, see ECC_Platform
+		DimenseCore::EViewOrientation ViewOrientation; //Set with the Cam* variables, picks the TView the movement math runs on
 		FCollisionQueryParams QParams;
 		FLatentActionInfo RotationSpringArmLatentInfo;
 		FName TraceTag;
@@ -129,6 +227,37 @@ private:
 		FVector HeightPadding;
 		FVector MoveAroundBoxSize;
 		int32 FacingDirection;
+		FDimenseMovementQueries MovementQueries;
+		UPlatformProjectionSubsystem* ProjectionIndex;
+		bool bDeferredQueriesThisTick;
+		int32 TicksUntilSyncSample;
+		float SyncQueryMs;
+		float AsyncQueryMs;
+		bool bFixedStepActive;
+		bool bSnapRenderLocation;
+		float StepAccumulator;
+		uint32 DecisionChecksum;
+		FVector HeldMovementInput;
+		FVector PreviousStepLocation;
+		FVector MeshBaseRelativeLocation;
+		FVector CameraBaseRelativeLocation;
+		float SpinTargetYaw;
+		bool bSpinPausedMovement;
+		FDimenseMovementHistory MovementHistory;
+		FDimenseMovementState Checkpoint;
+		bool bHasCheckpoint;
+		FVector NetCheckpointLocation; //Where the character first stood on its latest floor platform, kept the same way on both ends
+		TWeakObjectPtr<APlatformMaster> NetCheckpointPlatform;
+		bool bDiedOnServer; //Die ran on the server since the last respawn
+		int32 ServerViewIndex; //Server: the view the owning client last reported, Transport/MoveAround must follow its camera axis
+		int32 SentViewIndex; //Owning client: the view last sent with ServerSetViewIndex
+		bool bRewinding;
+		float HistoryClock;
+		float RewindClock;
+		mutable FDimenseTickProfile TickProfile;
+		mutable FDimenseDebugPanel DebugPanel;
+		bool bDebugSynced;
+		bool bDebugPlatformRemoteSynced;
 
 		UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Platform", meta = (AllowPrivateAccess = "true"))
 			APlatformMaster* CachedTransportPlatform = nullptr;
@@ -254,12 +383,65 @@ private:
 
 	//Functions
 		void InitDebug();
+		void SyncDebugMirrors();
+		void BeginMovementQueries();
+		void EndMovementQueries(const uint32 StartCycles);
+		void SubmitMovementQueries();
+		bool ConsumeProbe(const EDimenseProbe Probe, const FVector& Start, FHitResult& HitResult, const int32 Context = 0) const;
+		void GetHorizontalProbe(const int32 Index, FVector& Start, FVector& End) const;
+		FVector GetVisibilityProbeEnd(const int32 Index) const;
+		bool IsVisibilityProbeBlocked(const FVector& Start, const FVector& End, const EDimenseProbe Probe);
+		void GetTransportSweep(const float& ZOffset, FVector& Start, FVector& End) const;
+		void GetMoveAroundSweep(const FVector& Offset, FVector& Start, FVector& End) const;
+		FVector GetCameraLineVector() const;
+		//The same, written against one orientation (DimenseCore::TView) for callers that dispatch once around a batch
+		template <typename FView> void GetHorizontalProbe(const int32 Index, FVector& Start, FVector& End) const;
+		template <typename FView> void GetTransportSweep(const float& ZOffset, FVector& Start, FVector& End) const;
+		template <typename FView> void GetMoveAroundSweep(const FVector& Offset, FVector& Start, FVector& End) const;
+		template <typename FView> FVector GetCameraLineVector() const;
+		bool SweepAlongCameraAxis(FHitResult& HitResult, const FVector& Start, const FVector& End, const FVector& BoxSize, const EDimenseProbe Probe);
+		void SetFixedStepActive(const bool bActive);
+		void TickFixedStep(const float DeltaTime, const int32 StepLimit = MAX_int32);
+		void SimulateMovementStep(const float StepSeconds);
+		void SetRenderOffset(const FVector& WorldOffset);
+		void PrepareSpinTarget();
+		float GetSpinRemainingYaw() const;
+		FQuat GetViewQuat() const;
+		FVector GetViewLocation(const USceneComponent* Component) const;
+		uint32 HashDecisions() const;
+		bool PassInput(const EDimenseRecordedInput Input, const float Value = 0.0f);
+		void RecordHistory(const float DeltaTime);
+		void TickRewind(const float DeltaTime);
+		void SetViewIndex(const int32 ViewIndex);
+		int32 GetViewIndex() const;
+		bool IsNetworked() const;
+		bool RunsMovementSystem() const;
+		void ApplyMovementOffset(const FVector& Offset, const EDimenseTeleport Kind);
+		bool IsTeleportPlausible(const FVector& Offset, const EDimenseTeleport Kind) const;
+
+		UFUNCTION(Server, Reliable, WithValidation)
+			void ServerRequestTeleport(const float ClientTimeStamp, const FVector_NetQuantize10& Offset, const EDimenseTeleport Kind);
+
+		//No offset is sent, the server respawns the character at its own NetCheckpointLocation
+		UFUNCTION(Server, Reliable, WithValidation)
+			void ServerRespawn(const float ClientTimeStamp);
+
+		//Reliable like the teleport requests, so the server has the new view before any teleport made in it
+		UFUNCTION(Server, Reliable, WithValidation)
+			void ServerSetViewIndex(const uint8 ViewIndex);
+
+		void SendViewIndex();
+		bool CanServerRespawn() const;
+		void RejectTeleport(const FVector& Offset, const EDimenseTeleport Kind);
+
+		//Server and owning client: where a networked respawn goes, from the movement component's floor (see UpdateNetCheckpoint)
+		void UpdateNetCheckpoint();
 
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
-			bool BoxTraceForTransportHit(const float& ZOffset);
+			bool BoxTraceForTransportHit(const float& ZOffset, const EDimenseProbe Probe = EDimenseProbe::None);
 
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
-			bool BoxTraceForMoveAroundHit(FHitResult& HitResult, FVector BoxTraceOffset);
+			bool BoxTraceForMoveAroundHit(FHitResult& HitResult, FVector BoxTraceOffset, const EDimenseProbe Probe = EDimenseProbe::None);
 
 		UFUNCTION(BlueprintCallable, Category = "Events", meta = (AllowPrivateAccess = "true"))
 			bool CheckDeathByFallDistance();
@@ -285,19 +467,19 @@ private:
 		*/
 
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
-			bool SingleTrace(UPARAM(ref) FHitResult& HitResult, const FVector& Start, const FVector& End) const;
+			bool SingleTrace(UPARAM(ref) FHitResult& HitResult, const FVector& Start, const FVector& End, const EDimenseProbe Probe = EDimenseProbe::None) const;
 
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
 			bool TryTransport();
 
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
-			bool TryMoveAround(UPARAM(ref) FHitResult& HitResult, FVector BoxTraceOffset);
+			bool TryMoveAround(UPARAM(ref) FHitResult& HitResult, FVector BoxTraceOffset, const EDimenseProbe Probe = EDimenseProbe::None);
 
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
-			bool BoxTraceVertical(const FVector& Location, FHitResult& HitResult, const FVector BoxSize, const float& TraceLength, const int32 UpOrDown, const FString DebugPhrase, const int32 DebugTime, const bool bDebugLocal);
+			bool BoxTraceVertical(const FVector& Location, FHitResult& HitResult, const FVector BoxSize, const float& TraceLength, const int32 UpOrDown, const FString DebugPhrase, const int32 DebugTime, const bool bDebugLocal, const EDimenseProbe Probe = EDimenseProbe::None);
 		
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
-			bool VisibilityCheck(const FVector& Start);
+			bool VisibilityCheck(const FVector& Start, const EDimenseProbe FirstProbe = EDimenseProbe::None);
 	
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
 			FVector GetMovementInputFRI();
@@ -350,6 +532,9 @@ private:
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
 			void RotateCamera(const float& Rotation);
 
+		UFUNCTION(Category = "Default", meta = (AllowPrivateAccess = "true", BlueprintInternalUseOnly = "true"))
+			void EndSpin();
+
 		UFUNCTION(BlueprintCallable, Category = "Movement", meta = (AllowPrivateAccess = "true"))
 			void RotateMeshToMovement();
 
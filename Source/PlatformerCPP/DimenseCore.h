@@ -0,0 +1,172 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include <cmath>
+
+/**
+ * The movement system's decision math with no engine types in it: camera basis rounding, movement direction, the Transport and
+ * MoveAround offsets and the above-platform test. Header only and standard C++ only, so it can be compiled, stepped through and
+ * timed outside the editor. FDimenseMovementRules and ADimenseCharacter convert to and from FVector at the boundary.
+ * The camera only ever looks along one of four world axes, so the hot path picks the orientation once (DispatchView) and runs
+ * TView<Orientation> code, where multiplying by the camera vectors becomes picking an axis and flipping a sign.
+ */
+namespace DimenseCore
+{
+	struct FVec3
+	{
+		float X = 0.0f;
+		float Y = 0.0f;
+		float Z = 0.0f;
+
+		constexpr FVec3() = default;
+		constexpr FVec3(const float InX, const float InY, const float InZ) : X(InX), Y(InY), Z(InZ) {}
+
+		constexpr FVec3 operator+(const FVec3& Other) const { return FVec3(X + Other.X, Y + Other.Y, Z + Other.Z); }
+		constexpr FVec3 operator-(const FVec3& Other) const { return FVec3(X - Other.X, Y - Other.Y, Z - Other.Z); }
+		constexpr FVec3 operator*(const FVec3& Other) const { return FVec3(X * Other.X, Y * Other.Y, Z * Other.Z); }
+		constexpr FVec3 operator*(const float Scale) const { return FVec3(X * Scale, Y * Scale, Z * Scale); }
+		constexpr bool operator==(const FVec3& Other) const { return X == Other.X && Y == Other.Y && Z == Other.Z; }
+
+		FVec3 GetAbs() const { return FVec3(std::fabs(X), std::fabs(Y), std::fabs(Z)); }
+	};
+
+	//Camera vectors snapped to the world axes, and the signs the movement system derives from them
+	struct FViewBasis
+	{
+		FVec3 Forward;
+		FVec3 Right;
+		int CamSign = 1; //+1 when the camera's right points along +X or +Y
+		int CamSide = 1; //+1 when the camera looks along X, -1 along Y
+	};
+
+	//Same rounding as FMath::RoundToInt (half up)
+	inline int RoundToInt(const float Value){
+		return static_cast<int>(std::floor(Value + 0.5f));
+	}
+
+	inline int Sign(const float Value){
+		return Value > 0.0f ? 1 : (Value < 0.0f ? -1 : 0);
+	}
+
+	inline FVec3 RoundVector(const FVec3& Vector){
+		return FVec3(float(RoundToInt(Vector.X)), float(RoundToInt(Vector.Y)), float(RoundToInt(Vector.Z)));
+	}
+
+	//Basis for a camera with these (unrounded) forward and right vectors, as UpdateMovementSystemVariables derives it
+	inline FViewBasis GetViewBasis(const FVec3& Forward, const FVec3& Right){
+		FViewBasis Basis;
+		Basis.Forward = RoundVector(Forward);
+		Basis.Right = RoundVector(Right);
+		Basis.CamSign = Sign(Basis.Right.Y + Basis.Right.X);
+		Basis.CamSide = std::fabs(Basis.Forward.X) > 0.1f ? 1 : -1;
+		return Basis;
+	}
+
+	//Basis for a view index (RotationSpringArm yaw / 90), any integer wraps to 0-3
+	inline FViewBasis GetViewBasis(const int ViewIndex){
+		constexpr FVec3 Forwards[4] = { FVec3(1.0f, 0.0f, 0.0f), FVec3(0.0f, 1.0f, 0.0f), FVec3(-1.0f, 0.0f, 0.0f), FVec3(0.0f, -1.0f, 0.0f) };
+		int View = ((ViewIndex % 4) + 4) % 4;
+		return GetViewBasis(Forwards[View], Forwards[(View + 1) % 4]);
+	}
+
+	//View index for a rounded camera forward vector
+	inline int GetViewIndex(const FVec3& Forward){
+		if (std::fabs(Forward.X) >= std::fabs(Forward.Y)) {
+			return Forward.X >= 0.0f ? 0 : 2;
+		}
+		return Forward.Y >= 0.0f ? 1 : 3;
+	}
+
+	//1 moving right on the view, -1 left, 0 with no horizontal motion (vertical only motion included). Previous is kept only when
+	//none of the comparisons hold, which takes a NaN component.
+	inline int GetMovementDirection(const FVec3& Velocity, const int CamSign, const int Previous){
+		if (Velocity.X * CamSign > 0 || Velocity.Y * CamSign > 0) {
+			return 1;
+		}
+		if (Velocity.X * CamSign < 0 || Velocity.Y * CamSign < 0) {
+			return -1;
+		}
+		if (Velocity.X == 0.0f && Velocity.Y == 0.0f) {
+			return 0;
+		}
+		return Previous;
+	}
+
+	//Offset along the camera axis that puts Location over the platform hit at HitLocation, Padding past its near edge
+	inline FVec3 GetTransportOffset(const FVec3& HitLocation, const float TopZ, const FVec3& Location, const FVec3& CamForward, const FVec3& Padding, const int CamSide, const int CamSign, const int VisibilitySide){
+		FVec3 Offset = FVec3(HitLocation.X, HitLocation.Y, TopZ) - Location;
+		return CamForward.GetAbs() * (Offset + Padding * float(CamSide) * float(CamSign) * float(VisibilitySide));
+	}
+
+	//Offset along the camera axis that puts Location in front of the platform hit at HitLocation, Padding short of it
+	inline FVec3 GetMoveAroundOffset(const FVec3& HitLocation, const FVec3& Location, const FVec3& CamForward, const FVec3& Padding, const int CamSide, const int CamSign, const int VisibilitySide){
+		FVec3 Offset = HitLocation - Location;
+		return CamForward.GetAbs() * (Offset - Padding * float(CamSide) * float(CamSign) * float(VisibilitySide));
+	}
+
+	//Can the player land on a platform with this top face: already standing on it, or feet at or above it
+	inline bool IsAbovePlatform(const float FootZ, const float TopZ, const bool bIsGroundPlatform){
+		return bIsGroundPlatform || FootZ >= TopZ;
+	}
+
+	//The four camera orientations, named after the axis the camera looks along. The value is the view index.
+	enum class EViewOrientation : int { PosX = 0, PosY = 1, NegX = 2, NegY = 3 };
+
+	inline EViewOrientation GetViewOrientation(const int ViewIndex){
+		return static_cast<EViewOrientation>(((ViewIndex % 4) + 4) % 4);
+	}
+
+	template <int Axis> inline float GetComponent(const FVec3& Vector){
+		static_assert(Axis >= 0 && Axis <= 2, "Axis is X (0), Y (1) or Z (2)");
+		return Axis == 0 ? Vector.X : (Axis == 1 ? Vector.Y : Vector.Z);
+	}
+
+	template <int Axis> inline FVec3 OnAxis(const float Value){
+		static_assert(Axis >= 0 && Axis <= 1, "Axis is X (0) or Y (1)");
+		return Axis == 0 ? FVec3(Value, 0.0f, 0.0f) : FVec3(0.0f, Value, 0.0f);
+	}
+
+	//One orientation's camera basis as constants, and the movement math written against them. Matches GetViewBasis(int(View)).
+	template <EViewOrientation View>
+	struct TView
+	{
+		static constexpr int Index = static_cast<int>(View);
+		static constexpr int Axis = Index % 2; //Component the camera looks along (0 X, 1 Y)
+		static constexpr int AcrossAxis = 1 - Axis; //Component the camera's right runs along
+		static constexpr float ForwardSign = Index < 2 ? 1.0f : -1.0f;
+		static constexpr float RightSign = (Index + 1) % 4 < 2 ? 1.0f : -1.0f;
+		static constexpr int CamSign = RightSign > 0.0f ? 1 : -1;
+		static constexpr int CamSide = Axis == 0 ? 1 : -1;
+
+		//Length along the camera's forward / right vector
+		static FVec3 Forward(const float Length) { return OnAxis<Axis>(Length * ForwardSign); }
+		static FVec3 Right(const float Length) { return OnAxis<AcrossAxis>(Length * RightSign); }
+
+		//Right * RightLength + Forward * ForwardLength
+		static FVec3 RightAndForward(const float RightLength, const float ForwardLength) {
+			return Right(RightLength) + Forward(ForwardLength);
+		}
+
+		//Same as the FVec3 GetTransportOffset, only the camera axis component can be non zero
+		static FVec3 TransportOffset(const FVec3& HitLocation, const FVec3& Location, const FVec3& Padding, const int VisibilitySide){
+			return OnAxis<Axis>(GetComponent<Axis>(HitLocation) - GetComponent<Axis>(Location) + GetComponent<Axis>(Padding) * float(CamSide * CamSign * VisibilitySide));
+		}
+
+		//Same as the FVec3 GetMoveAroundOffset
+		static FVec3 MoveAroundOffset(const FVec3& HitLocation, const FVec3& Location, const FVec3& Padding, const int VisibilitySide){
+			return OnAxis<Axis>(GetComponent<Axis>(HitLocation) - GetComponent<Axis>(Location) - GetComponent<Axis>(Padding) * float(CamSide * CamSign * VisibilitySide));
+		}
+	};
+
+	//Calls Func with the TView of View (an empty object, use decltype on it), so the switch happens once around a whole batch of math
+	template <typename FFunc>
+	decltype(auto) DispatchView(const EViewOrientation View, FFunc&& Func){
+		switch (View) {
+			case EViewOrientation::PosY: return Func(TView<EViewOrientation::PosY>());
+			case EViewOrientation::NegX: return Func(TView<EViewOrientation::NegX>());
+			case EViewOrientation::NegY: return Func(TView<EViewOrientation::NegY>());
+			default: return Func(TView<EViewOrientation::PosX>());
+		}
+	}
+}
@@ -0,0 +1,69 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseDebug.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/Engine.h"
+
+#if DIMENSE_DEBUG_ENABLED
+namespace DimenseDebug {
+	bool bEnabled = false;
+	//Channel defaults are the old per character bDebug* defaults
+	bool bChannels[static_cast<int32>(EDimenseDebugChannel::Count)] = {
+		false, //Visibility
+		true, //Ground
+		true, //Transport
+		true, //AbovePlatform
+		true, //MoveAround
+		true, //Invalidation
+		false, //CachedInvalidation
+		true, //PlatformRemote
+		true //Panel
+	};
+
+	static FAutoConsoleVariableRef CVarDebug(TEXT("dimense.Debug"), bEnabled, TEXT("Master switch for Dimense debug drawing and the state panel."));
+	static FAutoConsoleVariableRef CVarVisibility(TEXT("dimense.Debug.Visibility"), bChannels[static_cast<int32>(EDimenseDebugChannel::Visibility)], TEXT("Draw the visibility lines."));
+	static FAutoConsoleVariableRef CVarGround(TEXT("dimense.Debug.Ground"), bChannels[static_cast<int32>(EDimenseDebugChannel::Ground)], TEXT("Draw the ground and head boxes."));
+	static FAutoConsoleVariableRef CVarTransport(TEXT("dimense.Debug.Transport"), bChannels[static_cast<int32>(EDimenseDebugChannel::Transport)], TEXT("Draw Transport sweeps and targets."));
+	static FAutoConsoleVariableRef CVarAbovePlatform(TEXT("dimense.Debug.AbovePlatform"), bChannels[static_cast<int32>(EDimenseDebugChannel::AbovePlatform)], TEXT("Draw the player above platform checks."));
+	static FAutoConsoleVariableRef CVarMoveAround(TEXT("dimense.Debug.MoveAround"), bChannels[static_cast<int32>(EDimenseDebugChannel::MoveAround)], TEXT("Draw MoveAround sweeps, wall checks and offsets."));
+	static FAutoConsoleVariableRef CVarInvalidation(TEXT("dimense.Debug.Invalidation"), bChannels[static_cast<int32>(EDimenseDebugChannel::Invalidation)], TEXT("Draw platforms as they are invalidated."));
+	static FAutoConsoleVariableRef CVarCachedInvalidation(TEXT("dimense.Debug.CachedInvalidation"), bChannels[static_cast<int32>(EDimenseDebugChannel::CachedInvalidation)], TEXT("Draw cached platforms as they are cleared."));
+	static FAutoConsoleVariableRef CVarPlatformRemote(TEXT("dimense.Debug.PlatformRemote"), bChannels[static_cast<int32>(EDimenseDebugChannel::PlatformRemote)], TEXT("Draw the checks done by platforms (platform above platform)."));
+	static FAutoConsoleVariableRef CVarPanel(TEXT("dimense.Debug.Panel"), bChannels[static_cast<int32>(EDimenseDebugChannel::Panel)], TEXT("Show the character state panel."));
+}
+#endif
+
+uint64 FDimenseDebugPanel::NextKey = 0x0D1E0000;
+
+FDimenseDebugPanel::FDimenseDebugPanel(const int32 NumLines){
+	FirstKey = NextKey;
+	NextKey += NumLines;
+	Hashes.Init(0, NumLines);
+	Shown.Init(false, NumLines);
+	bAnyShown = false;
+}
+
+void FDimenseDebugPanel::SetLine(const int32 Line, const uint32 ValueHash, const FColor& Color, TFunctionRef<FString()> MakeText){
+	uint32 Hash = HashCombine(ValueHash, GetTypeHash(Color));
+	if (Shown[Line] && Hashes[Line] == Hash) {
+		return;
+	}
+	Hashes[Line] = Hash;
+	Shown[Line] = true;
+	bAnyShown = true;
+	//Keyed messages replace the previous text of the same key, so the line stays on screen until it changes again
+	GEngine->AddOnScreenDebugMessage(FirstKey + Line, MAX_flt, Color, MakeText());
+}
+
+void FDimenseDebugPanel::Hide(){
+	if (!bAnyShown) {
+		return;
+	}
+	for (int32 Line = 0; Line < Hashes.Num(); Line++) {
+		if (Shown[Line]) {
+			GEngine->RemoveOnScreenDebugMessage(FirstKey + Line);
+			Shown[Line] = false;
+		}
+	}
+	bAnyShown = false;
+}
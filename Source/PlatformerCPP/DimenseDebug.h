@@ -0,0 +1,62 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+//Debug drawing and printing only exists in Debug/Development builds. In Test and Shipping every DIMENSE_DEBUG() check is a constant false.
+#define DIMENSE_DEBUG_ENABLED !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+
+//Debug channels. Each one is a console variable (dimense.Debug.<Channel>) and only draws while the dimense.Debug master switch is on.
+enum class EDimenseDebugChannel : uint8 {
+	Visibility,
+	Ground,
+	Transport,
+	AbovePlatform,
+	MoveAround,
+	Invalidation,
+	CachedInvalidation,
+	PlatformRemote, //Checks done by the platforms themselves (PlatformAbovePlatformCheck)
+	Panel, //On screen state panel
+	Count
+};
+
+#if DIMENSE_DEBUG_ENABLED
+namespace DimenseDebug {
+	extern PLATFORMERCPP_API bool bEnabled;
+	extern PLATFORMERCPP_API bool bChannels[static_cast<int32>(EDimenseDebugChannel::Count)];
+
+	inline bool IsEnabled() { return bEnabled; }
+	inline bool IsEnabled(const EDimenseDebugChannel Channel) { return bEnabled && bChannels[static_cast<int32>(Channel)]; }
+	inline void SetEnabled(const bool bInEnabled) { bEnabled = bInEnabled; }
+	inline void SetEnabled(const EDimenseDebugChannel Channel, const bool bInEnabled) { bChannels[static_cast<int32>(Channel)] = bInEnabled; }
+}
+#define DIMENSE_DEBUG(Channel) DimenseDebug::IsEnabled(EDimenseDebugChannel::Channel)
+#else
+#define DIMENSE_DEBUG(Channel) false
+#endif
+
+/**
+ * Retained on screen text panel. Every line remembers a hash of the values it shows and is only rebuilt and re-sent to the screen
+ * when that hash changes, so an unchanged panel costs a hash compare per line instead of a string build and a screen message.
+ */
+class PLATFORMERCPP_API FDimenseDebugPanel
+{
+public:
+	explicit FDimenseDebugPanel(const int32 NumLines = 32);
+
+	//Show a line. MakeText is only called when ValueHash or Color changed since the last call for this line.
+	void SetLine(const int32 Line, const uint32 ValueHash, const FColor& Color, TFunctionRef<FString()> MakeText);
+
+	//Remove every line from the screen
+	void Hide();
+
+private:
+	uint64 FirstKey;
+	TArray<uint32> Hashes;
+	TBitArray<> Shown;
+	bool bAnyShown;
+
+	static uint64 NextKey;
+};
@@ -0,0 +1,51 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseEntranceComponent.h"
+#include "Engine/World.h"
+#include "EntranceStreamingSubsystem.h"
+
+// Sets default values for this component's properties
+UDimenseEntranceComponent::UDimenseEntranceComponent(){
+	PrimaryComponentTick.bCanEverTick = false;
+	DestinationTransform = FTransform::Identity;
+	bInterior = true;
+	PreloadRadius = 800.0f;
+}
+
+// Called when the game starts
+void UDimenseEntranceComponent::BeginPlay(){
+	Super::BeginPlay();
+	GetDestinationKey();
+	if (UEntranceStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UEntranceStreamingSubsystem>()) {
+		Streaming->RegisterEntrance(this);
+	}
+}
+
+// Called when the owner is destroyed or its level is unloaded
+void UDimenseEntranceComponent::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	if (UEntranceStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UEntranceStreamingSubsystem>()) {
+		Streaming->UnregisterEntrance(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void UDimenseEntranceComponent::Enter(){
+	if (UEntranceStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UEntranceStreamingSubsystem>()) {
+		Streaming->EnterThrough(this);
+	}
+}
+
+bool UDimenseEntranceComponent::IsDestinationReady() const{
+	UEntranceStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UEntranceStreamingSubsystem>();
+	return Streaming && Streaming->IsLevelKeyReady(GetDestinationKey());
+}
+
+FName UDimenseEntranceComponent::GetDestinationKey() const{
+	//Comparing the path and transform allocates nothing, unlike building the key
+	if (KeyLevel != DestinationLevel || !KeyTransform.Equals(DestinationTransform, 0.0f) || (DestinationKey.IsNone() && !DestinationLevel.IsNull())) {
+		KeyLevel = DestinationLevel;
+		KeyTransform = DestinationTransform;
+		DestinationKey = UEntranceStreamingSubsystem::GetLevelKey(DestinationLevel, DestinationTransform);
+	}
+	return DestinationKey;
+}
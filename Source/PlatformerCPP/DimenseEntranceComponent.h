@@ -0,0 +1,56 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "DimenseEntranceComponent.generated.h"
+
+class UWorld;
+
+//Put on an entrance or door (BP_Entrance, BP_Door) and call Enter from its entrance event instead of opening or loading the level there.
+//UEntranceStreamingSubsystem preloads the destination while the player walks up to it.
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class PLATFORMERCPP_API UDimenseEntranceComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UDimenseEntranceComponent();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entrance", meta = (Tooltip = "Map streamed in behind this entrance (Inside, Fall, GenLevel...). None leads back out to the persistent level."))
+		TSoftObjectPtr<UWorld> DestinationLevel;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entrance", meta = (Tooltip = "Where the destination map is placed in this world. Entrances into the same map share one instance only if this matches too."))
+		FTransform DestinationTransform;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entrance", meta = (Tooltip = "Is the destination an interior? The player gets bIsInside once it is shown, and loses it going back out."))
+		bool bInterior;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entrance", meta = (ClampMin = "0", Tooltip = "Start loading the destination when the player is this close, whichever way it is moving."))
+		float PreloadRadius;
+
+	UFUNCTION(BlueprintCallable, Category = "Entrance", meta = (Tooltip = "Switches to the destination. Never blocks: a destination that isn't loaded yet shows up when it is."))
+		void Enter();
+
+	UFUNCTION(BlueprintCallable, Category = "Entrance", meta = (Tooltip = "Is the destination loaded, so Enter will show it without waiting for the disk?"))
+		bool IsDestinationReady() const;
+
+	//Key the streaming subsystem caches the destination under. Built at BeginPlay and again only when DestinationLevel or
+	//DestinationTransform have changed since, so the per frame prediction doesn't format a string and look up a name.
+	FName GetDestinationKey() const;
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Called when the owner is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	//What DestinationKey was built from
+	mutable FName DestinationKey;
+	mutable TSoftObjectPtr<UWorld> KeyLevel;
+	mutable FTransform KeyTransform;
+};
@@ -0,0 +1,367 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseInputRecorder.h"
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/GameFramework/CharacterMovementComponent.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "PlatformerCPP.h"
+#include "DimenseBenchmark.h"
+#include "DimenseCharacter.h"
+
+namespace {
+	//Pending bytes handed to the write task at once
+	constexpr int32 FlushBytes = 4096;
+}
+
+FDimenseInputRecorder::FDimenseInputRecorder(){
+	bRecording = false;
+	bPlaying = false;
+	bDriving = false;
+	bSnapToKeyframes = false;
+	LastAxis = 0;
+	KeyframeInterval = 30;
+	FrameIndex = 0;
+	ReadOffset = 0;
+	bHasNext = false;
+	LastFrameSeconds = 0.0;
+	MaxDrift = 0.0f;
+	FirstDriftFrame = INDEX_NONE;
+	bPreviousFixedTimeStep = false;
+	PreviousFixedDeltaTime = 0.0;
+}
+
+FDimenseInputRecorder::~FDimenseInputRecorder(){
+	StopRecording();
+	StopPlayback();
+	//The file has to be closed before whatever owns the recorder goes away
+	if (LastWrite.IsValid()) {
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(LastWrite);
+	}
+}
+
+bool FDimenseInputRecorder::StartRecording(const FString& Path, const ADimenseCharacter* Player, const int32 InKeyframeInterval){
+	if (bRecording || bPlaying || !Player) {
+		return false;
+	}
+	File = MakeShared<FRecordingFile, ESPMode::ThreadSafe>();
+	File->Path = Path;
+	KeyframeInterval = FMath::Clamp(InKeyframeInterval, 1, int32(MAX_uint16));
+	FrameIndex = 0;
+	LastAxis = 0;
+	Current = FFrame();
+	Pending.Reset();
+	FMemoryWriter Writer(Pending, true, true);
+	uint32 FileMagic = Magic;
+	uint16 FileVersion = Version;
+	uint16 FileKeyframeInterval = uint16(KeyframeInterval);
+	FString Map = Player->GetWorld()->GetMapName();
+	Writer << FileMagic << FileVersion << FileKeyframeInterval << Map;
+	bRecording = true;
+	UE_LOG(LogDimense, Log, TEXT("Recording input to %s"), *Path);
+	return true;
+}
+
+void FDimenseInputRecorder::StopRecording(){
+	if (!bRecording) {
+		return;
+	}
+	bRecording = false;
+	FlushPending();
+	//Closing the archive is the last write task
+	TSharedPtr<FRecordingFile, ESPMode::ThreadSafe> Target = File;
+	FGraphEventArray Prerequisites;
+	if (LastWrite.IsValid()) {
+		Prerequisites.Add(LastWrite);
+	}
+	LastWrite = FFunctionGraphTask::CreateAndDispatchWhenReady([Target]() {
+		Target->Archive.Reset();
+	}, TStatId(), &Prerequisites, ENamedThreads::AnyBackgroundThreadNormalTask);
+	File.Reset();
+	UE_LOG(LogDimense, Log, TEXT("Recorded %d frames"), FrameIndex);
+}
+
+void FDimenseInputRecorder::FlushPending(){
+	if (Pending.Num() == 0) {
+		return;
+	}
+	//Tasks are chained so the chunks land in order
+	TSharedPtr<FRecordingFile, ESPMode::ThreadSafe> Target = File;
+	TArray<uint8> Chunk = MoveTemp(Pending);
+	Pending.Reset(FlushBytes);
+	FGraphEventArray Prerequisites;
+	if (LastWrite.IsValid()) {
+		Prerequisites.Add(LastWrite);
+	}
+	LastWrite = FFunctionGraphTask::CreateAndDispatchWhenReady([Target, Chunk = MoveTemp(Chunk)]() {
+		if (!Target->Archive) {
+			Target->Archive.Reset(IFileManager::Get().CreateFileWriter(*Target->Path));
+		}
+		if (Target->Archive) {
+			Target->Archive->Serialize(const_cast<uint8*>(Chunk.GetData()), Chunk.Num());
+		}
+	}, TStatId(), &Prerequisites, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+bool FDimenseInputRecorder::OnInput(const EDimenseRecordedInput Input, const float Value){
+	if (bPlaying) {
+		return bDriving;
+	}
+	if (bRecording) {
+		if (Input == EDimenseRecordedInput::Axis) {
+			Current.Axis = int8(FMath::Clamp(FMath::RoundToInt(Value * 127.0f), -127, 127));
+		}else{
+			Current.Flags |= 1 << uint8(Input);
+		}
+	}
+	return true;
+}
+
+void FDimenseInputRecorder::TickCharacter(ADimenseCharacter* Player, const float DeltaTime){
+	if (bRecording) {
+		//Everything the player did since the last tick belongs to this one
+		Current.DeltaTime = DeltaTime;
+		if (Current.Axis != LastAxis || FrameIndex == 0) {
+			Current.Flags |= AxisChanged;
+			LastAxis = Current.Axis;
+		}
+		if (FrameIndex % KeyframeInterval == 0) {
+			Current.Flags |= HasKeyframe;
+			CaptureKeyframe(Player, Current.Keyframe);
+		}
+		WriteFrame(Current);
+		FrameIndex++;
+		//The axis is held until it changes, actions only count once
+		int8 HeldAxis = Current.Axis;
+		Current = FFrame();
+		Current.Axis = HeldAxis;
+		if (Pending.Num() >= FlushBytes) {
+			FlushPending();
+		}
+	}else if (bPlaying) {
+		//The character's profile is for the frame played last tick
+		double Now = FPlatformTime::Seconds();
+		if (Samples.Num() > 0) {
+			FPlaybackSample& Last = Samples.Last();
+			Last.FrameMs = float((Now - LastFrameSeconds) * 1000.0);
+			Last.TickMs = Player->GetTickProfile().TickMs;
+			Last.Traces = Player->GetTickProfile().Traces;
+		}
+		LastFrameSeconds = Now;
+		if (!bHasNext) {
+			FinishPlayback();
+			return;
+		}
+		FFrame Frame = Next;
+		bHasNext = ReadFrame(Next);
+		if (bHasNext) {
+			FApp::SetFixedDeltaTime(Next.DeltaTime);
+		}
+		Replay(Player, Frame);
+		FrameIndex++;
+	}
+}
+
+void FDimenseInputRecorder::WriteFrame(const FFrame& Frame){
+	FMemoryWriter Writer(Pending, true, true);
+	uint8 Flags = Frame.Flags;
+	uint16 DeltaTime = uint16(FMath::Clamp(FMath::RoundToInt(Frame.DeltaTime * 10000.0f), 0, int32(MAX_uint16))); //Tenths of a millisecond
+	Writer << Flags << DeltaTime;
+	if (Flags & AxisChanged) {
+		int8 Axis = Frame.Axis;
+		Writer << Axis;
+	}
+	if (Flags & HasKeyframe) {
+		FKeyframe Keyframe = Frame.Keyframe;
+		SerializeKeyframe(Writer, Keyframe);
+	}
+}
+
+bool FDimenseInputRecorder::ReadFrame(FFrame& Frame){
+	if (ReadOffset >= Bytes.Num()) {
+		return false;
+	}
+	FMemoryReader Reader(Bytes, true);
+	Reader.Seek(ReadOffset);
+	uint16 DeltaTime = 0;
+	Reader << Frame.Flags << DeltaTime;
+	Frame.DeltaTime = DeltaTime / 10000.0f;
+	if (Frame.Flags & AxisChanged) {
+		Reader << Frame.Axis;
+	}
+	if (Frame.Flags & HasKeyframe) {
+		SerializeKeyframe(Reader, Frame.Keyframe);
+	}
+	ReadOffset = Reader.Tell();
+	return !Reader.IsError();
+}
+
+bool FDimenseInputRecorder::StartPlayback(const FString& Path, ADimenseCharacter* Player, const bool bInSnapToKeyframes){
+	if (bRecording || bPlaying || !Player) {
+		return false;
+	}
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path)) {
+		UE_LOG(LogDimense, Error, TEXT("Could not read recording %s"), *Path);
+		return false;
+	}
+	FMemoryReader Reader(Bytes, true);
+	uint32 FileMagic = 0;
+	uint16 FileVersion = 0;
+	uint16 FileKeyframeInterval = 0;
+	FString Map;
+	Reader << FileMagic << FileVersion << FileKeyframeInterval << Map;
+	if (Reader.IsError() || FileMagic != Magic || FileVersion != Version) {
+		UE_LOG(LogDimense, Error, TEXT("%s is not a version %d Dimense recording"), *Path, Version);
+		Bytes.Empty();
+		return false;
+	}
+	if (Map != Player->GetWorld()->GetMapName()) {
+		UE_LOG(LogDimense, Warning, TEXT("%s was recorded on %s, playing it on %s"), *Path, *Map, *Player->GetWorld()->GetMapName());
+	}
+	ReadOffset = Reader.Tell();
+	LastAxis = 0;
+	Current = FFrame();
+	bHasNext = ReadFrame(Next);
+	if (!bHasNext || !(Next.Flags & HasKeyframe)) {
+		UE_LOG(LogDimense, Error, TEXT("%s has no frames"), *Path);
+		Bytes.Empty();
+		return false;
+	}
+	//Start where the recording started, then run its delta times so time dependent movement plays out the same
+	ApplyKeyframe(Player, Next.Keyframe);
+	bPreviousFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Next.DeltaTime);
+	PlaybackName = FPaths::GetBaseFilename(Path);
+	bSnapToKeyframes = bInSnapToKeyframes;
+	Samples.Reset();
+	FrameIndex = 0;
+	MaxDrift = 0.0f;
+	FirstDriftFrame = INDEX_NONE;
+	LastFrameSeconds = FPlatformTime::Seconds();
+	bPlaying = true;
+	UE_LOG(LogDimense, Log, TEXT("Playing back %s"), *Path);
+	return true;
+}
+
+void FDimenseInputRecorder::Replay(ADimenseCharacter* Player, const FFrame& Frame){
+	FPlaybackSample Sample;
+	Sample.DeltaMs = Frame.DeltaTime * 1000.0f;
+	Sample.FrameMs = 0.0f;
+	Sample.TickMs = 0.0f;
+	Sample.Traces = 0;
+	Sample.Drift = 0.0f;
+	if (Frame.Flags & HasKeyframe) {
+		Sample.Drift = FVector::Dist(Player->GetActorLocation(), GetKeyframeLocation(Frame.Keyframe));
+		MaxDrift = FMath::Max(MaxDrift, Sample.Drift);
+		if (Sample.Drift > 1.0f && FirstDriftFrame == INDEX_NONE) {
+			FirstDriftFrame = FrameIndex;
+		}
+		if (bSnapToKeyframes) {
+			ApplyKeyframe(Player, Frame.Keyframe);
+		}
+	}
+	Samples.Add(Sample);
+	if (Frame.Flags & AxisChanged) {
+		LastAxis = Frame.Axis;
+	}
+	//Same order as the input bindings ran in: actions as they were pressed, the axis every frame
+	bDriving = true;
+	if (Frame.Flags & (1 << uint8(EDimenseRecordedInput::Jump))) {
+		Player->Jump();
+	}
+	if (Frame.Flags & (1 << uint8(EDimenseRecordedInput::StopJumping))) {
+		Player->StopJumping();
+	}
+	if (Frame.Flags & (1 << uint8(EDimenseRecordedInput::JumpDown))) {
+		Player->JumpDown();
+	}
+	if (Frame.Flags & (1 << uint8(EDimenseRecordedInput::RotateLeft))) {
+		Player->RotateCamera(-90.0f);
+	}
+	if (Frame.Flags & (1 << uint8(EDimenseRecordedInput::RotateRight))) {
+		Player->RotateCamera(90.0f);
+	}
+	Player->MoveLeftRight(LastAxis / 127.0f);
+	bDriving = false;
+}
+
+void FDimenseInputRecorder::StopPlayback(){
+	if (!bPlaying) {
+		return;
+	}
+	bPlaying = false;
+	FApp::SetUseFixedTimeStep(bPreviousFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+	Bytes.Empty();
+}
+
+void FDimenseInputRecorder::FinishPlayback(){
+	StopPlayback();
+	TArray<float> FrameMs;
+	TArray<float> TickMs;
+	FString Csv = TEXT("Frame,RecordedDeltaMs,FrameMs,TickMs,Traces,Drift\n");
+	int32 WorstFrame = 0;
+	for (int32 i = 0; i < Samples.Num(); i++) {
+		const FPlaybackSample& Sample = Samples[i];
+		FrameMs.Add(Sample.FrameMs);
+		TickMs.Add(Sample.TickMs);
+		if (Sample.FrameMs > Samples[WorstFrame].FrameMs) {
+			WorstFrame = i;
+		}
+		Csv += FString::Printf(TEXT("%d,%.2f,%.4f,%.4f,%d,%.2f\n"), i, Sample.DeltaMs, Sample.FrameMs, Sample.TickMs, Sample.Traces, Sample.Drift);
+	}
+	UE_LOG(LogDimense, Log, TEXT("Playback of %s: %d frames, frame ms p50 %.3f p99 %.3f max %.3f (frame %d), character tick ms p50 %.4f p99 %.4f, max drift %.2f (first at frame %d)"),
+		*PlaybackName, Samples.Num(),
+		ADimenseBenchmark::Percentile(FrameMs, 0.5f), ADimenseBenchmark::Percentile(FrameMs, 0.99f), Samples.Num() > 0 ? Samples[WorstFrame].FrameMs : 0.0f, WorstFrame,
+		ADimenseBenchmark::Percentile(TickMs, 0.5f), ADimenseBenchmark::Percentile(TickMs, 0.99f), MaxDrift, FirstDriftFrame);
+	FString Path = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Dimense"), FString::Printf(TEXT("Replay-%s-%s.csv"), *PlaybackName, *FDateTime::Now().ToString()));
+	if (FFileHelper::SaveStringToFile(Csv, *Path)) {
+		UE_LOG(LogDimense, Log, TEXT("Playback written to %s"), *Path);
+	}else{
+		UE_LOG(LogDimense, Error, TEXT("Could not write playback to %s"), *Path);
+	}
+	Samples.Empty();
+	if (FApp::IsUnattended()) {
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void FDimenseInputRecorder::CaptureKeyframe(const ADimenseCharacter* Player, FKeyframe& Keyframe){
+	FVector Location = Player->GetActorLocation();
+	FVector Velocity = Player->GetCharacterMovement()->Velocity;
+	for (int32 Axis = 0; Axis < 3; Axis++) {
+		Keyframe.Location[Axis] = FMath::RoundToInt(Location[Axis] * 10.0f);
+		Keyframe.Velocity[Axis] = int16(FMath::Clamp(FMath::RoundToInt(Velocity[Axis]), int32(MIN_int16), int32(MAX_int16)));
+	}
+	Keyframe.ViewIndex = int8(Player->GetViewIndex());
+	Keyframe.VisibilitySide = int8(Player->VisibilitySide);
+	Keyframe.MovementDirection = int8(Player->MovementDirection);
+	Keyframe.bSpinning = Player->bSpinning ? 1 : 0;
+}
+
+void FDimenseInputRecorder::ApplyKeyframe(ADimenseCharacter* Player, const FKeyframe& Keyframe){
+	Player->SetActorLocation(GetKeyframeLocation(Keyframe), false, nullptr, ETeleportType::TeleportPhysics);
+	Player->GetCharacterMovement()->Velocity = FVector(Keyframe.Velocity[0], Keyframe.Velocity[1], Keyframe.Velocity[2]);
+	Player->SetViewIndex(Keyframe.ViewIndex); //A spin in progress is left to finish, it ends on the recorded view anyway
+	Player->bSnapRenderLocation = true;
+}
+
+FVector FDimenseInputRecorder::GetKeyframeLocation(const FKeyframe& Keyframe){
+	return FVector(Keyframe.Location[0], Keyframe.Location[1], Keyframe.Location[2]) / 10.0f;
+}
+
+void FDimenseInputRecorder::SerializeKeyframe(FArchive& Ar, FKeyframe& Keyframe){
+	for (int32 Axis = 0; Axis < 3; Axis++) {
+		Ar << Keyframe.Location[Axis];
+	}
+	for (int32 Axis = 0; Axis < 3; Axis++) {
+		Ar << Keyframe.Velocity[Axis];
+	}
+	Ar << Keyframe.ViewIndex << Keyframe.VisibilitySide << Keyframe.MovementDirection << Keyframe.bSpinning;
+}
@@ -0,0 +1,124 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+
+class ADimenseCharacter;
+
+//The character inputs a recording holds
+enum class EDimenseRecordedInput : uint8 {
+	Axis, //MoveLeftRight
+	Jump,
+	StopJumping,
+	JumpDown,
+	RotateLeft,
+	RotateRight,
+};
+
+/**
+ * Records what the player did so a reported run can be replayed as a repeatable performance test.
+ * Every character tick is one frame of a few bytes: the actions since the last tick, the frame's delta time and the
+ * MoveLeftRight axis when it changed. Every KeyframeInterval ticks a quantized movement state (location, velocity, view,
+ * visibility, direction) is added so playback can tell where it drifted from the recorded run.
+ * The file is appended to from a background task, the game thread only fills a small buffer.
+ * Playback runs the recorded delta times on a fixed time step, feeds the inputs back through the character and writes one CSV
+ * row per frame to Saved/Profiling/Dimense. Headless: -game -nullrhi -unattended -ExecCmds="DimenseReplay <Name>"
+ */
+class PLATFORMERCPP_API FDimenseInputRecorder
+{
+public:
+	FDimenseInputRecorder();
+	~FDimenseInputRecorder();
+
+	bool StartRecording(const FString& Path, const ADimenseCharacter* Player, const int32 KeyframeInterval);
+	void StopRecording();
+	bool StartPlayback(const FString& Path, ADimenseCharacter* Player, const bool bSnapToKeyframes);
+	void StopPlayback();
+	bool IsRecording() const { return bRecording; }
+	bool IsPlaying() const { return bPlaying; }
+
+	//Called by the character's input functions. False while playing back, the recording is the only input then.
+	bool OnInput(const EDimenseRecordedInput Input, const float Value = 0.0f);
+
+	//Called at the start of the character's tick: ends the frame while recording, feeds the next one while playing back
+	void TickCharacter(ADimenseCharacter* Player, const float DeltaTime);
+
+	static constexpr uint32 Magic = 0x43524D44; //"DMRC"
+	static constexpr uint16 Version = 1;
+
+private:
+	enum EFrameFlag : uint8 {
+		AxisChanged = 1 << 6,
+		HasKeyframe = 1 << 7,
+	};
+
+	//Quantized movement state, Location in tenths of a unit and Velocity in units per second
+	struct FKeyframe {
+		int32 Location[3];
+		int16 Velocity[3];
+		int8 ViewIndex; //RotationSpringArm yaw / 90
+		int8 VisibilitySide;
+		int8 MovementDirection;
+		uint8 bSpinning;
+	};
+
+	struct FFrame {
+		uint8 Flags = 0; //1 << EDimenseRecordedInput for each action, plus EFrameFlag
+		float DeltaTime = 0.0f;
+		int8 Axis = 0;
+		FKeyframe Keyframe;
+	};
+
+	//Owned by the write tasks, closed by the last one
+	struct FRecordingFile {
+		FString Path;
+		TUniquePtr<FArchive> Archive;
+	};
+
+	struct FPlaybackSample {
+		float DeltaMs;
+		float FrameMs;
+		float TickMs;
+		int32 Traces;
+		float Drift;
+	};
+
+	bool bRecording;
+	bool bPlaying;
+	bool bDriving;
+	bool bSnapToKeyframes;
+
+	//Recording
+	TSharedPtr<FRecordingFile, ESPMode::ThreadSafe> File;
+	FGraphEventRef LastWrite;
+	TArray<uint8> Pending;
+	FFrame Current;
+	int8 LastAxis;
+	int32 KeyframeInterval;
+	int32 FrameIndex;
+
+	//Playback
+	TArray<uint8> Bytes;
+	int64 ReadOffset;
+	FFrame Next;
+	bool bHasNext;
+	FString PlaybackName;
+	TArray<FPlaybackSample> Samples;
+	double LastFrameSeconds;
+	float MaxDrift;
+	int32 FirstDriftFrame;
+	bool bPreviousFixedTimeStep;
+	double PreviousFixedDeltaTime;
+
+	void FlushPending();
+	void WriteFrame(const FFrame& Frame);
+	bool ReadFrame(FFrame& Frame);
+	void Replay(ADimenseCharacter* Player, const FFrame& Frame);
+	void FinishPlayback();
+	static void CaptureKeyframe(const ADimenseCharacter* Player, FKeyframe& Keyframe);
+	static void ApplyKeyframe(ADimenseCharacter* Player, const FKeyframe& Keyframe);
+	static FVector GetKeyframeLocation(const FKeyframe& Keyframe);
+	static void SerializeKeyframe(FArchive& Ar, FKeyframe& Keyframe);
+};
@@ -0,0 +1,140 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "PlatformerCPP.h"
+#include "DimenseCharacter.h"
+
+UDimenseMovementComponent::UDimenseMovementComponent(){
+	PendingTeleportOffset = FVector::ZeroVector;
+	bPendingTeleport = false;
+	ReplayTeleportOffset = FVector::ZeroVector;
+	bReplayTeleport = false;
+	SmoothedTeleportCount = 0;
+	NumCorrections = 0;
+	NumTeleportsApplied = 0;
+	NumTeleportsReplayed = 0;
+}
+
+FNetworkPredictionData_Client* UDimenseMovementComponent::GetPredictionData_Client() const{
+	if (!ClientPredictionData) {
+		UDimenseMovementComponent* MutableThis = const_cast<UDimenseMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Dimense(*this);
+	}
+	return ClientPredictionData;
+}
+
+float UDimenseMovementComponent::GetClientTimeStamp() const{
+	if (!ClientPredictionData) {
+		return 0.0f;
+	}
+	return ClientPredictionData->CurrentTimeStamp;
+}
+
+void UDimenseMovementComponent::PredictTeleport(const FVector& Offset){
+	PendingTeleportOffset += Offset;
+	bPendingTeleport = true;
+	NumTeleportsApplied++; //The character already moved itself, this is the first application
+	INC_DWORD_STAT(STAT_DimenseNetTeleports);
+	CSV_CUSTOM_STAT(Dimense, NetTeleports, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void UDimenseMovementComponent::QueueTeleport(const float ClientTimeStamp, const FVector& Offset){
+	QueuedTeleports.Add({ ClientTimeStamp, Offset, false });
+}
+
+void UDimenseMovementComponent::QueueTeleportTo(const float ClientTimeStamp, const FVector& Location){
+	QueuedTeleports.Add({ ClientTimeStamp, Location, true });
+}
+
+void UDimenseMovementComponent::ApplyTeleport(const FVector& Offset){
+	UpdatedComponent->AddWorldOffset(Offset, false, nullptr, ETeleportType::TeleportPhysics);
+	//Replays after a correction were counted when first predicted
+	if (CharacterOwner && CharacterOwner->bClientUpdating) {
+		NumTeleportsReplayed++;
+	}else{
+		NumTeleportsApplied++;
+		INC_DWORD_STAT(STAT_DimenseNetTeleports);
+		CSV_CUSTOM_STAT(Dimense, NetTeleports, 1, ECsvCustomStatOp::Accumulate);
+	}
+	ADimenseCharacter* Dimense = Cast<ADimenseCharacter>(CharacterOwner);
+	if (Dimense && Dimense->HasAuthority()) {
+		Dimense->TeleportCount++;
+	}
+}
+
+void UDimenseMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel){
+	if (CharacterOwner && CharacterOwner->bClientUpdating) {
+		//Replaying after a correction: the teleport goes between the same two moves as it did the first time
+		if (bReplayTeleport) {
+			ApplyTeleport(ReplayTeleportOffset);
+			bReplayTeleport = false;
+		}
+	}else if (CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_Authority) {
+		//Every checked request the client made before this move. Client timestamps restart now and then, a big step back is a restart.
+		int32 Due = 0;
+		while (Due < QueuedTeleports.Num() && (QueuedTeleports[Due].ClientTimeStamp < ClientTimeStamp || QueuedTeleports[Due].ClientTimeStamp - ClientTimeStamp > MinTimeBetweenTimeStampResets / 2)) {
+			const FQueuedTeleport& Teleport = QueuedTeleports[Due];
+			ApplyTeleport(Teleport.bAbsolute ? Teleport.Offset - UpdatedComponent->GetComponentLocation() : Teleport.Offset);
+			Due++;
+		}
+		QueuedTeleports.RemoveAt(0, Due, false);
+	}
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+void UDimenseMovementComponent::SmoothCorrection(const FVector& OldLocation, const FQuat& OldRotation, const FVector& NewLocation, const FQuat& NewRotation){
+	//A teleport since the last update is shown as one, smoothing would slide the mesh through the level along the camera axis
+	ADimenseCharacter* Dimense = Cast<ADimenseCharacter>(CharacterOwner);
+	if (Dimense && Dimense->TeleportCount != SmoothedTeleportCount) {
+		SmoothedTeleportCount = Dimense->TeleportCount;
+		Super::SmoothCorrection(NewLocation, NewRotation, NewLocation, NewRotation);
+		return;
+	}
+	Super::SmoothCorrection(OldLocation, OldRotation, NewLocation, NewRotation);
+}
+
+void UDimenseMovementComponent::ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode){
+	NumCorrections++;
+	INC_DWORD_STAT(STAT_DimenseNetCorrections);
+	CSV_CUSTOM_STAT(Dimense, NetCorrections, 1, ECsvCustomStatOp::Accumulate);
+	Super::ClientAdjustPosition_Implementation(TimeStamp, NewLoc, NewVel, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
+}
+
+void FSavedMove_Dimense::Clear(){
+	Super::Clear();
+	TeleportOffset = FVector::ZeroVector;
+	bTeleport = false;
+}
+
+void FSavedMove_Dimense::SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData){
+	Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+	UDimenseMovementComponent* Movement = Cast<UDimenseMovementComponent>(Character->GetCharacterMovement());
+	if (Movement && Movement->bPendingTeleport) {
+		TeleportOffset = Movement->PendingTeleportOffset;
+		bTeleport = true;
+		Movement->PendingTeleportOffset = FVector::ZeroVector;
+		Movement->bPendingTeleport = false;
+	}
+}
+
+void FSavedMove_Dimense::PrepMoveFor(ACharacter* Character){
+	Super::PrepMoveFor(Character);
+	UDimenseMovementComponent* Movement = Cast<UDimenseMovementComponent>(Character->GetCharacterMovement());
+	if (Movement && bTeleport) {
+		Movement->ReplayTeleportOffset = TeleportOffset;
+		Movement->bReplayTeleport = true;
+	}
+}
+
+bool FSavedMove_Dimense::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const{
+	//A combined move would replay the teleport at the wrong time
+	if (bTeleport || static_cast<const FSavedMove_Dimense*>(NewMove.Get())->bTeleport) {
+		return false;
+	}
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Dimense::AllocateNewMove(){
+	return FSavedMovePtr(new FSavedMove_Dimense());
+}
@@ -0,0 +1,105 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "DimenseMovementComponent.generated.h"
+
+//The ways the movement system moves the player without walking there
+UENUM()
+enum class EDimenseTeleport : uint8 {
+	Transport,
+	MoveAround,
+	JumpDown,
+	Respawn,
+};
+
+/**
+ * Character movement that knows about the movement system's teleports, so Transport and MoveAround can be played over a network.
+ * The owning client moves the capsule as soon as it decides to (prediction) and tells the server which move it happened after.
+ * The server checks the request (ADimenseCharacter::ServerRequestTeleport) and applies the same offset right before the next
+ * move the client sends, so both ends simulate that move from the same place and no correction is needed. A rejected or late
+ * request is corrected by the usual client adjustment. Replayed moves apply the offset again on the client.
+ * Respawns send no offset: the server moves the character to its own checkpoint (ADimenseCharacter::ServerRespawn).
+ * Other clients see the teleport as a snap instead of the mesh smoothing through the level in between.
+ * Local test: the server with <Map>?listen -game -log, clients with 127.0.0.1 -game -log on the same box, "net pktlag=60" to add
+ * latency, and DimenseNetStats on either end for bytes per second and correction counts.
+ */
+UCLASS()
+class PLATFORMERCPP_API UDimenseMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDimenseMovementComponent();
+
+	//Owning client: a teleport was applied after the last move sent, replay it with the next saved move
+	void PredictTeleport(const FVector& Offset);
+
+	//Server: a checked teleport request, applied before the first move after ClientTimeStamp
+	void QueueTeleport(const float ClientTimeStamp, const FVector& Offset);
+
+	//Server: same, but to a location the server chose (respawns), the offset is worked out when it is applied
+	void QueueTeleportTo(const float ClientTimeStamp, const FVector& Location);
+
+	//Timestamp of the last move this client sent (0 when not an owning client)
+	float GetClientTimeStamp() const;
+
+	int32 GetNumCorrections() const { return NumCorrections; }
+	int32 GetNumTeleportsApplied() const { return NumTeleportsApplied; } //First applications only
+	int32 GetNumTeleportsReplayed() const { return NumTeleportsReplayed; } //Owning client: applied again replaying after a correction
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void SmoothCorrection(const FVector& OldLocation, const FQuat& OldRotation, const FVector& NewLocation, const FQuat& NewRotation) override;
+	virtual void ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
+
+protected:
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+private:
+	friend class FSavedMove_Dimense;
+
+	struct FQueuedTeleport {
+		float ClientTimeStamp; //Client's last move before the teleport
+		FVector Offset; //The target location when bAbsolute
+		bool bAbsolute;
+	};
+
+	FVector PendingTeleportOffset; //Client: applied, not yet in a saved move
+	bool bPendingTeleport;
+	FVector ReplayTeleportOffset; //Client: set by the saved move being replayed
+	bool bReplayTeleport;
+	TArray<FQueuedTeleport> QueuedTeleports; //Server
+	uint8 SmoothedTeleportCount; //Simulated proxies: ADimenseCharacter::TeleportCount last smoothed
+	int32 NumCorrections;
+	int32 NumTeleportsApplied;
+	int32 NumTeleportsReplayed;
+
+	void ApplyTeleport(const FVector& Offset);
+};
+
+//A saved move that remembers the teleport applied before it, for replays after a correction
+class FSavedMove_Dimense : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* Character) override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+
+	FVector TeleportOffset;
+	bool bTeleport;
+};
+
+class FNetworkPredictionData_Client_Dimense : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Dimense(const UCharacterMovementComponent& ClientMovement) : Super(ClientMovement) {}
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -0,0 +1,96 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseMovementQueries.h"
+#include "Engine/World.h"
+
+FDimenseMovementQueries::FDimenseMovementQueries(){
+	Invalidate();
+}
+
+void FDimenseMovementQueries::AddLineTrace(const EDimenseProbe Probe, const FVector& Start, const FVector& End, const ECollisionChannel ObjectType, const int32 Context){
+	FProbe& Entry = Probes[static_cast<int32>(Probe)];
+	Entry.Start = Start;
+	Entry.End = End;
+	Entry.ObjectType = ObjectType;
+	Entry.Context = Context;
+	Entry.bSweep = false;
+	Entry.bQueued = true;
+}
+
+void FDimenseMovementQueries::AddSweep(const EDimenseProbe Probe, const FVector& Start, const FVector& End, const FQuat& Rotation, const ECollisionChannel ObjectType, const FCollisionShape& Shape, const int32 Context){
+	FProbe& Entry = Probes[static_cast<int32>(Probe)];
+	Entry.Start = Start;
+	Entry.End = End;
+	Entry.Rotation = Rotation;
+	Entry.Shape = Shape;
+	Entry.ObjectType = ObjectType;
+	Entry.Context = Context;
+	Entry.bSweep = true;
+	Entry.bQueued = true;
+}
+
+int32 FDimenseMovementQueries::Submit(UWorld* World, const FCollisionQueryParams& Params){
+	int32 Submitted = 0;
+	for (int32 i = 0; i < NumProbes; i++) {
+		FProbe& Entry = Probes[i];
+		if (!Entry.bQueued) {
+			Entry.Handle = FTraceHandle();
+			continue;
+		}
+		if (Entry.bSweep) {
+			Entry.Handle = World->AsyncSweepByObjectType(EAsyncTraceType::Single, Entry.Start, Entry.End, Entry.Rotation, FCollisionObjectQueryParams(Entry.ObjectType), Entry.Shape, Params);
+		}else{
+			Entry.Handle = World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, Entry.Start, Entry.End, FCollisionObjectQueryParams(Entry.ObjectType), Params);
+		}
+		Entry.bQueued = false;
+		Submitted++;
+	}
+	return Submitted;
+}
+
+void FDimenseMovementQueries::Gather(UWorld* World){
+	FTraceDatum Datum;
+	for (int32 i = 0; i < NumProbes; i++) {
+		FProbe& Entry = Probes[i];
+		bHasResult[i] = false;
+		if (!Entry.Handle.IsValid()) {
+			continue;
+		}
+		//Results only stay available for one frame after the trace ran, anything missing falls back to a synchronous trace
+		if (World->QueryTraceData(Entry.Handle, Datum)) {
+			Results[i] = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+			ResultContexts[i] = Entry.Context;
+			ResultStarts[i] = Entry.Start;
+			bHasResult[i] = true;
+		}
+		Entry.Handle = FTraceHandle();
+	}
+}
+
+bool FDimenseMovementQueries::GetResult(const EDimenseProbe Probe, const FVector& Start, const float Tolerance, FHitResult& HitResult, const int32 Context) const{
+	const int32 Index = static_cast<int32>(Probe);
+	if (Probe == EDimenseProbe::None || !bHasResult[Index] || ResultContexts[Index] != Context) {
+		return false;
+	}
+	//Traced from too far away (the player was moved since), a hit near a platform edge may not hold any more
+	if (!ResultStarts[Index].Equals(Start, Tolerance)) {
+		return false;
+	}
+	HitResult = Results[Index];
+	return true;
+}
+
+void FDimenseMovementQueries::Invalidate(){
+	for (int32 i = 0; i < NumProbes; i++) {
+		Probes[i].bQueued = false;
+		Probes[i].Handle = FTraceHandle();
+		bHasResult[i] = false;
+	}
+}
+
+EDimenseProbe FDimenseMovementQueries::OffsetProbe(const EDimenseProbe First, const int32 Index){
+	if (First == EDimenseProbe::None) {
+		return EDimenseProbe::None;
+	}
+	return static_cast<EDimenseProbe>(static_cast<int32>(First) + Index);
+}
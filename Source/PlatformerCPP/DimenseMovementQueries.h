@@ -0,0 +1,101 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "DimenseMovementQueries.generated.h"
+
+class UWorld;
+
+//Every scene query the movement system can make in one tick. Each probe owns one result slot in the batch.
+UENUM(BlueprintType)
+enum class EDimenseProbe : uint8 {
+	None,
+	Ground,
+	Head,
+	Horizontal0,
+	Horizontal1,
+	Horizontal2,
+	Horizontal3,
+	Horizontal4,
+	Horizontal5,
+	VisibilityFront0,
+	VisibilityFront1,
+	VisibilityFront2,
+	VisibilityFront3,
+	VisibilityBack0,
+	VisibilityBack1,
+	VisibilityBack2,
+	VisibilityBack3,
+	Transport,
+	MoveAroundHead,
+	MoveAroundSide,
+	Count UMETA(Hidden)
+};
+
+/**
+ * Batch of movement probes submitted to the async trace API in one go.
+ * Probes queued during tick N are traced at the end of frame N, and their results are gathered at the start of tick N+1.
+ */
+class PLATFORMERCPP_API FDimenseMovementQueries
+{
+public:
+	FDimenseMovementQueries();
+
+	//Queue a probe for the next submit. Probes hit objects of ObjectType only (ECC_Platform for movement). Context is any value the probe geometry depends on besides position (movement direction, visibility side), results are only handed back for a matching context
+	void AddLineTrace(const EDimenseProbe Probe, const FVector& Start, const FVector& End, const ECollisionChannel ObjectType, const int32 Context = 0);
+	void AddSweep(const EDimenseProbe Probe, const FVector& Start, const FVector& End, const FQuat& Rotation, const ECollisionChannel ObjectType, const FCollisionShape& Shape, const int32 Context = 0);
+
+	//Send every queued probe to the async trace API, returns the number of probes submitted
+	int32 Submit(UWorld* World, const FCollisionQueryParams& Params);
+
+	//Pick up the results of the probes submitted last frame
+	void Gather(UWorld* World);
+
+	//Returns true if a completed result exists for the probe and it started within Tolerance of Start (HitResult.bBlockingHit tells if it hit anything)
+	bool GetResult(const EDimenseProbe Probe, const FVector& Start, const float Tolerance, FHitResult& HitResult, const int32 Context = 0) const;
+
+	//Drop all pending and completed probes (camera rotated, movement paused, etc.)
+	void Invalidate();
+
+	//Returns the probe Index slots after First (VisibilityFront0 + 2 = VisibilityFront2), None stays None
+	static EDimenseProbe OffsetProbe(const EDimenseProbe First, const int32 Index);
+
+private:
+	struct FProbe {
+		FVector Start;
+		FVector End;
+		FQuat Rotation;
+		FCollisionShape Shape;
+		ECollisionChannel ObjectType;
+		FTraceHandle Handle;
+		int32 Context;
+		bool bSweep;
+		bool bQueued;
+	};
+
+	static constexpr int32 NumProbes = static_cast<int32>(EDimenseProbe::Count);
+
+	FProbe Probes[NumProbes];
+	FHitResult Results[NumProbes];
+	FVector ResultStarts[NumProbes];
+	int32 ResultContexts[NumProbes];
+	bool bHasResult[NumProbes];
+};
+
+//What the movement system spent in the last tick, read by ADimenseBenchmark (times in ms)
+struct FDimenseTickProfile
+{
+	float TickMs = 0.0f;
+	float ChecksMs = 0.0f; //DoLineTracesAndPlatformChecks
+	float TransportMs = 0.0f; //TryTransport
+	float MoveAroundMs = 0.0f; //TryMoveAround
+	int32 TransportCalls = 0;
+	int32 MoveAroundCalls = 0;
+	int32 Traces = 0; //Scene queries, synchronous and async
+	int32 IndexQueries = 0; //Projection index and occlusion buffer lookups
+
+	void Reset() { *this = FDimenseTickProfile(); }
+};
@@ -0,0 +1,23 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseMovementRules.h"
+
+void FDimenseMovementRules::GetViewVectors(const int32 ViewIndex, FVector& OutForward, FVector& OutRight, int32& OutCamSign, int32& OutCamSide){
+	DimenseCore::FViewBasis Basis = DimenseCore::GetViewBasis(ViewIndex);
+	OutForward = FromCore(Basis.Forward);
+	OutRight = FromCore(Basis.Right);
+	OutCamSign = Basis.CamSign;
+	OutCamSide = Basis.CamSide;
+}
+
+int32 FDimenseMovementRules::GetViewIndex(const FVector& CamForward){
+	return DimenseCore::GetViewIndex(ToCore(CamForward));
+}
+
+FVector FDimenseMovementRules::GetTransportOffset(const FVector& HitLocation, const float TopZ, const FVector& Location, const FVector& CamForward, const FVector& Padding, const int32 CamSide, const int32 CamSign, const int32 VisibilitySide){
+	return FromCore(DimenseCore::GetTransportOffset(ToCore(HitLocation), TopZ, ToCore(Location), ToCore(CamForward), ToCore(Padding), CamSide, CamSign, VisibilitySide));
+}
+
+FVector FDimenseMovementRules::GetMoveAroundOffset(const FVector& HitLocation, const FVector& Location, const FVector& CamForward, const FVector& Padding, const int32 CamSide, const int32 CamSign, const int32 VisibilitySide){
+	return FromCore(DimenseCore::GetMoveAroundOffset(ToCore(HitLocation), ToCore(Location), ToCore(CamForward), ToCore(Padding), CamSide, CamSign, VisibilitySide));
+}
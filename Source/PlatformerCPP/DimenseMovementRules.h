@@ -0,0 +1,28 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DimenseCore.h"
+
+/**
+ * The parts of the movement system that are plain math on the camera vectors, shared by ADimenseCharacter and the ghost runners
+ * (AGhostRunnerField) so both move between depths by the same rules. The math itself lives in DimenseCore.h, this is the FVector face of it.
+ */
+struct PLATFORMERCPP_API FDimenseMovementRules
+{
+	//Camera vectors for a view (RotationSpringArm yaw / 90), as UpdateMovementSystemVariables rounds them
+	static void GetViewVectors(const int32 ViewIndex, FVector& OutForward, FVector& OutRight, int32& OutCamSign, int32& OutCamSide);
+
+	//View index for a rounded camera forward vector
+	static int32 GetViewIndex(const FVector& CamForward);
+
+	//Offset along the camera axis that puts Location over the platform hit at HitLocation, Padding past its near edge
+	static FVector GetTransportOffset(const FVector& HitLocation, const float TopZ, const FVector& Location, const FVector& CamForward, const FVector& Padding, const int32 CamSide, const int32 CamSign, const int32 VisibilitySide);
+
+	//Offset along the camera axis that puts Location in front of the platform hit at HitLocation, Padding short of it
+	static FVector GetMoveAroundOffset(const FVector& HitLocation, const FVector& Location, const FVector& CamForward, const FVector& Padding, const int32 CamSide, const int32 CamSign, const int32 VisibilitySide);
+
+	static DimenseCore::FVec3 ToCore(const FVector& Vector) { return DimenseCore::FVec3(Vector.X, Vector.Y, Vector.Z); }
+	static FVector FromCore(const DimenseCore::FVec3& Vector) { return FVector(Vector.X, Vector.Y, Vector.Z); }
+};
@@ -0,0 +1,39 @@
+// Copyright 2020 Ryan Gourley
+
+#include "DimenseMovementState.h"
+
+FDimenseMovementHistory::FDimenseMovementHistory(){
+	Head = 0;
+	Count = 0;
+}
+
+void FDimenseMovementHistory::Reset(const int32 Capacity){
+	States.SetNumUninitialized(FMath::Max(Capacity, 1));
+	Head = 0;
+	Count = 0;
+}
+
+void FDimenseMovementHistory::Push(const FDimenseMovementState& State){
+	if (States.Num() == 0) {
+		return;
+	}
+	States[Head] = State;
+	Head = (Head + 1) % States.Num();
+	Count = FMath::Min(Count + 1, States.Num());
+}
+
+bool FDimenseMovementHistory::Pop(){
+	if (Count == 0) {
+		return false;
+	}
+	Head = (Head + States.Num() - 1) % States.Num();
+	Count--;
+	return true;
+}
+
+const FDimenseMovementState* FDimenseMovementHistory::Newest() const{
+	if (Count == 0) {
+		return nullptr;
+	}
+	return &States[(Head + States.Num() - 1) % States.Num()];
+}
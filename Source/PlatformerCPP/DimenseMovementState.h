@@ -0,0 +1,81 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class APlatformMaster;
+
+/**
+ * Everything the movement system carries from one tick to the next, in one flat struct that copies with a memcpy.
+ * The FHitResults on the character are not part of it, every tick writes them before reading them.
+ */
+struct FDimenseMovementState
+{
+	enum EFlag : uint8 {
+		CanTransport = 1 << 0,
+		CanMoveAround = 1 << 1,
+		JumpPressed = 1 << 2,
+		MoveDownPressed = 1 << 3,
+		PressedJump = 1 << 4, //ACharacter::bPressedJump
+	};
+
+	enum EPlatformSlot : uint8 {
+		Ground,
+		CachedGround,
+		Transport,
+		CachedTransport,
+		TryTransport,
+		CachedTryTransport,
+		MoveAround,
+		CachedMoveAround,
+		NumPlatformSlots,
+	};
+
+	float Time; //World seconds when captured
+	FVector Location;
+	FVector Velocity;
+	FVector GroundLocation;
+	TWeakObjectPtr<APlatformMaster> Platforms[NumPlatformSlots];
+	float JumpKeyHoldTime;
+	int8 JumpCurrentCount;
+	uint8 MovementMode; //EMovementMode
+	int8 ViewIndex; //RotationSpringArm yaw / 90
+	int8 CamSide;
+	int8 CamSign;
+	int8 VisibilitySide;
+	int8 MovementDirection;
+	int8 FacingDirection;
+	uint8 Flags;
+};
+
+template<> struct TIsPODType<FDimenseMovementState> { enum { Value = true }; };
+
+/**
+ * Fixed size ring buffer of movement states, newest last. Pushing into a full buffer drops the oldest state.
+ */
+class PLATFORMERCPP_API FDimenseMovementHistory
+{
+public:
+	FDimenseMovementHistory();
+
+	//Drops every state and makes room for Capacity of them
+	void Reset(const int32 Capacity);
+
+	void Push(const FDimenseMovementState& State);
+
+	//Removes the newest state, false if there is none
+	bool Pop();
+
+	//Newest state, nullptr if empty
+	const FDimenseMovementState* Newest() const;
+
+	int32 Num() const { return Count; }
+	int32 GetCapacity() const { return States.Num(); }
+
+private:
+	TArray<FDimenseMovementState> States;
+	int32 Head; //Slot the next push goes to
+	int32 Count;
+};
@@ -1,8 +1,90 @@
 // Copyright 2020 Ryan Gourley
 
 #include "DimensePlayerController.h"
+#include "Misc/Paths.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "TimerManager.h"
+#include "PlatformerCPP.h"
+#include "DimenseCharacter.h"
+#include "DimenseMovementComponent.h"
 
 // Sets default values
 ADimensePlayerController::ADimensePlayerController() {
 	SetViewTarget(GetOwner());
-}
\ No newline at end of file
+	KeyframeInterval = 30; //Twice a second at 60 fps
+}
+
+// Called when the controller is destroyed or its level is unloaded
+void ADimensePlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	InputRecorder.StopRecording();
+	InputRecorder.StopPlayback();
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ADimensePlayerController::StartRecording(const FString& Name){
+	FString RecordingName = Name.IsEmpty() ? FDateTime::Now().ToString() : Name;
+	return InputRecorder.StartRecording(GetRecordingPath(RecordingName), Cast<ADimenseCharacter>(GetPawn()), KeyframeInterval);
+}
+
+void ADimensePlayerController::StopRecording(){
+	InputRecorder.StopRecording();
+}
+
+bool ADimensePlayerController::StartPlayback(const FString& Name, const bool bSnapToKeyframes){
+	return InputRecorder.StartPlayback(GetRecordingPath(Name), Cast<ADimenseCharacter>(GetPawn()), bSnapToKeyframes);
+}
+
+void ADimensePlayerController::StopPlayback(){
+	InputRecorder.StopPlayback();
+}
+
+bool ADimensePlayerController::IsRecording() const{
+	return InputRecorder.IsRecording();
+}
+
+bool ADimensePlayerController::IsPlayingBack() const{
+	return InputRecorder.IsPlaying();
+}
+
+FString ADimensePlayerController::GetRecordingPath(const FString& Name){
+	if (FPaths::FileExists(Name)) {
+		return Name;
+	}
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Recordings"), Name + TEXT(".dimrec"));
+}
+
+void ADimensePlayerController::DimenseNetStats(){
+	FTimerManager& TimerManager = GetWorldTimerManager();
+	if (TimerManager.IsTimerActive(NetStatsTimer)) {
+		TimerManager.ClearTimer(NetStatsTimer);
+		return;
+	}
+	TimerManager.SetTimer(NetStatsTimer, this, &ADimensePlayerController::LogNetStats, 1.0f, true);
+}
+
+void ADimensePlayerController::LogNetStats(){
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (!NetDriver) {
+		UE_LOG(LogDimense, Log, TEXT("Net stats: not networked"));
+		return;
+	}
+	//Client: its one connection, and the corrections the server sent its character
+	if (UNetConnection* Connection = NetDriver->ServerConnection) {
+		ADimenseCharacter* Player = Cast<ADimenseCharacter>(GetPawn());
+		UDimenseMovementComponent* Movement = Player ? Cast<UDimenseMovementComponent>(Player->GetCharacterMovement()) : nullptr;
+		UE_LOG(LogDimense, Log, TEXT("Net client: in %d B/s, out %d B/s (rate %d B/s), corrections %d, teleports %d, replayed %d"),
+			Connection->InBytesPerSecond, Connection->OutBytesPerSecond, Connection->CurrentNetSpeed, Movement ? Movement->GetNumCorrections() : 0,
+			Movement ? Movement->GetNumTeleportsApplied() : 0, Movement ? Movement->GetNumTeleportsReplayed() : 0);
+		CSV_CUSTOM_STAT(Dimense, NetInBytesPerSecond, Connection->InBytesPerSecond, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(Dimense, NetOutBytesPerSecond, Connection->OutBytesPerSecond, ECsvCustomStatOp::Set);
+	}
+	//Server: every client connection, and what became of its character's teleport requests
+	for (UNetConnection* Connection : NetDriver->ClientConnections) {
+		ADimenseCharacter* Character = Connection->PlayerController ? Cast<ADimenseCharacter>(Connection->PlayerController->GetPawn()) : nullptr;
+		UDimenseMovementComponent* Movement = Character ? Cast<UDimenseMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+		UE_LOG(LogDimense, Log, TEXT("Net server %s: in %d B/s, out %d B/s (rate %d B/s), teleports applied %d, rejected %d"),
+			*Connection->LowLevelGetRemoteAddress(), Connection->InBytesPerSecond, Connection->OutBytesPerSecond, Connection->CurrentNetSpeed,
+			Movement ? Movement->GetNumTeleportsApplied() : 0, Character ? Character->NumTeleportsRejected : 0);
+	}
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "DimenseInputRecorder.h"
 #include "DimensePlayerController.generated.h"
 
 /**
@@ -17,4 +18,42 @@ class PLATFORMERCPP_API ADimensePlayerController : public APlayerController
 public:
 	// Sets default values for this actor's properties
 	ADimensePlayerController();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Recording", meta = (ClampMin = "1", Tooltip = "Ticks between the movement state keyframes of a recording."))
+		int32 KeyframeInterval;
+
+	UFUNCTION(BlueprintCallable, Category = "Recording", meta = (Tooltip = "Record the possessed character's input to Saved/Recordings/<Name>.dimrec (a timestamp if Name is empty)."))
+		bool StartRecording(const FString& Name);
+
+	UFUNCTION(BlueprintCallable, Category = "Recording")
+		void StopRecording();
+
+	UFUNCTION(BlueprintCallable, Category = "Recording", meta = (Tooltip = "Play a recording (a name in Saved/Recordings or a path) back on the possessed character. Frame times go to Saved/Profiling/Dimense. Snapping puts the character back on every keyframe so a long run can't drift."))
+		bool StartPlayback(const FString& Name, const bool bSnapToKeyframes);
+
+	UFUNCTION(BlueprintCallable, Category = "Recording")
+		void StopPlayback();
+
+	UFUNCTION(BlueprintCallable, Category = "Recording")
+		bool IsRecording() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Recording")
+		bool IsPlayingBack() const;
+
+	FDimenseInputRecorder& GetInputRecorder() { return InputRecorder; }
+
+	UFUNCTION(Exec, Category = "Network", meta = (Tooltip = "Toggles logging bytes per second and movement corrections once a second, on the server and on clients."))
+		void DimenseNetStats();
+
+protected:
+	// Called when the controller is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	FDimenseInputRecorder InputRecorder;
+	FTimerHandle NetStatsTimer;
+
+	void LogNetStats();
+
+	static FString GetRecordingPath(const FString& Name);
 };
@@ -0,0 +1,223 @@
+// Copyright 2020 Ryan Gourley
+
+#include "EntranceStreamingSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "PlatformerCPP.h"
+#include "DimenseEntranceComponent.h"
+#include "DimenseCharacter.h"
+
+UEntranceStreamingSubsystem::UEntranceStreamingSubsystem(){
+	MaxCachedLevels = 3;
+	PreloadLeadSeconds = 1.5f;
+	CurrentLevel = NAME_None;
+	bTransitionPending = false;
+}
+
+void UEntranceStreamingSubsystem::RegisterEntrance(UDimenseEntranceComponent* Entrance){
+	if (Entrance) {
+		Entrances.AddUnique(Entrance);
+	}
+}
+
+void UEntranceStreamingSubsystem::UnregisterEntrance(UDimenseEntranceComponent* Entrance){
+	Entrances.RemoveSwap(Entrance);
+}
+
+FName UEntranceStreamingSubsystem::GetLevelKey(const TSoftObjectPtr<UWorld>& Level, const FTransform& Transform){
+	if (Level.IsNull()) {
+		return NAME_None;
+	}
+	//The instance is loaded at the location and rotation, so those are part of the key (scale is not applied)
+	return FName(*FString::Printf(TEXT("%s@%s %s"), *Level.GetLongPackageName(), *Transform.GetLocation().ToString(), *Transform.Rotator().ToString()));
+}
+
+bool UEntranceStreamingSubsystem::IsLevelReady(const TSoftObjectPtr<UWorld>& Level, const FTransform& Transform) const{
+	return IsLevelKeyReady(GetLevelKey(Level, Transform));
+}
+
+bool UEntranceStreamingSubsystem::IsLevelKeyReady(const FName Key) const{
+	if (Key.IsNone()) {
+		return true;
+	}
+	const FStreamedLevel* Cached = Levels.Find(Key);
+	return Cached && Cached->Streaming.IsValid() && Cached->Streaming->HasLoadedLevel();
+}
+
+int32 UEntranceStreamingSubsystem::GetNumCachedLevels() const{
+	return Levels.Num();
+}
+
+bool UEntranceStreamingSubsystem::IsTickable() const{
+	return !HasAnyFlags(RF_ClassDefaultObject) && GetWorld() && GetWorld()->IsGameWorld() && (Entrances.Num() > 0 || bTransitionPending);
+}
+
+TStatId UEntranceStreamingSubsystem::GetStatId() const{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEntranceStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void UEntranceStreamingSubsystem::Tick(float DeltaTime){
+	DIMENSE_SCOPE(STAT_DimenseEntranceStreaming, EntranceStreaming);
+	PredictEntrances();
+	TrimCache();
+	if (bTransitionPending) {
+		UpdateTransition(DeltaTime);
+	}
+	SET_DWORD_STAT(STAT_DimenseEntranceLevels, Levels.Num());
+}
+
+ULevelStreamingDynamic* UEntranceStreamingSubsystem::RequestLevel(const UDimenseEntranceComponent* Entrance){
+	FName Key = Entrance->GetDestinationKey();
+	FStreamedLevel* Cached = Levels.Find(Key);
+	if (Cached && Cached->Streaming.IsValid()) {
+		Cached->LastUsed = FPlatformTime::Seconds();
+		return Cached->Streaming.Get();
+	}
+	//Loaded hidden, EnterThrough shows it
+	bool bSuccess = false;
+	ULevelStreamingDynamic* Streaming = ULevelStreamingDynamic::LoadLevelInstanceBySoftObjectPtr(GetWorld(), Entrance->DestinationLevel, Entrance->DestinationTransform.GetLocation(), Entrance->DestinationTransform.Rotator(), bSuccess);
+	if (!bSuccess || !Streaming) {
+		UE_LOG(LogDimense, Warning, TEXT("Entrance %s could not stream %s"), *GetNameSafe(Entrance->GetOwner()), *Key.ToString());
+		Levels.Remove(Key);
+		return nullptr;
+	}
+	Streaming->SetShouldBeVisible(false);
+	FStreamedLevel& Level = Levels.Add(Key);
+	Level.Streaming = Streaming;
+	Level.LastUsed = FPlatformTime::Seconds();
+	return Streaming;
+}
+
+void UEntranceStreamingSubsystem::PredictEntrances(){
+	PredictedLevels.Reset();
+	APawn* Player = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
+	if (!Player) {
+		return;
+	}
+	FVector Location = Player->GetActorLocation();
+	FVector Velocity = Player->GetVelocity();
+	//Measure on the 2D view: the camera axis component of the distance is what Transport skips
+	FVector CamAxis = FVector::ZeroVector;
+	if (ADimenseCharacter* Character = Cast<ADimenseCharacter>(Player)) {
+		CamAxis = Character->CamForwardVector.GetAbs();
+	}
+	for (int32 i = Entrances.Num() - 1; i >= 0; i--) {
+		UDimenseEntranceComponent* Entrance = Entrances[i].Get();
+		if (!Entrance) {
+			Entrances.RemoveAtSwap(i);
+			continue;
+		}
+		FName Key = Entrance->GetDestinationKey();
+		if (Key.IsNone() || Key == CurrentLevel) {
+			continue;
+		}
+		FVector ToEntrance = Entrance->GetComponentLocation() - Location;
+		ToEntrance -= ToEntrance * CamAxis;
+		float Distance = ToEntrance.Size();
+		float Closing = Distance > KINDA_SMALL_NUMBER ? FVector::DotProduct(Velocity - Velocity * CamAxis, ToEntrance / Distance) : 0.0f;
+		if (Distance <= Entrance->PreloadRadius || (Closing > 0.0f && Distance <= Closing * PreloadLeadSeconds)) {
+			PredictedLevels.Add(Key);
+			RequestLevel(Entrance);
+		}
+	}
+}
+
+void UEntranceStreamingSubsystem::TrimCache(){
+	while (Levels.Num() > FMath::Max(MaxCachedLevels, 1)) {
+		//Least recently used that isn't shown, being entered or about to be entered
+		FName Oldest = NAME_None;
+		double OldestTime = TNumericLimits<double>::Max();
+		for (const TPair<FName, FStreamedLevel>& Level : Levels) {
+			if (Level.Key == CurrentLevel || (bTransitionPending && Level.Key == Pending.Level) || PredictedLevels.Contains(Level.Key)) {
+				continue;
+			}
+			if (Level.Value.LastUsed < OldestTime) {
+				Oldest = Level.Key;
+				OldestTime = Level.Value.LastUsed;
+			}
+		}
+		if (Oldest.IsNone()) {
+			return;
+		}
+		FStreamedLevel Evicted;
+		Levels.RemoveAndCopyValue(Oldest, Evicted);
+		if (Evicted.Streaming.IsValid()) {
+			Evicted.Streaming->SetIsRequestingUnloadAndRemoval(true);
+		}
+	}
+}
+
+void UEntranceStreamingSubsystem::EnterThrough(UDimenseEntranceComponent* Entrance){
+	if (!Entrance) {
+		return;
+	}
+	FName Key = Entrance->GetDestinationKey();
+	if (CurrentLevel != Key && !CurrentLevel.IsNone()) {
+		//Hidden, not unloaded: it stays cached for the way back
+		if (FStreamedLevel* Previous = Levels.Find(CurrentLevel)) {
+			if (Previous->Streaming.IsValid()) {
+				Previous->Streaming->SetShouldBeVisible(false);
+			}
+			Previous->LastUsed = FPlatformTime::Seconds();
+		}
+	}
+	Pending = FTransition();
+	Pending.Level = Key;
+	Pending.bInterior = Entrance->bInterior && !Key.IsNone();
+	Pending.bPreloaded = IsLevelKeyReady(Key);
+	Pending.StartTime = FPlatformTime::Seconds();
+	bTransitionPending = true;
+	CurrentLevel = Key;
+	if (!Key.IsNone()) {
+		//Becomes visible over the next frames (or once loaded), no flush
+		if (ULevelStreamingDynamic* Streaming = RequestLevel(Entrance)) {
+			Streaming->SetShouldBeVisible(true);
+		}else{
+			bTransitionPending = false;
+			CurrentLevel = NAME_None;
+			return;
+		}
+	}
+	if (!Pending.bInterior) {
+		if (ADimenseCharacter* Character = Cast<ADimenseCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0))) {
+			Character->bIsInside = false;
+		}
+	}
+}
+
+void UEntranceStreamingSubsystem::UpdateTransition(const float DeltaTime){
+	Pending.WorstFrameMs = FMath::Max(Pending.WorstFrameMs, DeltaTime * 1000.0f);
+	if (!Pending.Level.IsNone()) {
+		FStreamedLevel* Level = Levels.Find(Pending.Level);
+		if (!Level || !Level->Streaming.IsValid()) {
+			UE_LOG(LogDimense, Warning, TEXT("Transition to %s lost its level"), *Pending.Level.ToString());
+			bTransitionPending = false;
+			return;
+		}
+		if (!Level->Streaming->IsLevelVisible()) {
+			return;
+		}
+	}
+	bTransitionPending = false;
+	Pending.MsUntilVisible = float((FPlatformTime::Seconds() - Pending.StartTime) * 1000.0);
+	if (Pending.bInterior) {
+		if (ADimenseCharacter* Character = Cast<ADimenseCharacter>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0))) {
+			Character->bIsInside = true;
+		}
+	}
+	CSV_CUSTOM_STAT(Dimense, EntranceVisibleMs, Pending.MsUntilVisible, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Dimense, EntranceWorstFrameMs, Pending.WorstFrameMs, ECsvCustomStatOp::Set);
+	UE_LOG(LogDimense, Log, TEXT("Entered %s: visible after %.1f ms, worst frame %.1f ms, %s"), Pending.Level.IsNone() ? TEXT("persistent level") : *Pending.Level.ToString(), Pending.MsUntilVisible, Pending.WorstFrameMs, Pending.bPreloaded ? TEXT("preloaded") : TEXT("not preloaded"));
+	if (History.Num() >= 16) {
+		History.RemoveAt(0);
+	}
+	History.Add(Pending);
+}
+
+void UEntranceStreamingSubsystem::LogTransitions() const{
+	UE_LOG(LogDimense, Log, TEXT("Transitions: %d, levels cached: %d of %d"), History.Num(), Levels.Num(), MaxCachedLevels);
+	for (const FTransition& Transition : History) {
+		UE_LOG(LogDimense, Log, TEXT("  %s: visible after %.1f ms, worst frame %.1f ms, %s"), Transition.Level.IsNone() ? TEXT("persistent level") : *Transition.Level.ToString(), Transition.MsUntilVisible, Transition.WorstFrameMs, Transition.bPreloaded ? TEXT("preloaded") : TEXT("not preloaded"));
+	}
+}
@@ -0,0 +1,93 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EntranceStreamingSubsystem.generated.h"
+
+class UDimenseEntranceComponent;
+class ULevelStreamingDynamic;
+class UWorld;
+
+/**
+ * Streams the maps behind entrances (UDimenseEntranceComponent) in as level instances before the player gets to them.
+ * Each frame every entrance is checked against the player: within its PreloadRadius, or closing on it fast enough to arrive within
+ * PreloadLeadSeconds, starts an async load of its destination, which stays hidden until the entrance is used. Distances are measured
+ * on the 2D view (Transport moves the player along the camera axis freely), and only the speed towards the entrance counts.
+ * Entering shows the destination and hides the previous interior without flushing streaming, so nothing blocks. The last
+ * MaxCachedLevels destinations stay loaded, the least recently used beyond that are unloaded unless current or predicted.
+ * A destination is a map at a placement: entrances into the same map at different DestinationTransforms get separate instances.
+ * Every transition is timed from Enter until the destination is visible, with the worst frame in between, and logged.
+ */
+UCLASS()
+class PLATFORMERCPP_API UEntranceStreamingSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UEntranceStreamingSubsystem();
+
+	//Entrances add themselves on BeginPlay and remove themselves on EndPlay
+	void RegisterEntrance(UDimenseEntranceComponent* Entrance);
+	void UnregisterEntrance(UDimenseEntranceComponent* Entrance);
+
+	//Switches to Entrance's destination (see UDimenseEntranceComponent::Enter)
+	void EnterThrough(UDimenseEntranceComponent* Entrance);
+
+	UFUNCTION(BlueprintCallable, Category = "Entrance", meta = (Tooltip = "Is this map loaded at this placement (or None, the persistent level)?"))
+		bool IsLevelReady(const TSoftObjectPtr<UWorld>& Level, const FTransform& Transform) const;
+
+	//IsLevelReady for a key from GetLevelKey
+	bool IsLevelKeyReady(const FName Key) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Entrance")
+		int32 GetNumCachedLevels() const;
+
+	//Cache key of a map at a placement, None for the persistent level. Formats a string, entrances keep theirs (GetDestinationKey).
+	static FName GetLevelKey(const TSoftObjectPtr<UWorld>& Level, const FTransform& Transform);
+
+	//Logs the most recent transitions, oldest first
+	void LogTransitions() const;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entrance", meta = (Tooltip = "How many destination maps stay loaded. The least recently used beyond this are unloaded."))
+		int32 MaxCachedLevels;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Entrance", meta = (Tooltip = "Start loading when the player would reach an entrance within this many seconds at its current speed towards it."))
+		float PreloadLeadSeconds;
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FStreamedLevel {
+		TWeakObjectPtr<ULevelStreamingDynamic> Streaming;
+		double LastUsed = 0.0;
+	};
+
+	struct FTransition {
+		FName Level;
+		bool bPreloaded = false;
+		bool bInterior = false;
+		double StartTime = 0.0;
+		float MsUntilVisible = 0.0f;
+		float WorstFrameMs = 0.0f;
+	};
+
+	TArray<TWeakObjectPtr<UDimenseEntranceComponent>> Entrances;
+	TMap<FName, FStreamedLevel> Levels; //By long package name and placement
+	TSet<FName> PredictedLevels; //Destinations of the entrances the player is heading for, this frame
+
+	FName CurrentLevel; //Shown destination, None when outside
+	FTransition Pending;
+	bool bTransitionPending;
+	TArray<FTransition> History;
+
+	ULevelStreamingDynamic* RequestLevel(const UDimenseEntranceComponent* Entrance);
+	void PredictEntrances();
+	void TrimCache();
+	void UpdateTransition(const float DeltaTime);
+};
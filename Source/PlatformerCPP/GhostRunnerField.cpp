@@ -0,0 +1,309 @@
+// Copyright 2020 Ryan Gourley
+
+#include "GhostRunnerField.h"
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/Engine/StaticMesh.h"
+#include "Runtime/Engine/Classes/Components/InstancedStaticMeshComponent.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+#include "PlatformerCPP.h"
+#include "DimenseCharacter.h"
+#include "DimenseMovementRules.h"
+#include "PlatformProjectionSubsystem.h"
+
+namespace GhostRunner {
+	//The same lengths the character's traces use
+	const float FloorHover = 2.0f; //UCharacterMovementComponent keeps the capsule this far above the floor
+	const float MaxStepHeight = 45.0f;
+	const float TransportTraceZOffset = 25.0f;
+	const float HeadTraceLength = 10.0f;
+	const FVector MoveAroundBoxSize(25.0f, 25.0f, 50.0f);
+	const float HeadroomPadding = 10.0f;
+	//Below this many runners the task overhead costs more than it saves
+	const int32 MinParallelRunners = 32;
+}
+
+// Sets default values
+AGhostRunnerField::AGhostRunnerField(){
+	PrimaryActorTick.bCanEverTick = true;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	//A plain instanced mesh, not a hierarchical one: every instance moves every frame, so there is no cluster tree worth keeping
+	Runners = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Runners"));
+	Runners->SetupAttachment(RootComponent);
+	Runners->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Runners->SetCastShadow(false);
+	Runners->SetMobility(EComponentMobility::Movable);
+	RunnerMesh = nullptr;
+	RunnerMaterial = nullptr;
+	RunnerHalfSize = FVector2D(18.75f, 50.0f);
+	RunSpeed = 600.0f;
+	JumpSpeed = 1000.0f;
+	Gravity = 980.0f;
+	CameraLineLength = 3000.0f;
+	MoveCooldown = 0.2f;
+	KillZ = -5000.0f;
+	bFollowPlayerView = true;
+}
+
+// Called when the game starts or when spawned
+void AGhostRunnerField::BeginPlay(){
+	Super::BeginPlay();
+	if (RunnerMesh) {
+		Runners->SetStaticMesh(RunnerMesh);
+	}
+	if (RunnerMaterial) {
+		Runners->SetMaterial(0, RunnerMaterial);
+	}
+}
+
+int32 AGhostRunnerField::AddRunner(const FVector& Location, const bool bThink){
+	int32 Runner = Locations.Add(Location);
+	Velocities.Add(FVector::ZeroVector);
+	SpawnLocations.Add(Location);
+	Cooldowns.Add(0.0f);
+	Seeds.Add((uint32(Runner) * 2654435761u) | 1u); //Seeded by the runner so the same field runs the same way
+	ThinkTimers.Add(NextRandom(Seeds.Last()) * 2.0f);
+	Axes.Add(bThink ? (NextRandom(Seeds.Last()) < 0.5f ? -1.0f : 1.0f) : 0.0f);
+	ViewIndices.Add(0);
+	Flags.Add(bThink ? Think : 0);
+	Transforms.Add(FTransform(Location));
+	Runners->AddInstanceWorldSpace(Transforms.Last());
+	return Runner;
+}
+
+int32 AGhostRunnerField::AddRunners(const FVector& Center, const int32 Count, const float Spacing){
+	int32 Total = Locations.Num() + Count;
+	Locations.Reserve(Total);
+	Velocities.Reserve(Total);
+	SpawnLocations.Reserve(Total);
+	Cooldowns.Reserve(Total);
+	Seeds.Reserve(Total);
+	ThinkTimers.Reserve(Total);
+	Axes.Reserve(Total);
+	ViewIndices.Reserve(Total);
+	Flags.Reserve(Total);
+	Transforms.Reserve(Total);
+	FVector CamForward; FVector CamRight; int32 CamSign; int32 CamSide;
+	FDimenseMovementRules::GetViewVectors(0, CamForward, CamRight, CamSign, CamSide);
+	ADimenseCharacter* Player = Cast<ADimenseCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (Player) {
+		FDimenseMovementRules::GetViewVectors(FDimenseMovementRules::GetViewIndex(Player->CamForwardVector), CamForward, CamRight, CamSign, CamSide);
+	}
+	int32 First = Locations.Num();
+	for (int32 Runner = 0; Runner < Count; Runner++) {
+		AddRunner(Center + CamRight * Spacing * (Runner - (Count - 1) * 0.5f));
+	}
+	return Count > 0 ? First : INDEX_NONE;
+}
+
+void AGhostRunnerField::ClearRunners(){
+	Locations.Reset();
+	Velocities.Reset();
+	SpawnLocations.Reset();
+	Cooldowns.Reset();
+	Seeds.Reset();
+	ThinkTimers.Reset();
+	Axes.Reset();
+	ViewIndices.Reset();
+	Flags.Reset();
+	Transforms.Reset();
+	Runners->ClearInstances();
+}
+
+void AGhostRunnerField::SetRunnerInput(const int32 Runner, const float Axis, const bool bJump){
+	if (!Locations.IsValidIndex(Runner)) {
+		return;
+	}
+	Axes[Runner] = FMath::Clamp(Axis, -1.0f, 1.0f);
+	Flags[Runner] &= ~Think;
+	if (bJump) {
+		Flags[Runner] |= JumpHeld;
+	}else{
+		Flags[Runner] &= ~(JumpHeld | Jumped);
+	}
+}
+
+void AGhostRunnerField::SetRunnerView(const int32 Runner, const int32 ViewIndex){
+	if (Locations.IsValidIndex(Runner)) {
+		ViewIndices[Runner] = int8(((ViewIndex % 4) + 4) % 4);
+	}
+}
+
+int32 AGhostRunnerField::GetNumRunners() const{
+	return Locations.Num();
+}
+
+FVector AGhostRunnerField::GetRunnerLocation(const int32 Runner) const{
+	return Locations.IsValidIndex(Runner) ? Locations[Runner] : FVector::ZeroVector;
+}
+
+float AGhostRunnerField::NextRandom(uint32& Seed){
+	//xorshift32, one word of state per runner and safe to call from the runner's own task
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return float(Seed & 0xFFFFFF) / float(0x1000000);
+}
+
+void AGhostRunnerField::ThinkRunner(const int32 Runner, const float DeltaTime, const bool bBlocked){
+	uint8& State = Flags[Runner];
+	uint32& Seed = Seeds[Runner];
+	ThinkTimers[Runner] -= DeltaTime;
+	if ((State & OnGround) && bBlocked && NextRandom(Seed) < 0.05f) {
+		Axes[Runner] = -Axes[Runner]; //Stuck, sometimes give up and run the other way
+	}
+	if ((State & OnGround) && (bBlocked || ThinkTimers[Runner] <= 0.0f)) {
+		State |= JumpHeld;
+		ThinkTimers[Runner] = FMath::Lerp(0.5f, 2.5f, NextRandom(Seed));
+	}else if (Velocities[Runner].Z <= 0.0f) {
+		State &= ~JumpHeld; //Let go at the top of the jump
+	}
+}
+
+void AGhostRunnerField::StepRunner(const int32 Runner, const float DeltaTime, const UPlatformProjectionSubsystem& Index){
+	using namespace GhostRunner;
+	FVector Location = Locations[Runner];
+	FVector Velocity = Velocities[Runner];
+	uint8& State = Flags[Runner];
+	FVector CamForward; FVector CamRight; int32 CamSign; int32 CamSide;
+	FDimenseMovementRules::GetViewVectors(ViewIndices[Runner], CamForward, CamRight, CamSign, CamSide);
+	FVector Extent(RunnerHalfSize.X, RunnerHalfSize.X, RunnerHalfSize.Y);
+	FVector LandingOffsetPadding(RunnerHalfSize.X * 2, RunnerHalfSize.X * 2, 0.0f);
+	Cooldowns[Runner] = FMath::Max(Cooldowns[Runner] - DeltaTime, 0.0f);
+	bool bCanMove = Cooldowns[Runner] <= 0.0f;
+
+	//1 if visible from the camera, -1 if visible from the back, 0 if from neither, like the character's SetVisibilitySide
+	int32 VisibilitySide = 1;
+	if (Index.GetOccludedFraction(CamForward, Location, RunnerHalfSize) > 0.5f) {
+		VisibilitySide = Index.GetOccludedFraction(-CamForward, Location, RunnerHalfSize) > 0.5f ? 0 : -1;
+	}
+	FVector LineVector = CamForward * CameraLineLength * VisibilitySide;
+
+	//Left and right: blocked by anything in the way above step height, unless it can be moved around on the view
+	bool bBlocked = false;
+	float Along = Axes[Runner] * RunSpeed;
+	Velocity.X = 0.0f;
+	Velocity.Y = 0.0f;
+	if (Along != 0.0f) {
+		FVector Start = Location + FVector(0.0f, 0.0f, MaxStepHeight / 2);
+		FVector End = Start + CamRight * FMath::Sign(Along) * (FMath::Abs(Along) * DeltaTime + 1.0f);
+		FPlatformIndexHit Hit;
+		//Already inside a platform (the sweep hits at its start) is walked through, like bIsInside
+		if (Index.SweepBoundsAlongAxis(Start, End, Extent - FVector(0.0f, 0.0f, MaxStepHeight / 2), Hit) && !Hit.Location.Equals(Start)) {
+			FPlatformIndexHit Around;
+			if (bCanMove && VisibilitySide != 0 && Index.SweepBoundsAlongAxis(Location - LineVector, Location + LineVector, MoveAroundBoxSize, Around)) {
+				Location += FDimenseMovementRules::GetMoveAroundOffset(Around.Location, Location, CamForward, LandingOffsetPadding, CamSide, CamSign, VisibilitySide);
+				Cooldowns[Runner] = MoveCooldown;
+			}else{
+				bBlocked = true;
+			}
+		}else{
+			Velocity += CamRight * Along;
+		}
+	}
+
+	//Jump on the first tick the key is held on the ground
+	if ((State & OnGround) && (State & JumpHeld) && !(State & Jumped)) {
+		Velocity.Z = JumpSpeed;
+		State &= ~OnGround;
+		State |= Jumped;
+	}
+	if (!(State & JumpHeld)) {
+		State &= ~Jumped;
+	}
+	if (!(State & OnGround)) {
+		Velocity.Z -= Gravity * DeltaTime;
+	}
+
+	FVector Next = Location + Velocity * DeltaTime;
+	FBox2D Footprint(FVector2D(Next) - FVector2D(RunnerHalfSize.X, RunnerHalfSize.X), FVector2D(Next) + FVector2D(RunnerHalfSize.X, RunnerHalfSize.X));
+	if (Velocity.Z <= 0.0f) {
+		//Land when the foot passes a top face, stay on the ground over steps and down small drops
+		float Foot = Location.Z - Extent.Z;
+		float NextFoot = Next.Z - Extent.Z;
+		float Reach = (State & OnGround) ? MaxStepHeight : FloorHover;
+		FPlatformIndexHit Ground;
+		if (Index.FindGroundBelow(Footprint, NextFoot - Reach, Foot + ((State & OnGround) ? MaxStepHeight : 0.0f), Ground)) {
+			Next.Z = Ground.Bounds.Max.Z + FloorHover + Extent.Z;
+			Velocity.Z = 0.0f;
+			State |= OnGround;
+		}else{
+			State &= ~OnGround;
+			//Falling: Transport onto a surface platform along the camera axis just under the foot, if there is room to stand on it
+			FVector TransportStart = FVector(Next.X, Next.Y, NextFoot - TransportTraceZOffset);
+			FPlatformIndexHit Hit;
+			if (bCanMove && VisibilitySide != 0 && Index.SweepBoundsAlongAxis(TransportStart - LineVector, TransportStart + LineVector, FVector(Extent.X, Extent.Y, 0.0f), Hit) && Hit.bSurface && NextFoot >= Hit.Bounds.Max.Z) {
+				FVector Offset = FDimenseMovementRules::GetTransportOffset(Hit.Location, Hit.Bounds.Max.Z, Next, CamForward, LandingOffsetPadding, CamSide, CamSign, VisibilitySide);
+				FVector2D Landing = FVector2D(Next + Offset);
+				FVector2D HalfSize(RunnerHalfSize.X, RunnerHalfSize.X);
+				if (Index.GetHeadroomOf(Hit.Id, FBox2D(Landing - HalfSize, Landing + HalfSize)) > Extent.Z * 2 + HeadroomPadding) {
+					Next += Offset;
+					Cooldowns[Runner] = MoveCooldown;
+				}
+			}
+		}
+	}else{
+		//Rising: MoveAround what is over the head, or bump into it
+		FPlatformIndexHit Ceiling;
+		if (Index.FindCeilingAbove(Footprint, Location.Z + Extent.Z, Next.Z + Extent.Z + HeadTraceLength, Ceiling)) {
+			FVector Head = Location + FVector(0.0f, 0.0f, HeadTraceLength);
+			FPlatformIndexHit Around;
+			if (bCanMove && VisibilitySide != 0 && Index.SweepBoundsAlongAxis(Head - LineVector, Head + LineVector, MoveAroundBoxSize, Around)) {
+				Next += FDimenseMovementRules::GetMoveAroundOffset(Around.Location, Head, CamForward, LandingOffsetPadding, CamSide, CamSign, VisibilitySide);
+				Cooldowns[Runner] = MoveCooldown;
+			}else{
+				Next.Z = FMath::Min(Next.Z, Ceiling.Bounds.Min.Z - Extent.Z);
+				Velocity.Z = 0.0f;
+			}
+		}
+	}
+
+	if (Next.Z < KillZ) {
+		Next = SpawnLocations[Runner];
+		Velocity = FVector::ZeroVector;
+		State &= ~OnGround;
+	}
+	Locations[Runner] = Next;
+	Velocities[Runner] = Velocity;
+	if (State & Think) {
+		ThinkRunner(Runner, DeltaTime, bBlocked);
+	}
+	FQuat Facing = Transforms[Runner].GetRotation();
+	if (Axes[Runner] != 0.0f) {
+		Facing = (CamRight * FMath::Sign(Axes[Runner])).ToOrientationQuat();
+	}
+	Transforms[Runner] = FTransform(Facing, Next);
+}
+
+// Called every frame
+void AGhostRunnerField::Tick(float DeltaTime){
+	Super::Tick(DeltaTime);
+	UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>();
+	if (Locations.Num() == 0 || !ProjectionIndex) {
+		return;
+	}
+	DIMENSE_SCOPE(STAT_DimenseGhostRunners, GhostRunners);
+	//With the count next to the step time, a CSV capture shows the cost at each field size (the 2 ms budget is for 500)
+	SET_DWORD_STAT(STAT_DimenseGhostRunnerCount, Locations.Num());
+	CSV_CUSTOM_STAT(Dimense, GhostRunnerCount, Locations.Num(), ECsvCustomStatOp::Set);
+	if (bFollowPlayerView) {
+		if (ADimenseCharacter* Player = Cast<ADimenseCharacter>(UGameplayStatics::GetPlayerPawn(this, 0))) {
+			int8 View = int8(FDimenseMovementRules::GetViewIndex(Player->CamForwardVector));
+			for (int8& ViewIndex : ViewIndices) {
+				ViewIndex = View;
+			}
+		}
+	}
+	//A long frame would let a runner fall through a platform in one step
+	float Step = FMath::Min(DeltaTime, 1.0f / 30.0f);
+	//Each runner only writes its own entries and the index is only read while the game thread waits here, so any order on any thread
+	const UPlatformProjectionSubsystem& Index = *ProjectionIndex;
+	{
+		//The simulation alone, the instance upload below is timed by the whole tick's scope
+		DIMENSE_SCOPE(STAT_DimenseGhostRunnerStep, GhostRunnerStep);
+		ParallelFor(Locations.Num(), [this, Step, &Index](int32 Runner) {
+			StepRunner(Runner, Step, Index);
+		}, Locations.Num() < GhostRunner::MinParallelRunners);
+	}
+	Runners->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+}
@@ -0,0 +1,116 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GhostRunnerField.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+class UPlatformProjectionSubsystem;
+
+/**
+ * Ghost runners to race against, hundreds at a time: no actor, capsule or UCharacterMovementComponent each, just parallel arrays
+ * stepped by a ParallelFor and drawn by one instanced mesh without collision.
+ * A runner walks along the camera's right vector, jumps and falls, lands on what is under it, Transports while falling and
+ * Moves Around what blocks it by the same rules as ADimenseCharacter (FDimenseMovementRules). Every question about the level is
+ * answered by the platform projection index's plain data queries, which only read, so the runners step on worker threads while
+ * the game thread waits and nothing touches physics.
+ * Runners either think for themselves (walk, jump now and then, turn around when stuck) or are driven with SetRunnerInput.
+ */
+UCLASS()
+class PLATFORMERCPP_API AGhostRunnerField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AGhostRunnerField();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ghost Runners")
+		UStaticMesh* RunnerMesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ghost Runners")
+		UMaterialInterface* RunnerMaterial;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners", meta = (Tooltip = "Half the runner's width and height, the player's capsule by default."))
+		FVector2D RunnerHalfSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners")
+		float RunSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners", meta = (Tooltip = "Upward speed at the start of a jump."))
+		float JumpSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners")
+		float Gravity;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners", meta = (Tooltip = "How far along the camera axis Transport and MoveAround look, each way."))
+		float CameraLineLength;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners", meta = (Tooltip = "Seconds after a Transport or MoveAround before the next one, like the character's CanMoveAround timer."))
+		float MoveCooldown;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners", meta = (Tooltip = "Runners falling below this height go back to where they were added."))
+		float KillZ;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost Runners", meta = (Tooltip = "Runners move on the same view as the player. Otherwise SetRunnerView sets it per runner."))
+		bool bFollowPlayerView;
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners", meta = (Tooltip = "Adds a runner and returns its index. bThink runners drive themselves."))
+		int32 AddRunner(const FVector& Location, const bool bThink = true);
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners", meta = (Tooltip = "Adds Count thinking runners spread along the camera's right vector around Center. Returns the index of the first one."))
+		int32 AddRunners(const FVector& Center, const int32 Count, const float Spacing = 50.0f);
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners")
+		void ClearRunners();
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners", meta = (Tooltip = "Drives a runner: Axis like MoveLeftRight, bJump like holding the jump key. Stops it thinking for itself."))
+		void SetRunnerInput(const int32 Runner, const float Axis, const bool bJump);
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners", meta = (Tooltip = "Camera orientation (0-3, yaw / 90) the runner moves on."))
+		void SetRunnerView(const int32 Runner, const int32 ViewIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners")
+		int32 GetNumRunners() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Ghost Runners")
+		FVector GetRunnerLocation(const int32 Runner) const;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+private:
+	enum ERunnerFlag : uint8 {
+		OnGround = 1 << 0,
+		Think = 1 << 1,
+		JumpHeld = 1 << 2,
+		Jumped = 1 << 3, //Jump held since the last takeoff, let go to jump again
+	};
+
+	//One entry per runner in each
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	TArray<FVector> SpawnLocations;
+	TArray<float> Axes;
+	TArray<float> Cooldowns; //Seconds until the next Transport or MoveAround, like the character's CanMoveAround timer
+	TArray<float> ThinkTimers;
+	TArray<uint32> Seeds;
+	TArray<int8> ViewIndices;
+	TArray<uint8> Flags;
+	TArray<FTransform> Transforms;
+
+	UPROPERTY()
+		UInstancedStaticMeshComponent* Runners;
+
+	void StepRunner(const int32 Runner, const float DeltaTime, const UPlatformProjectionSubsystem& Index);
+	void ThinkRunner(const int32 Runner, const float DeltaTime, const bool bBlocked);
+	static float NextRandom(uint32& Seed);
+};
@@ -0,0 +1,162 @@
+// Copyright 2020 Ryan Gourley
+
+#include "InstancedPlatformManager.h"
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/Engine/StaticMesh.h"
+#include "Runtime/Engine/Classes/Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "PlatformerCPP.h"
+#include "PlatformMaster.h"
+#include "PlatformProjectionSubsystem.h"
+#include "SurfacePlatformComponent.h"
+#include "SurfacePlatformSubsystem.h"
+
+namespace {
+	//Where removed instances wait to be reused, well below anything playable
+	const FTransform ParkedTransform(FVector(0.0f, 0.0f, -HALF_WORLD_MAX / 2));
+}
+
+// Sets default values
+AInstancedPlatformManager::AInstancedPlatformManager(){
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	NumLive = 0;
+}
+
+// Called when the game starts or when spawned
+void AInstancedPlatformManager::BeginPlay(){
+	Super::BeginPlay();
+	CreateArchetypeComponents();
+}
+
+// Called when the manager is destroyed or its level is unloaded
+void AInstancedPlatformManager::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>();
+	USurfacePlatformSubsystem* SurfaceRegistry = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>();
+	for (int32 Archetype = 0; Archetype < Instances.Num(); Archetype++) {
+		for (int32 Instance = 0; Instance < Instances[Archetype].Records.Num(); Instance++) {
+			if (!Instances[Archetype].Records[Instance].bLive) {
+				continue;
+			}
+			if (ProjectionIndex) {
+				ProjectionIndex->UnregisterInstance(ArchetypeComponents[Archetype], Instance);
+			}
+			if (SurfaceRegistry) {
+				SurfaceRegistry->UnregisterInstanceSurface(ArchetypeComponents[Archetype], Instance);
+			}
+		}
+		for (const TPair<int32, TWeakObjectPtr<APlatformMaster>>& Proxy : Instances[Archetype].Proxies) {
+			if (Proxy.Value.IsValid()) {
+				Proxy.Value->Destroy();
+			}
+		}
+	}
+	Instances.Reset();
+	NumLive = 0;
+	Super::EndPlay(EndPlayReason);
+}
+
+void AInstancedPlatformManager::CreateArchetypeComponents(){
+	Instances.SetNum(Archetypes.Num());
+	for (int32 Archetype = 0; Archetype < Archetypes.Num(); Archetype++) {
+		UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, *FString::Printf(TEXT("Platforms_%s"), *Archetypes[Archetype].Name.ToString()));
+		Component->SetStaticMesh(Archetypes[Archetype].Mesh);
+		if (Archetypes[Archetype].Material) {
+			Component->SetMaterial(0, Archetypes[Archetype].Material);
+		}
+		Component->SetCollisionProfileName(TEXT("PlatformStatic"));
+		Component->SetupAttachment(RootComponent);
+		Component->RegisterComponent();
+		ArchetypeComponents.Add(Component);
+	}
+}
+
+int32 AInstancedPlatformManager::AddPlatform(const int32 Archetype, const FTransform& Transform){
+	if (!ArchetypeComponents.IsValidIndex(Archetype) || !Archetypes[Archetype].Mesh) {
+		UE_LOG(LogDimense, Error, TEXT("%s has no archetype %d with a mesh"), *GetName(), Archetype);
+		return INDEX_NONE;
+	}
+	UHierarchicalInstancedStaticMeshComponent* Component = ArchetypeComponents[Archetype];
+	FArchetypeInstances& ArchetypeInstances = Instances[Archetype];
+	int32 Instance;
+	if (ArchetypeInstances.FreeSlots.Num() > 0) {
+		Instance = ArchetypeInstances.FreeSlots.Pop(false);
+		Component->UpdateInstanceTransform(Instance, Transform, true, true, true);
+	}else{
+		Instance = Component->AddInstanceWorldSpace(Transform);
+		ArchetypeInstances.Records.SetNum(Instance + 1);
+	}
+	FPlatformInstanceRecord& Record = ArchetypeInstances.Records[Instance];
+	Record.Bounds = Archetypes[Archetype].Mesh->GetBounds().GetBox().TransformBy(Transform);
+	Record.Archetype = Archetype;
+	Record.bSurface = Archetypes[Archetype].bSurface;
+	Record.bLive = true;
+	NumLive++;
+	if (UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>()) {
+		ProjectionIndex->RegisterInstance(Component, Instance, Record.Bounds, Record.bSurface);
+	}
+	//In the surface registry from the start, not only once a hit makes its proxy
+	USurfacePlatformSubsystem* SurfaceRegistry = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>();
+	if (SurfaceRegistry && Record.bSurface) {
+		SurfaceRegistry->RegisterInstanceSurface(Component, Instance, Record.Bounds);
+	}
+	return Instance;
+}
+
+void AInstancedPlatformManager::RemovePlatform(const int32 Archetype, const int32 Instance){
+	if (!Instances.IsValidIndex(Archetype) || !Instances[Archetype].Records.IsValidIndex(Instance) || !Instances[Archetype].Records[Instance].bLive) {
+		return;
+	}
+	FArchetypeInstances& ArchetypeInstances = Instances[Archetype];
+	if (UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>()) {
+		ProjectionIndex->UnregisterInstance(ArchetypeComponents[Archetype], Instance);
+	}
+	if (USurfacePlatformSubsystem* SurfaceRegistry = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>()) {
+		SurfaceRegistry->UnregisterInstanceSurface(ArchetypeComponents[Archetype], Instance);
+	}
+	TWeakObjectPtr<APlatformMaster> Proxy;
+	if (ArchetypeInstances.Proxies.RemoveAndCopyValue(Instance, Proxy) && Proxy.IsValid()) {
+		Proxy->Destroy();
+	}
+	ArchetypeComponents[Archetype]->UpdateInstanceTransform(Instance, ParkedTransform, true, true, true);
+	ArchetypeInstances.Records[Instance].bLive = false;
+	ArchetypeInstances.FreeSlots.Add(Instance);
+	NumLive--;
+}
+
+int32 AInstancedPlatformManager::GetNumPlatforms() const{
+	return NumLive;
+}
+
+int32 AInstancedPlatformManager::GetArchetypeOf(const UPrimitiveComponent* Component) const{
+	return ArchetypeComponents.IndexOfByKey(Component);
+}
+
+const FPlatformInstanceRecord* AInstancedPlatformManager::GetRecord(const UPrimitiveComponent* Component, const int32 Instance) const{
+	int32 Archetype = GetArchetypeOf(Component);
+	if (!Instances.IsValidIndex(Archetype) || !Instances[Archetype].Records.IsValidIndex(Instance)) {
+		return nullptr;
+	}
+	const FPlatformInstanceRecord& Record = Instances[Archetype].Records[Instance];
+	return Record.bLive ? &Record : nullptr;
+}
+
+APlatformMaster* AInstancedPlatformManager::GetInstancePlatform(const UPrimitiveComponent* Component, const int32 Instance){
+	const FPlatformInstanceRecord* Record = GetRecord(Component, Instance);
+	if (!Record) {
+		return nullptr;
+	}
+	TWeakObjectPtr<APlatformMaster>& Proxy = Instances[Record->Archetype].Proxies.FindOrAdd(Instance);
+	if (Proxy.IsValid()) {
+		return Proxy.Get();
+	}
+	FTransform Transform(Record->Bounds.GetCenter());
+	APlatformMaster* NewProxy = GetWorld()->SpawnActorDeferred<APlatformMaster>(APlatformMaster::StaticClass(), Transform, this);
+	NewProxy->SetInstance(ArchetypeComponents[Record->Archetype], Instance, Record->Bounds);
+	UGameplayStatics::FinishSpawningActor(NewProxy, Transform);
+	if (Record->bSurface) {
+		NewObject<USurfacePlatformComponent>(NewProxy, TEXT("InstanceSurface"))->RegisterComponent();
+	}
+	Proxy = NewProxy;
+	return NewProxy;
+}
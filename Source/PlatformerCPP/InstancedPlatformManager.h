@@ -0,0 +1,97 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "InstancedPlatformManager.generated.h"
+
+class APlatformMaster;
+class UHierarchicalInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
+//One kind of instanced platform, drawn by a single hierarchical instanced mesh
+USTRUCT(BlueprintType)
+struct FPlatformArchetype {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Platform")
+		FName Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Platform")
+		UStaticMesh* Mesh = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Platform", meta = (Tooltip = "Overrides the mesh's first material when set."))
+		UMaterialInterface* Material = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Platform", meta = (Tooltip = "Can the player Transport onto these platforms (what a USurfacePlatformComponent marks on actor platforms)?"))
+		bool bSurface = true;
+};
+
+//Gameplay side of one instance
+struct FPlatformInstanceRecord {
+	FBox Bounds;
+	int32 Archetype;
+	bool bSurface;
+	bool bLive;
+};
+
+/**
+ * Draws every platform of an archetype through one hierarchical instanced static mesh component instead of one actor each, and
+ * keeps the gameplay record (bounds, surface flag, archetype) of every instance.
+ * Instances are added to the projection index like actor platforms. The movement code only deals in APlatformMaster*, so when a hit
+ * or an index lookup lands on an instance, APlatformMaster::FromHit hands out a bare proxy APlatformMaster for it: no mesh, no
+ * collision, bounds fixed to the instance's. Proxies are only made for instances the player actually touches.
+ * Removed instances are parked out of the way and their slot reused, so instance indices (and hit Items) never shift.
+ */
+UCLASS()
+class PLATFORMERCPP_API AInstancedPlatformManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AInstancedPlatformManager();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Platform")
+		TArray<FPlatformArchetype> Archetypes;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Adds a platform of the given archetype and returns its instance index, or -1."))
+		int32 AddPlatform(const int32 Archetype, const FTransform& Transform);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform")
+		void RemovePlatform(const int32 Archetype, const int32 Instance);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Number of live instances across every archetype."))
+		int32 GetNumPlatforms() const;
+
+	//Record of an instance of one of this manager's components, null for other components or removed instances
+	const FPlatformInstanceRecord* GetRecord(const UPrimitiveComponent* Component, const int32 Instance) const;
+
+	//Proxy platform standing in for an instance in the movement code, made on first use
+	APlatformMaster* GetInstancePlatform(const UPrimitiveComponent* Component, const int32 Instance);
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the manager is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FArchetypeInstances {
+		TArray<FPlatformInstanceRecord> Records;
+		TArray<int32> FreeSlots;
+		TMap<int32, TWeakObjectPtr<APlatformMaster>> Proxies;
+	};
+
+	UPROPERTY()
+		TArray<UHierarchicalInstancedStaticMeshComponent*> ArchetypeComponents;
+
+	TArray<FArchetypeInstances> Instances;
+	int32 NumLive;
+
+	int32 GetArchetypeOf(const UPrimitiveComponent* Component) const;
+	void CreateArchetypeComponents();
+};
@@ -1,27 +1,185 @@
 // Copyright 2020 Ryan Gourley
 
 #include "LevelGenerator.h"
-
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "PlatformerCPP.h"
+#include "PlatformMaster.h"
+#include "PlatformPoolSubsystem.h"
 
 // Sets default values
-ALevelGenerator::ALevelGenerator()
-{
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ALevelGenerator::ALevelGenerator(){
 	PrimaryActorTick.bCanEverTick = true;
-
+	bStreamChunks = false;
+	ChunkCells = 8;
+	CellSize = 400.0f;
+	ChunkRadius = 2;
+	PlatformDensity = 0.35f;
+	MaxSteps = 3;
+	StepHeight = 100.0f;
+	SpawnBudgetMs = 1.0f;
+	Seed = 1;
 }
 
 // Called when the game starts or when spawned
-void ALevelGenerator::BeginPlay()
-{
+void ALevelGenerator::BeginPlay(){
 	Super::BeginPlay();
-	
+	if (bStreamChunks && PlatformClasses.Num() == 0) {
+		UE_LOG(LogDimense, Error, TEXT("%s streams chunks but has no platform classes"), *GetName());
+		bStreamChunks = false;
+	}
+}
+
+// Called when the generator is destroyed or its level is unloaded
+void ALevelGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	//The layout tasks only hold their own layout, so there is nothing to wait for
+	ClearChunks();
+	if (EndPlayReason == EEndPlayReason::Destroyed || EndPlayReason == EEndPlayReason::RemovedFromWorld) {
+		UPlatformPoolSubsystem* Pool = GetWorld()->GetSubsystem<UPlatformPoolSubsystem>();
+		for (const TWeakObjectPtr<APlatformMaster>& Platform : PendingRelease) {
+			if (Platform.IsValid()) {
+				Pool->Release(Platform.Get());
+			}
+		}
+	}
+	PendingRelease.Reset();
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
-void ALevelGenerator::Tick(float DeltaTime)
-{
+void ALevelGenerator::Tick(float DeltaTime){
 	Super::Tick(DeltaTime);
+	if (!bStreamChunks) {
+		return;
+	}
+	APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (!Player) {
+		return;
+	}
+	DIMENSE_SCOPE(STAT_DimenseLevelStreaming, LevelChunkStreaming);
+	FIntPoint Center = GetChunkOf(Player->GetActorLocation());
+	UpdateChunkRing(Center);
+	SpawnWithinBudget(Center);
+}
+
+FIntPoint ALevelGenerator::GetChunkOf(const FVector& Location) const{
+	FVector Local = Location - GetActorLocation();
+	float ChunkSize = ChunkCells * CellSize;
+	return FIntPoint(FMath::FloorToInt(Local.X / ChunkSize), FMath::FloorToInt(Local.Y / ChunkSize));
+}
+
+void ALevelGenerator::UpdateChunkRing(const FIntPoint& Center){
+	//One chunk of slack before removing, so walking back and forth over a chunk border doesn't regenerate it every time
+	TArray<FIntPoint> Behind;
+	for (const TPair<FIntPoint, FLevelChunk>& Chunk : LiveChunks) {
+		FIntPoint Offset = Chunk.Key - Center;
+		if (FMath::Max(FMath::Abs(Offset.X), FMath::Abs(Offset.Y)) > ChunkRadius + 1) {
+			Behind.Add(Chunk.Key);
+		}
+	}
+	for (const FIntPoint& Key : Behind) {
+		RemoveChunk(Key);
+	}
+	for (int32 X = Center.X - ChunkRadius; X <= Center.X + ChunkRadius; X++) {
+		for (int32 Y = Center.Y - ChunkRadius; Y <= Center.Y + ChunkRadius; Y++) {
+			if (!LiveChunks.Contains(FIntPoint(X, Y))) {
+				StartChunk(FIntPoint(X, Y));
+			}
+		}
+	}
+}
 
+void ALevelGenerator::StartChunk(const FIntPoint& Key){
+	FLevelChunk& Chunk = LiveChunks.Add(Key);
+	Chunk.Layout = MakeShared<FChunkLayout, ESPMode::ThreadSafe>();
+	INC_DWORD_STAT(STAT_DimenseLevelChunks);
+
+	//Everything the task needs is copied in, it never touches the generator
+	TSharedPtr<FChunkLayout, ESPMode::ThreadSafe> Layout = Chunk.Layout;
+	int32 Cells = ChunkCells;
+	float Size = CellSize;
+	float Density = PlatformDensity;
+	int32 Steps = MaxSteps;
+	float Height = StepHeight;
+	int32 NumClasses = PlatformClasses.Num();
+	uint32 ChunkSeed = HashCombine(GetTypeHash(Seed), GetTypeHash(Key));
+	Chunk.LayoutTask = FFunctionGraphTask::CreateAndDispatchWhenReady([=]() {
+		FRandomStream Stream(int32(ChunkSeed));
+		FVector Origin = FVector(Key.X * Cells * Size, Key.Y * Cells * Size, 0.0f);
+		for (int32 X = 0; X < Cells; X++) {
+			for (int32 Y = 0; Y < Cells; Y++) {
+				if (Stream.FRand() >= Density) {
+					continue;
+				}
+				FChunkPlatform Platform;
+				Platform.Location = Origin + FVector((X + 0.5f) * Size, (Y + 0.5f) * Size, Stream.RandRange(0, Steps) * Height);
+				Platform.ClassIndex = Stream.RandRange(0, NumClasses - 1);
+				Layout->Add(Platform);
+			}
+		}
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+void ALevelGenerator::RemoveChunk(const FIntPoint& Key){
+	FLevelChunk Chunk;
+	if (!LiveChunks.RemoveAndCopyValue(Key, Chunk)) {
+		return;
+	}
+	//Released to the pool under the same budget as spawning. A layout still being worked out is simply dropped.
+	PendingRelease.Append(Chunk.Platforms);
+	DEC_DWORD_STAT(STAT_DimenseLevelChunks);
 }
 
+void ALevelGenerator::SpawnWithinBudget(const FIntPoint& Center){
+	double Deadline = FPlatformTime::Seconds() + SpawnBudgetMs / 1000.0;
+	UPlatformPoolSubsystem* Pool = GetWorld()->GetSubsystem<UPlatformPoolSubsystem>();
+	//Old platforms go back to the pool first, so the new chunks can reuse them, but at least one thing happens every frame
+	bool bDidWork = false;
+	while (PendingRelease.Num() > 0 && (!bDidWork || FPlatformTime::Seconds() < Deadline)) {
+		TWeakObjectPtr<APlatformMaster> Platform = PendingRelease.Pop(false);
+		if (Platform.IsValid()) {
+			Pool->Release(Platform.Get());
+			bDidWork = true;
+		}
+	}
+
+	//Nearest chunks first, only once their layout is ready
+	TArray<FIntPoint> Ready;
+	for (const TPair<FIntPoint, FLevelChunk>& Chunk : LiveChunks) {
+		if (Chunk.Value.LayoutTask->IsComplete() && Chunk.Value.NextToSpawn < Chunk.Value.Layout->Num()) {
+			Ready.Add(Chunk.Key);
+		}
+	}
+	Ready.Sort([&Center](const FIntPoint& A, const FIntPoint& B) {
+		return (A - Center).SizeSquared() < (B - Center).SizeSquared();
+	});
+	for (const FIntPoint& Key : Ready) {
+		FLevelChunk& Chunk = LiveChunks[Key];
+		while (Chunk.NextToSpawn < Chunk.Layout->Num()) {
+			if (bDidWork && FPlatformTime::Seconds() >= Deadline) {
+				return;
+			}
+			const FChunkPlatform& Platform = (*Chunk.Layout)[Chunk.NextToSpawn++];
+			if (!PlatformClasses.IsValidIndex(Platform.ClassIndex) || !PlatformClasses[Platform.ClassIndex]) {
+				continue;
+			}
+			FTransform Transform(GetActorLocation() + Platform.Location);
+			if (APlatformMaster* Spawned = Cast<APlatformMaster>(Pool->Acquire(PlatformClasses[Platform.ClassIndex], Transform))) {
+				Chunk.Platforms.Add(Spawned);
+			}
+			bDidWork = true;
+		}
+	}
+}
+
+void ALevelGenerator::ClearChunks(){
+	for (TPair<FIntPoint, FLevelChunk>& Chunk : LiveChunks) {
+		PendingRelease.Append(Chunk.Value.Platforms);
+	}
+	DEC_DWORD_STAT_BY(STAT_DimenseLevelChunks, LiveChunks.Num());
+	LiveChunks.Reset();
+}
+
+int32 ALevelGenerator::GetNumLiveChunks() const{
+	return LiveChunks.Num();
+}
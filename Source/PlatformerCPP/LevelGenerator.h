@@ -4,25 +4,97 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "LevelGenerator.generated.h"
 
+class APlatformMaster;
+
+/**
+ * Endless level made of square chunks on the XY plane.
+ * Every chunk within ChunkRadius of the player's chunk is kept generated and chunks further than ChunkRadius + 1 are removed, so
+ * the number of live platforms stays constant however far the player goes.
+ * A chunk's layout is seeded from its coordinates and worked out on a task graph worker; its platforms are then spawned on the
+ * game thread a few at a time, nearest chunk first, within SpawnBudgetMs per frame.
+ * Platforms come from and go back to the UPlatformPoolSubsystem, so once the first ring is built streaming doesn't spawn or destroy.
+ */
 UCLASS()
 class PLATFORMERCPP_API ALevelGenerator : public AActor
 {
 	GENERATED_BODY()
-	
-public:	
+
+public:
 	// Sets default values for this actor's properties
 	ALevelGenerator();
 
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (Tooltip = "Generate and remove chunks around the player. Off by default so Blueprint generators that drive this actor themselves are left alone."))
+		bool bStreamChunks;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (Tooltip = "Platforms to pick from (evenly, per platform). Needs at least one class with collision and a surface component."))
+		TArray<TSubclassOf<APlatformMaster>> PlatformClasses;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "1", Tooltip = "Chunk width in grid cells."))
+		int32 ChunkCells;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "1", Tooltip = "Distance between platform centers on a chunk's grid."))
+		float CellSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "0", Tooltip = "Chunks kept generated in each direction around the player's chunk."))
+		int32 ChunkRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "0", ClampMax = "1", Tooltip = "Chance of a grid cell getting a platform."))
+		float PlatformDensity;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (Tooltip = "Platform heights are 0 to MaxSteps times StepHeight above the generator."))
+		int32 MaxSteps;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming")
+		float StepHeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (ClampMin = "0", Tooltip = "Game thread time spent placing and releasing platforms per frame."))
+		float SpawnBudgetMs;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk Streaming", meta = (Tooltip = "Same seed, same level."))
+		int32 Seed;
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming", meta = (Tooltip = "Removes every generated chunk. They come back around the player on the next ticks."))
+		void ClearChunks();
+
+	UFUNCTION(BlueprintCallable, Category = "Chunk Streaming")
+		int32 GetNumLiveChunks() const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called when the generator is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	//One platform of a chunk layout, relative to the generator
+	struct FChunkPlatform {
+		FVector Location;
+		int32 ClassIndex;
+	};
+
+	//Written by the layout task only, read once the task is complete
+	typedef TArray<FChunkPlatform> FChunkLayout;
+
+	struct FLevelChunk {
+		TSharedPtr<FChunkLayout, ESPMode::ThreadSafe> Layout;
+		FGraphEventRef LayoutTask;
+		TArray<TWeakObjectPtr<APlatformMaster>> Platforms;
+		int32 NextToSpawn = 0;
+	};
+
+	TMap<FIntPoint, FLevelChunk> LiveChunks;
+	TArray<TWeakObjectPtr<APlatformMaster>> PendingRelease;
 
-	
-	
+	FIntPoint GetChunkOf(const FVector& Location) const;
+	void UpdateChunkRing(const FIntPoint& Center);
+	void StartChunk(const FIntPoint& Key);
+	void RemoveChunk(const FIntPoint& Key);
+	void SpawnWithinBudget(const FIntPoint& Center);
 };
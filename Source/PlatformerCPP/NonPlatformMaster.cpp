@@ -2,6 +2,9 @@
 
 
 #include "NonPlatformMaster.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "PlatformerCPP.h"
 
 // Sets default values
 ANonPlatformMaster::ANonPlatformMaster()
@@ -9,6 +12,7 @@ ANonPlatformMaster::ANonPlatformMaster()
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = false;
 	PrimaryActorTick.bStartWithTickEnabled = false;
+	bBlocksMovementSystem = false;
 
 };
 
@@ -19,6 +23,26 @@ void ANonPlatformMaster::BeginPlay()
 
 };
 
+// Components were (re)registered, so their object type may need fixing up
+void ANonPlatformMaster::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+	//Movement queries only look for ECC_Platform: scenery stays off it whatever profile it was given, obstacles join it. Game worlds only, the editor shows the designer's settings.
+	if (!GetWorld() || !GetWorld()->IsGameWorld()) {
+		return;
+	}
+	TInlineComponentArray<UPrimitiveComponent*> Primitives(this);
+	for (UPrimitiveComponent* Primitive : Primitives) {
+		ECollisionChannel ObjectType = Primitive->GetCollisionObjectType();
+		if (!bBlocksMovementSystem && ObjectType == ECC_Platform) {
+			Primitive->SetCollisionObjectType(ECC_WorldStatic);
+		}else if (bBlocksMovementSystem && Primitive->IsCollisionEnabled() && (ObjectType == ECC_WorldStatic || ObjectType == ECC_WorldDynamic)) {
+			Primitive->SetCollisionObjectType(ECC_Platform);
+		}
+	}
+
+};
+
 // Called every frame
 void ANonPlatformMaster::Tick(float DeltaTime)
 {
@@ -18,7 +18,13 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Non Platform", meta = (Tooltip = "Should Transport, MoveAround and the visibility checks treat this as an obstacle? Off, its colliders are left out of every movement query (scenery)."))
+		bool bBlocksMovementSystem;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+
+	// Components were (re)registered, so their object type may need fixing up
+	virtual void PostRegisterAllComponents() override;
 };
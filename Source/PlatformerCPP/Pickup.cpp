@@ -11,6 +11,8 @@
 #include "DrawDebugHelpers.h"
 #include "DimenseCharacter.h"
 #include "DimensePlayerController.h"
+#include "PlatformerCPP.h"
+#include "PickupSubsystem.h"
 
 // Sets default values
 APickup::APickup(){
@@ -20,6 +22,7 @@ APickup::APickup(){
 	PickupBlockerObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_Pawn));
 	PickupBlockerObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldStatic));
 	PickupBlockerObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldDynamic));
+	PickupBlockerObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_Platform));
 	PickupBlockerIgnoreActors.Add(this);
 }
 
@@ -28,6 +31,47 @@ void APickup::BeginPlay(){
 	Super::BeginPlay();
 
 	PlayerReference = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	UpdatePickupBounds();
+	RefreshObstacleQuery();
+	if (UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>()) {
+		Pickups->RegisterPickup(this);
+	}
+	if (GetRootComponent()) {
+		GetRootComponent()->TransformUpdated.AddUObject(this, &APickup::OnRootTransformUpdated);
+	}
+}
+
+// Called when the pickup is destroyed or its level is unloaded
+void APickup::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	if (UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>()) {
+		Pickups->UnregisterPickup(this);
+	}
+	if (GetRootComponent()) {
+		GetRootComponent()->TransformUpdated.RemoveAll(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void APickup::OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport){
+	UpdatePickupBounds();
+	if (UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>()) {
+		Pickups->UpdatePickup(this);
+	}
+}
+
+void APickup::UpdatePickupBounds(){
+	FVector Origin;	FVector Extent;	GetActorBounds(true, Origin, Extent);
+	PickupBounds = FBox::BuildAABB(Origin, Extent);
+}
+
+void APickup::RefreshObstacleQuery(){
+	ObstacleObjectParams = FCollisionObjectQueryParams();
+	for (const TEnumAsByte<EObjectTypeQuery>& ObjectType : PickupBlockerObjectTypes) {
+		ObstacleObjectParams.AddObjectTypesToQuery(UEngineTypes::ConvertToCollisionChannel(ObjectType));
+	}
+	//Same as the Kismet box trace this replaces: simple collision, ignoring the pickup itself
+	ObstacleQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(PickupObstacleTrace), false, this);
+	ObstacleQueryParams.AddIgnoredActors(PickupBlockerIgnoreActors);
 }
 
 // Called every frame
@@ -37,17 +81,29 @@ void APickup::Tick(float DeltaTime){
 
 //Called when an object is hit by the player pickup trace to check if there are any objects in the way
 bool APickup::AttemptTraceBackToPlayer(){
-	if (BoxTraceForPickupObstacles(PickupHitResult)) {
-		if (Cast<ADimenseCharacter>(PickupHitResult.GetActor())) {
-			return true;
+	//Pickups near the player were already traced in the pickup subsystem's batch
+	UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>();
+	if (!Pickups || !Pickups->GetObstacleResult(this, PickupHitResult)) {
+		if (!BoxTraceForPickupObstacles(PickupHitResult)) {
+			return false;
 		}
 	}
+	if (Cast<ADimenseCharacter>(PickupHitResult.GetActor())) {
+		return true;
+	}
 	return false;
 }
 
 //Called by AttemptTraceBackToPlayer() to do the trace for the check of objects in the way
 bool APickup::BoxTraceForPickupObstacles(FHitResult &HitResult){
-	FVector Origin;	FVector Extent;	GetActorBounds(true, Origin, Extent);
+	DIMENSE_SCOPE(STAT_DimensePickupTrace, PickupObstacleTrace);
+	DIMENSE_COUNT_SWEEPS(1);
+	FVector Start; FVector End; FVector BoxExtent; GetObstacleSweep(Start, End, BoxExtent);
+	return GetWorld()->SweepSingleByObjectType(HitResult, Start, End, FQuat::Identity, ObstacleObjectParams, FCollisionShape::MakeBox(BoxExtent), ObstacleQueryParams);
+}
+
+void APickup::GetObstacleSweep(FVector& Start, FVector& End, FVector& BoxExtent) const{
+	FVector Extent = PickupBounds.GetExtent();
 	if (Extent.X > Extent.Y) {
 		Extent.Y = Extent.X;
 	}else {
@@ -55,13 +111,15 @@ bool APickup::BoxTraceForPickupObstacles(FHitResult &HitResult){
 	}
 	float Distance = GetHorizontalDistanceTo(PlayerReference);
 	int32 Direction;
-	if ((PlayerReference->GetActorLocation() - PlayerReference->MainCamera->GetComponentLocation()).Size() > (GetActorLocation() - PlayerReference->MainCamera->GetComponentLocation()).Size()) {
+	FVector CameraLocation = PlayerReference->MainCamera->GetComponentLocation();
+	if (FVector::DistSquared(PlayerReference->GetActorLocation(), CameraLocation) > FVector::DistSquared(GetActorLocation(), CameraLocation)) {
 		Direction = -1;
 	}else{
 		Direction = 1;
 	}
 	
 	FVector LineVector = PlayerReference->CamForwardVector * Distance * Direction;
-	FVector End = Origin - LineVector;
-	return UKismetSystemLibrary::BoxTraceSingleForObjects(GetWorld(), Origin, End, Extent, FRotator(0), PickupBlockerObjectTypes, false, PickupBlockerIgnoreActors, EDrawDebugTrace::None, HitResult, true, FLinearColor::Red, FLinearColor::Green, .01);
-}
\ No newline at end of file
+	Start = PickupBounds.GetCenter();
+	End = Start - LineVector;
+	BoxExtent = Extent;
+}
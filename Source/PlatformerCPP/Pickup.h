@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "CollisionQueryParams.h"
 #include "Pickup.generated.h"
 
 class UCameraComponent;
@@ -43,4 +44,31 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pickup Variables", meta = (AllowPrivateAccess = "true", Tooltip = "Actors to ignore during the trace back to the player from the pickup."))
 	TArray<AActor*> PickupBlockerIgnoreActors;
+
+	UFUNCTION(BlueprintCallable, Category = "Pickup Functions", meta = (Tooltip = "Rebuilds the trace back to the player from PickupBlockerObjectTypes and PickupBlockerIgnoreActors. Call after changing them at runtime."))
+	void RefreshObstacleQuery();
+
+	//Bounds taken on BeginPlay and whenever the root moves, what the pickup subsystem hashes and the obstacle trace starts from
+	const FBox& GetPickupBounds() const { return PickupBounds; }
+
+	//Box swept from the pickup back towards the player along the camera axis
+	void GetObstacleSweep(FVector& Start, FVector& End, FVector& BoxExtent) const;
+
+	const FCollisionObjectQueryParams& GetObstacleObjectParams() const { return ObstacleObjectParams; }
+	const FCollisionQueryParams& GetObstacleQueryParams() const { return ObstacleQueryParams; }
+
+protected:
+	// Called when the pickup is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Keeps the bounds and the pickup subsystem's cells in sync when the pickup moves (attached, animated, placed after spawning)
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+private:
+	void UpdatePickupBounds();
+
+	//Built once instead of on every trace
+	FBox PickupBounds;
+	FCollisionObjectQueryParams ObstacleObjectParams;
+	FCollisionQueryParams ObstacleQueryParams;
 };
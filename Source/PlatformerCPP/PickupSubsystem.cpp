@@ -0,0 +1,174 @@
+// Copyright 2020 Ryan Gourley
+
+#include "PickupSubsystem.h"
+#include "Engine/World.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "PlatformerCPP.h"
+#include "Pickup.h"
+#include "DimenseCharacter.h"
+
+UPickupSubsystem::UPickupSubsystem(){
+	NearbyRadius = 400.0f;
+	CellSize = 200.0f;
+}
+
+void UPickupSubsystem::RegisterPickup(APickup* Pickup){
+	if (!Pickup || RecordIds.Contains(Pickup)) {
+		return;
+	}
+	FPickupRecord Record;
+	Record.Pickup = Pickup;
+	Record.Bounds = Pickup->GetPickupBounds();
+	int32 Id = Records.Add(Record);
+	RecordIds.Add(Pickup, Id);
+	AddToCells(Id);
+}
+
+void UPickupSubsystem::UpdatePickup(APickup* Pickup){
+	int32* Id = RecordIds.Find(Pickup);
+	if (!Id) {
+		return;
+	}
+	RemoveFromCells(*Id);
+	Records[*Id].Bounds = Pickup->GetPickupBounds();
+	Records[*Id].ResultFrame = 0; //Traced from where it was, the next check traces again
+	AddToCells(*Id);
+}
+
+void UPickupSubsystem::UnregisterPickup(APickup* Pickup){
+	int32 Id;
+	if (!RecordIds.RemoveAndCopyValue(Pickup, Id)) {
+		return;
+	}
+	RemoveFromCells(Id);
+	InFlight.RemoveSwap(Id);
+	Records.RemoveAt(Id);
+}
+
+int32 UPickupSubsystem::GetNumPickups() const{
+	return Records.Num();
+}
+
+FIntPoint UPickupSubsystem::ToCell(const float Across, const float Z) const{
+	return FIntPoint(FMath::FloorToInt(Across / CellSize), FMath::FloorToInt(Z / CellSize));
+}
+
+void UPickupSubsystem::AddToCells(const int32 Id){
+	const FBox& Bounds = Records[Id].Bounds;
+	for (int32 AcrossAxis = 0; AcrossAxis < 2; AcrossAxis++) {
+		TMap<FIntPoint, TArray<int32>>& Cells = AcrossAxis == 1 ? CellsAlongX : CellsAlongY;
+		FIntPoint MinCell = ToCell(Bounds.Min[AcrossAxis], Bounds.Min.Z);
+		FIntPoint MaxCell = ToCell(Bounds.Max[AcrossAxis], Bounds.Max.Z);
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+				Cells.FindOrAdd(FIntPoint(X, Y)).Add(Id);
+			}
+		}
+	}
+}
+
+void UPickupSubsystem::RemoveFromCells(const int32 Id){
+	const FBox& Bounds = Records[Id].Bounds;
+	for (int32 AcrossAxis = 0; AcrossAxis < 2; AcrossAxis++) {
+		TMap<FIntPoint, TArray<int32>>& Cells = AcrossAxis == 1 ? CellsAlongX : CellsAlongY;
+		FIntPoint MinCell = ToCell(Bounds.Min[AcrossAxis], Bounds.Min.Z);
+		FIntPoint MaxCell = ToCell(Bounds.Max[AcrossAxis], Bounds.Max.Z);
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+				FIntPoint Key(X, Y);
+				TArray<int32>* Cell = Cells.Find(Key);
+				if (!Cell) {
+					continue;
+				}
+				Cell->RemoveSwap(Id);
+				if (Cell->Num() == 0) {
+					Cells.Remove(Key);
+				}
+			}
+		}
+	}
+}
+
+bool UPickupSubsystem::IsTickable() const{
+	return !HasAnyFlags(RF_ClassDefaultObject) && GetWorld() && GetWorld()->IsGameWorld() && Records.Num() > 0;
+}
+
+TStatId UPickupSubsystem::GetStatId() const{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupSubsystem, STATGROUP_Tickables);
+}
+
+void UPickupSubsystem::Tick(float DeltaTime){
+	DIMENSE_SCOPE(STAT_DimensePickupBatch, PickupBatch);
+	GatherResults();
+	SubmitNearby();
+}
+
+void UPickupSubsystem::GatherResults(){
+	FTraceDatum Datum;
+	for (int32 i = InFlight.Num() - 1; i >= 0; i--) {
+		FPickupRecord& Record = Records[InFlight[i]];
+		if (GetWorld()->QueryTraceData(Record.Handle, Datum)) {
+			Record.Result = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+			Record.ResultFrame = GFrameCounter;
+		}else if (GetWorld()->IsTraceHandleValid(Record.Handle, false)) {
+			continue; //Not run yet, the batch was queued after this frame's traces were kicked off
+		}
+		Record.Handle = FTraceHandle();
+		InFlight.RemoveAtSwap(i, 1, false);
+	}
+}
+
+void UPickupSubsystem::SubmitNearby(){
+	ADimenseCharacter* Player = Cast<ADimenseCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if (!Player || !Player->MainCamera) {
+		return;
+	}
+	//Everything within NearbyRadius on the 2D view, at any depth along the camera axis
+	int32 AcrossAxis = FMath::Abs(Player->CamForwardVector.X) > 0.5f ? 1 : 0;
+	const TMap<FIntPoint, TArray<int32>>& Cells = AcrossAxis == 1 ? CellsAlongX : CellsAlongY;
+	FVector PlayerLocation = Player->GetActorLocation();
+	FVector2D Projected(PlayerLocation[AcrossAxis], PlayerLocation.Z);
+	FIntPoint MinCell = ToCell(Projected.X - NearbyRadius, Projected.Y - NearbyRadius);
+	FIntPoint MaxCell = ToCell(Projected.X + NearbyRadius, Projected.Y + NearbyRadius);
+	Candidates.Reset();
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			if (const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y))) {
+				for (int32 Id : *Cell) {
+					Candidates.AddUnique(Id);
+				}
+			}
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_DimensePickupCandidates, Candidates.Num());
+
+	int32 Submitted = 0;
+	for (int32 Id : Candidates) {
+		FPickupRecord& Record = Records[Id];
+		APickup* Pickup = Record.Pickup.Get();
+		if (!Pickup || Record.Handle.IsValid()) {
+			continue;
+		}
+		FVector2D Closest = FBox2D(FVector2D(Record.Bounds.Min[AcrossAxis], Record.Bounds.Min.Z), FVector2D(Record.Bounds.Max[AcrossAxis], Record.Bounds.Max.Z)).GetClosestPointTo(Projected);
+		if (FVector2D::DistSquared(Closest, Projected) > FMath::Square(NearbyRadius)) {
+			continue;
+		}
+		FVector Start; FVector End; FVector BoxExtent;
+		Pickup->GetObstacleSweep(Start, End, BoxExtent);
+		Record.Handle = GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Single, Start, End, FQuat::Identity, Pickup->GetObstacleObjectParams(), FCollisionShape::MakeBox(BoxExtent), Pickup->GetObstacleQueryParams());
+		InFlight.Add(Id);
+		Submitted++;
+	}
+	DIMENSE_COUNT_SWEEPS(Submitted);
+	INC_DWORD_STAT_BY(STAT_DimenseAsyncProbes, Submitted);
+}
+
+bool UPickupSubsystem::GetObstacleResult(const APickup* Pickup, FHitResult& HitResult) const{
+	const int32* Id = RecordIds.Find(Pickup);
+	//Pickups tick before the subsystem, so the newest result was gathered last frame. Older than that and the player has moved on.
+	if (!Id || Records[*Id].ResultFrame == 0 || Records[*Id].ResultFrame + 2 < GFrameCounter) {
+		return false;
+	}
+	HitResult = Records[*Id].Result;
+	return true;
+}
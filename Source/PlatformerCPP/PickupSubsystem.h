@@ -0,0 +1,73 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "PickupSubsystem.generated.h"
+
+class APickup;
+
+/**
+ * Every APickup in the world, hashed by where it shows up on the 2D view: one grid over (Y, Z) for the cameras looking along X and
+ * one over (X, Z) for the cameras looking along Y.
+ * Each frame only the pickups within NearbyRadius of the player on the current view get their trace back to the player, and all of
+ * them go to the async trace API in one batch. APickup::AttemptTraceBackToPlayer then reads the batched answer instead of tracing.
+ * Like the movement probes, results are a frame or two old and anything without a fresh result falls back to a synchronous trace.
+ */
+UCLASS()
+class PLATFORMERCPP_API UPickupSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UPickupSubsystem();
+
+	//Pickups add themselves on BeginPlay and remove themselves on EndPlay
+	void RegisterPickup(APickup* Pickup);
+	void UnregisterPickup(APickup* Pickup);
+
+	UFUNCTION(BlueprintCallable, Category = "Pickup", meta = (Tooltip = "Rehashes a pickup at its current bounds. Pickups call it themselves when their root moves."))
+		void UpdatePickup(APickup* Pickup);
+
+	//Latest batched obstacle trace of Pickup, false if it wasn't near enough to be in a recent batch
+	bool GetObstacleResult(const APickup* Pickup, FHitResult& HitResult) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Pickup")
+		int32 GetNumPickups() const;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Pickup", meta = (Tooltip = "How far from the player, on the 2D view, a pickup's trace is batched."))
+		float NearbyRadius;
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FPickupRecord {
+		TWeakObjectPtr<APickup> Pickup;
+		FBox Bounds;
+		FTraceHandle Handle;
+		FHitResult Result;
+		uint64 ResultFrame = 0;
+	};
+
+	//Cell size of both grids
+	float CellSize;
+
+	TSparseArray<FPickupRecord> Records;
+	TMap<const APickup*, int32> RecordIds;
+	TMap<FIntPoint, TArray<int32>> CellsAlongX; //Keyed by (Y, Z), for cameras looking along X
+	TMap<FIntPoint, TArray<int32>> CellsAlongY; //Keyed by (X, Z), for cameras looking along Y
+	TArray<int32> InFlight;
+	TArray<int32> Candidates;
+
+	FIntPoint ToCell(const float Across, const float Z) const;
+	void AddToCells(const int32 Id);
+	void RemoveFromCells(const int32 Id);
+	void GatherResults();
+	void SubmitNearby();
+};
@@ -5,6 +5,13 @@
 #include "DrawDebugHelpers.h"
 #include "Engine/World.h"
 #include "Components/CapsuleComponent.h"
+#include "PlatformerCPP.h"
+#include "DimenseDebug.h"
+#include "PlatformProjectionSubsystem.h"
+#include "SurfacePlatformSubsystem.h"
+#include "PlatformQualitySubsystem.h"
+#include "SurfacePlatformComponent.h"
+#include "InstancedPlatformManager.h"
 
 // Sets default values
 APlatformMaster::APlatformMaster(){
@@ -18,6 +25,65 @@ APlatformMaster::APlatformMaster(){
 void APlatformMaster::BeginPlay(){
 	Super::BeginPlay();
 	PlayerReference = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	//Instance proxies are already in the index as their instance
+	UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>();
+	if (ProjectionIndex && InstanceIndex == INDEX_NONE) {
+		ProjectionIndex->RegisterPlatform(this);
+	}
+	if (UPlatformQualitySubsystem* Quality = GetWorld()->GetSubsystem<UPlatformQualitySubsystem>()) {
+		Quality->RegisterPlatform(this);
+	}
+	if (GetRootComponent()) {
+		GetRootComponent()->TransformUpdated.AddUObject(this, &APlatformMaster::OnRootTransformUpdated);
+	}
+}
+
+// Called when the platform is destroyed or its level is unloaded
+void APlatformMaster::EndPlay(const EEndPlayReason::Type EndPlayReason){
+	if (UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>()) {
+		ProjectionIndex->UnregisterPlatform(this);
+	}
+	if (UPlatformQualitySubsystem* Quality = GetWorld()->GetSubsystem<UPlatformQualitySubsystem>()) {
+		Quality->UnregisterPlatform(this);
+	}
+	if (GetRootComponent()) {
+		GetRootComponent()->TransformUpdated.RemoveAll(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+// Components were (re)registered, so the cached bounds may be stale
+void APlatformMaster::PostRegisterAllComponents(){
+	Super::PostRegisterAllComponents();
+	InvalidateBoundsCache();
+	UsePlatformObjectType();
+}
+
+void APlatformMaster::UsePlatformObjectType(){
+	//Game worlds only, the editor shows the settings the designer picked
+	if (!GetWorld() || !GetWorld()->IsGameWorld()) {
+		return;
+	}
+	TInlineComponentArray<UPrimitiveComponent*> Primitives(this);
+	for (UPrimitiveComponent* Primitive : Primitives) {
+		ECollisionChannel ObjectType = Primitive->GetCollisionObjectType();
+		if (Primitive->IsCollisionEnabled() && (ObjectType == ECC_WorldStatic || ObjectType == ECC_WorldDynamic)) {
+			Primitive->SetCollisionObjectType(ECC_Platform);
+		}
+	}
+}
+
+// Keeps the cached bounds, the projection index and the surface registry in sync when the platform moves
+void APlatformMaster::OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport){
+	InvalidateBoundsCache();
+	if (UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>()) {
+		ProjectionIndex->UpdatePlatform(this);
+	}
+	if (IsSurface()) {
+		if (USurfacePlatformSubsystem* Surfaces = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>()) {
+			Surfaces->UpdateSurface(this);
+		}
+	}
 }
 
 // Called every frame
@@ -25,31 +91,134 @@ void APlatformMaster::Tick(float DeltaTime){
 	Super::Tick(DeltaTime);
 }
 
-// Checks if there is another platform above this platform by tracing a box the width and height of the player from where the player will land
+// Checks if there is another platform above this platform in a box the width and height of the player from where the player will land
 bool APlatformMaster::PlatformAbovePlatformCheck(){
-	if(PlayerReference->bDebugPlatformRemote){
+	DIMENSE_SCOPE(STAT_DimensePlatformAbove, PlatformAbovePlatformCheck);
+	if (DIMENSE_DEBUG(PlatformRemote)) {
 		GEngine->AddOnScreenDebugMessage(-1, .2, FColor::Purple, (TEXT("Platform Above Platform Check")));
 	}
-	FVector Origin; FVector Extent; GetActorBounds(true, Origin, Extent);
+	FVector Origin; FVector Extent; GetCachedBounds(Origin, Extent);
 	FVector Offset = PlayerReference->GetActorLocation() + PlayerReference->GetTransportOffset(this);
-	FVector Start = FVector(Offset.X, Offset.Y, this->GetActorLocation().Z + (Extent.Z));
+	FVector Start = FVector(Offset.X, Offset.Y, GetTopZ());
 	FVector PlayerWidthPadding = FVector(5, 5, 0);
 	FVector PlayerHeightPadding = FVector(0, 0, 10);
 	FVector End = Start + FVector(0, 0, PlayerReference->MyHeight) + PlayerHeightPadding;
 	
 	FCollisionShape NewBox; NewBox.SetBox(FVector(PlayerReference->MyWidth / 2, PlayerReference->MyWidth / 2, 0)); //box trace, width of the player
-	GetWorld()->SweepSingleByChannel(AboveHitResult, Start, End, FRotator(0, 0, 0).Quaternion(), ECollisionChannel::ECC_WorldStatic, NewBox, QParams);
-	APlatformMaster* HitObject = Cast<APlatformMaster>(AboveHitResult.GetActor());
+	APlatformMaster* HitObject = nullptr;
+	UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>();
+	if (PlayerReference->bUsePlatformIndex && ProjectionIndex) {
+		//The headroom over the landing footprint was worked out when the platforms were registered
+		float Headroom;
+		FVector2D HalfSize = FVector2D(NewBox.GetExtent());
+		APlatformMaster* Above = ProjectionIndex->FindPlatformAbove(this, FBox2D(FVector2D(Start) - HalfSize, FVector2D(Start) + HalfSize), Headroom);
+		if (Headroom <= End.Z - Start.Z) {
+			HitObject = Above;
+		}
+		if (ProjectionIndex->bValidate) {
+			APlatformMaster* SweepObject = SweepForPlatformAbove(Start, End, NewBox);
+			if ((HitObject != nullptr) != (SweepObject != nullptr)) {
+				UE_LOG(LogDimense, Warning, TEXT("Headroom mismatch on %s: index %s (%.1f free), sweep %s"), *GetName(), *GetNameSafe(HitObject), Headroom, *GetNameSafe(SweepObject));
+			}
+		}
+	}else{
+		HitObject = SweepForPlatformAbove(Start, End, NewBox);
+	}
 	if (HitObject) { //&& HitObject->GetFullName() != this->GetFullName()) {
-		if (PlayerReference->bDebugPlatformRemote) {
+		if (DIMENSE_DEBUG(PlatformRemote)) {
 			DrawDebugBox(GetWorld(), Offset, FVector(PlayerReference->MyWidth / 2, PlayerReference->MyWidth / 2, PlayerReference->MyHeight / 2), FColor::Red, false, 1, 95, 5);
 			DrawDebugBox(GetWorld(), Origin, Extent, FColor::Purple, false, .5, 95, 10);
 		}
 		return true;
 	}
-	if (PlayerReference->bDebugPlatformRemote) {
+	if (DIMENSE_DEBUG(PlatformRemote)) {
 		DrawDebugBox(GetWorld(), Offset, FVector(PlayerReference->MyWidth / 2, PlayerReference->MyWidth / 2, PlayerReference->MyHeight / 2), FColor::Purple, false, 1, 95, 5);
 	}
 	return false;
 }
 
+APlatformMaster* APlatformMaster::SweepForPlatformAbove(const FVector& Start, const FVector& End, const FCollisionShape& Shape){
+	DIMENSE_COUNT_SWEEPS(1);
+	if (InstanceIndex == INDEX_NONE) {
+		GetWorld()->SweepSingleByObjectType(AboveHitResult, Start, End, FRotator(0, 0, 0).Quaternion(), FCollisionObjectQueryParams(ECC_Platform), Shape, QParams);
+		return FromHit(AboveHitResult);
+	}
+	//A proxy can't ignore its own instance in the query params, so skip it in the hits instead. Multi by object type reports every hit.
+	TArray<FHitResult> Hits;
+	GetWorld()->SweepMultiByObjectType(Hits, Start, End, FRotator(0, 0, 0).Quaternion(), FCollisionObjectQueryParams(ECC_Platform), Shape, QParams);
+	for (const FHitResult& Hit : Hits) {
+		if (Hit.GetComponent() == InstanceComponent.Get() && Hit.Item == InstanceIndex) {
+			continue;
+		}
+		AboveHitResult = Hit;
+		return FromHit(Hit);
+	}
+	AboveHitResult = FHitResult(Start, End);
+	return nullptr;
+}
+
+
+// World space bounds of the colliding components, only recomputed after the platform moved or its components changed
+const FBox& APlatformMaster::GetBounds() const{
+	DIMENSE_COUNT_BOUNDS_QUERIES(1);
+	if (!bBoundsCacheValid) {
+		INC_DWORD_STAT(STAT_DimenseBoundsRecomputes);
+		FVector Origin; FVector Extent; GetActorBounds(true, Origin, Extent);
+		CachedBounds = FBox::BuildAABB(Origin, Extent);
+		bBoundsCacheValid = true;
+	}
+	return CachedBounds;
+}
+
+void APlatformMaster::GetCachedBounds(FVector& Origin, FVector& Extent) const{
+	GetBounds().GetCenterAndExtents(Origin, Extent);
+}
+
+float APlatformMaster::GetTopZ() const{
+	return GetBounds().Max.Z;
+}
+
+void APlatformMaster::InvalidateBoundsCache(){
+	if (InstanceIndex == INDEX_NONE) {
+		bBoundsCacheValid = false;
+	}
+}
+
+void APlatformMaster::OnReleasedToPool(){
+	if (UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>()) {
+		ProjectionIndex->UnregisterPlatform(this);
+	}
+	if (USurfacePlatformSubsystem* Surfaces = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>()) {
+		Surfaces->UnregisterSurface(this);
+	}
+}
+
+void APlatformMaster::OnAcquiredFromPool(){
+	InvalidateBoundsCache();
+	//The surface component stayed on the pooled actor, it just doesn't see a second BeginPlay
+	USurfacePlatformSubsystem* Surfaces = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>();
+	if (Surfaces && FindComponentByClass<USurfacePlatformComponent>()) {
+		Surfaces->RegisterSurface(this);
+	}
+	if (UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>()) {
+		ProjectionIndex->RegisterPlatform(this);
+	}
+}
+
+APlatformMaster* APlatformMaster::FromHit(const FHitResult& HitResult){
+	AActor* Actor = HitResult.GetActor();
+	if (APlatformMaster* Platform = Cast<APlatformMaster>(Actor)) {
+		return Platform;
+	}
+	if (AInstancedPlatformManager* Manager = Cast<AInstancedPlatformManager>(Actor)) {
+		return Manager->GetInstancePlatform(HitResult.GetComponent(), HitResult.Item);
+	}
+	return nullptr;
+}
+
+void APlatformMaster::SetInstance(UPrimitiveComponent* Component, const int32 Instance, const FBox& Bounds){
+	InstanceComponent = Component;
+	InstanceIndex = Instance;
+	CachedBounds = Bounds;
+	bBoundsCacheValid = true;
+}
@@ -21,16 +21,72 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Checks if there is another platform above this platform by tracing a box the width and height of the player from where the player will land."))
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Checks if there is another platform above this platform, in a box the width and height of the player from where the player will land. Looked up in the precomputed headroom when the player uses the platform index, swept for otherwise."))
 		bool PlatformAbovePlatformCheck();
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "World space bounds of the colliding components. Cached until the platform moves or its components change."))
+		void GetCachedBounds(FVector& Origin, FVector& Extent) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "World space Z of the top surface (the top of the cached bounds)."))
+		float GetTopZ() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Can the player Transport onto this platform (does it have a USurfacePlatformComponent)?"))
+		bool IsSurface() const { return SurfaceId != INDEX_NONE; }
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Forces the cached bounds to be recomputed on the next read. Call after adding, removing or moving components at runtime."))
+		void InvalidateBoundsCache();
+
+	// Cached world space bounds of the colliding components
+	const FBox& GetBounds() const;
+
+	// Platform a hit landed on: the actor itself, or the proxy of the instance when it hit an AInstancedPlatformManager
+	static APlatformMaster* FromHit(const FHitResult& HitResult);
+
+	// UPlatformPoolSubsystem hooks: leave the projection index while pooled, rejoin it with fresh bounds when handed out again
+	void OnReleasedToPool();
+	void OnAcquiredFromPool();
+
+	// Makes this a proxy for an instanced platform: no components of its own, bounds fixed to the instance's
+	void SetInstance(UPrimitiveComponent* Component, const int32 Instance, const FBox& Bounds);
+
+	// Instanced mesh and instance this proxy stands in for, null and INDEX_NONE on regular platforms
+	UPrimitiveComponent* GetInstanceComponent() const { return InstanceComponent.Get(); }
+	int32 GetInstanceIndex() const { return InstanceIndex; }
+
+	// Id in USurfacePlatformSubsystem, INDEX_NONE when not a surface
+	int32 GetSurfaceId() const { return SurfaceId; }
 	
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the platform is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Components were (re)registered, so the cached bounds may be stale
+	virtual void PostRegisterAllComponents() override;
+
+	// Keeps the cached bounds and the projection index in sync when the platform moves
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
 public:
 	ADimenseCharacter* PlayerReference;
 	FHitResult AboveHitResult;
 	FName TraceTag;
 	FCollisionQueryParams QParams;	
+
+private:
+	friend class USurfacePlatformSubsystem;
+
+	// Colliders left on WorldStatic/WorldDynamic (custom collision instead of a Platform profile) become ECC_Platform, or the movement queries would not see them
+	void UsePlatformObjectType();
+
+	// First platform hit sweeping Shape from Start to End, never this platform
+	APlatformMaster* SweepForPlatformAbove(const FVector& Start, const FVector& End, const FCollisionShape& Shape);
+
+	mutable FBox CachedBounds;
+	mutable bool bBoundsCacheValid = false;
+	TWeakObjectPtr<UPrimitiveComponent> InstanceComponent;
+	int32 InstanceIndex = INDEX_NONE;
+	int32 SurfaceId = INDEX_NONE; //Set by USurfacePlatformSubsystem
 };
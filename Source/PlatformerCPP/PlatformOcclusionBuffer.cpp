@@ -0,0 +1,154 @@
+// Copyright 2020 Ryan Gourley
+
+#include "PlatformOcclusionBuffer.h"
+
+namespace {
+	//Row = min(Row, Depth), four pixels at a time
+	void MinRow(float* Row, const int32 Count, const float Depth){
+		const VectorRegister DepthVector = VectorSetFloat1(Depth);
+		int32 i = 0;
+		for (; i + 4 <= Count; i += 4) {
+			VectorStore(VectorMin(VectorLoad(Row + i), DepthVector), Row + i);
+		}
+		for (; i < Count; i++) {
+			Row[i] = FMath::Min(Row[i], Depth);
+		}
+	}
+
+	int32 FloorDiv(const int32 Value, const int32 Divisor){
+		return Value >= 0 ? Value / Divisor : (Value - Divisor + 1) / Divisor;
+	}
+}
+
+FPlatformOcclusionBuffer::FPlatformOcclusionBuffer(const float InPixelSize){
+	PixelSize = InPixelSize;
+}
+
+void FPlatformOcclusionBuffer::Reset(){
+	Tiles.Reset();
+}
+
+FIntPoint FPlatformOcclusionBuffer::GetTileOfPixel(const FIntPoint& Pixel){
+	return FIntPoint(FloorDiv(Pixel.X, TileSize), FloorDiv(Pixel.Y, TileSize));
+}
+
+FBox2D FPlatformOcclusionBuffer::GetTileRect(const FIntPoint& Tile) const{
+	FVector2D Min = FVector2D(Tile.X, Tile.Y) * TileSize * PixelSize;
+	return FBox2D(Min, Min + FVector2D(TileSize * PixelSize, TileSize * PixelSize));
+}
+
+bool FPlatformOcclusionBuffer::GetPixelRange(const FBox2D& Rect, FIntPoint& OutMin, FIntPoint& OutMax) const{
+	//Pixel i covers [i, i+1) * PixelSize and its center is (i + 0.5) * PixelSize
+	OutMin = FIntPoint(FMath::CeilToInt(Rect.Min.X / PixelSize - 0.5f), FMath::CeilToInt(Rect.Min.Y / PixelSize - 0.5f));
+	OutMax = FIntPoint(FMath::FloorToInt(Rect.Max.X / PixelSize - 0.5f), FMath::FloorToInt(Rect.Max.Y / PixelSize - 0.5f));
+	return OutMin.X <= OutMax.X && OutMin.Y <= OutMax.Y;
+}
+
+void FPlatformOcclusionBuffer::RasterizePixels(const FIntPoint& Tile, TArray<float>& Depths, const FIntPoint& PixelMin, const FIntPoint& PixelMax, const float Depth){
+	//Clip the pixel range to the tile, then run one row at a time over contiguous memory
+	FIntPoint TileOrigin = Tile * TileSize;
+	int32 X0 = FMath::Max(PixelMin.X - TileOrigin.X, 0);
+	int32 X1 = FMath::Min(PixelMax.X - TileOrigin.X, TileSize - 1);
+	int32 Y0 = FMath::Max(PixelMin.Y - TileOrigin.Y, 0);
+	int32 Y1 = FMath::Min(PixelMax.Y - TileOrigin.Y, TileSize - 1);
+	if (X0 > X1 || Y0 > Y1) {
+		return;
+	}
+	for (int32 Y = Y0; Y <= Y1; Y++) {
+		MinRow(Depths.GetData() + Y * TileSize + X0, X1 - X0 + 1, Depth);
+	}
+}
+
+void FPlatformOcclusionBuffer::RasterizeRect(const FBox2D& Rect, const float Depth){
+	FIntPoint PixelMin; FIntPoint PixelMax;
+	if (!GetPixelRange(Rect, PixelMin, PixelMax)) {
+		return;
+	}
+	FIntPoint TileMin = GetTileOfPixel(PixelMin);
+	FIntPoint TileMax = GetTileOfPixel(PixelMax);
+	for (int32 TileY = TileMin.Y; TileY <= TileMax.Y; TileY++) {
+		for (int32 TileX = TileMin.X; TileX <= TileMax.X; TileX++) {
+			FIntPoint Tile(TileX, TileY);
+			TArray<float>* Depths = Tiles.Find(Tile);
+			if (!Depths) {
+				Depths = &Tiles.Add(Tile);
+				Depths->Init(MAX_flt, TileSize * TileSize);
+			}
+			RasterizePixels(Tile, *Depths, PixelMin, PixelMax, Depth);
+		}
+	}
+}
+
+void FPlatformOcclusionBuffer::RasterizeRectInTile(const FIntPoint& Tile, const FBox2D& Rect, const float Depth){
+	FIntPoint PixelMin; FIntPoint PixelMax;
+	TArray<float>* Depths = Tiles.Find(Tile);
+	if (!Depths || !GetPixelRange(Rect, PixelMin, PixelMax)) {
+		return;
+	}
+	RasterizePixels(Tile, *Depths, PixelMin, PixelMax, Depth);
+}
+
+void FPlatformOcclusionBuffer::ClearTile(const FIntPoint& Tile){
+	if (TArray<float>* Depths = Tiles.Find(Tile)) {
+		Depths->Init(MAX_flt, TileSize * TileSize);
+	}
+}
+
+void FPlatformOcclusionBuffer::GetTilesOverlapping(const FBox2D& Rect, TArray<FIntPoint>& OutTiles) const{
+	FIntPoint PixelMin; FIntPoint PixelMax;
+	if (!GetPixelRange(Rect, PixelMin, PixelMax)) {
+		return;
+	}
+	FIntPoint TileMin = GetTileOfPixel(PixelMin);
+	FIntPoint TileMax = GetTileOfPixel(PixelMax);
+	for (int32 TileY = TileMin.Y; TileY <= TileMax.Y; TileY++) {
+		for (int32 TileX = TileMin.X; TileX <= TileMax.X; TileX++) {
+			if (Tiles.Contains(FIntPoint(TileX, TileY))) {
+				OutTiles.AddUnique(FIntPoint(TileX, TileY));
+			}
+		}
+	}
+}
+
+float FPlatformOcclusionBuffer::GetDepth(const FVector2D& Point) const{
+	FIntPoint Pixel(FMath::FloorToInt(Point.X / PixelSize), FMath::FloorToInt(Point.Y / PixelSize));
+	FIntPoint Tile = GetTileOfPixel(Pixel);
+	const TArray<float>* Depths = Tiles.Find(Tile);
+	if (!Depths) {
+		return MAX_flt;
+	}
+	FIntPoint Local = Pixel - Tile * TileSize;
+	return (*Depths)[Local.Y * TileSize + Local.X];
+}
+
+float FPlatformOcclusionBuffer::GetOccludedFraction(const FBox2D& Rect, const float Depth) const{
+	FIntPoint PixelMin; FIntPoint PixelMax;
+	if (!GetPixelRange(Rect, PixelMin, PixelMax)) {
+		return GetDepth(Rect.GetCenter()) < Depth ? 1.0f : 0.0f; //Smaller than a pixel
+	}
+	int32 Occluded = 0;
+	int32 Total = (PixelMax.X - PixelMin.X + 1) * (PixelMax.Y - PixelMin.Y + 1);
+	FIntPoint TileMin = GetTileOfPixel(PixelMin);
+	FIntPoint TileMax = GetTileOfPixel(PixelMax);
+	for (int32 TileY = TileMin.Y; TileY <= TileMax.Y; TileY++) {
+		for (int32 TileX = TileMin.X; TileX <= TileMax.X; TileX++) {
+			FIntPoint Tile(TileX, TileY);
+			const TArray<float>* Depths = Tiles.Find(Tile);
+			if (!Depths) {
+				continue;
+			}
+			FIntPoint TileOrigin = Tile * TileSize;
+			int32 X0 = FMath::Max(PixelMin.X - TileOrigin.X, 0);
+			int32 X1 = FMath::Min(PixelMax.X - TileOrigin.X, TileSize - 1);
+			int32 Y0 = FMath::Max(PixelMin.Y - TileOrigin.Y, 0);
+			int32 Y1 = FMath::Min(PixelMax.Y - TileOrigin.Y, TileSize - 1);
+			for (int32 Y = Y0; Y <= Y1; Y++) {
+				const float* Row = Depths->GetData() + Y * TileSize;
+				for (int32 X = X0; X <= X1; X++) {
+					Occluded += Row[X] < Depth ? 1 : 0;
+				}
+			}
+		}
+	}
+	return float(Occluded) / float(Total);
+}
@@ -0,0 +1,48 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Low resolution CPU depth buffer of a 2D (orthographic) view, storing the nearest platform depth per pixel.
+ * The projected plane is split into sparse tiles that are only allocated where platforms exist, so a level of any size only
+ * pays for the area it covers. Pixels are covered when their center is inside a rectangle.
+ */
+class PLATFORMERCPP_API FPlatformOcclusionBuffer
+{
+public:
+	static constexpr int32 TileSize = 32; //Pixels per tile side
+
+	explicit FPlatformOcclusionBuffer(const float InPixelSize = 12.5f);
+
+	//Keep the nearest depth of Rect (projected plane units) in every pixel it covers
+	void RasterizeRect(const FBox2D& Rect, const float Depth);
+
+	//Same as RasterizeRect, clipped to one tile (used when rebuilding tiles)
+	void RasterizeRectInTile(const FIntPoint& Tile, const FBox2D& Rect, const float Depth);
+
+	//Reset a tile to empty (no occluder) before it is rebuilt
+	void ClearTile(const FIntPoint& Tile);
+
+	//Tiles touched by Rect, used to find the tiles to rebuild after a platform moved or was removed
+	void GetTilesOverlapping(const FBox2D& Rect, TArray<FIntPoint>& OutTiles) const;
+	FBox2D GetTileRect(const FIntPoint& Tile) const;
+
+	//Nearest depth at Point, MAX_flt if nothing is there
+	float GetDepth(const FVector2D& Point) const;
+
+	//Fraction (0-1) of the pixels in Rect that have something nearer than Depth
+	float GetOccludedFraction(const FBox2D& Rect, const float Depth) const;
+
+	void Reset();
+
+private:
+	float PixelSize;
+	TMap<FIntPoint, TArray<float>> Tiles;
+
+	//Pixel range whose centers are inside Rect (inclusive), returns false if it covers no pixel
+	bool GetPixelRange(const FBox2D& Rect, FIntPoint& OutMin, FIntPoint& OutMax) const;
+	void RasterizePixels(const FIntPoint& Tile, TArray<float>& Depths, const FIntPoint& PixelMin, const FIntPoint& PixelMax, const float Depth);
+	static FIntPoint GetTileOfPixel(const FIntPoint& Pixel);
+};
@@ -0,0 +1,114 @@
+// Copyright 2020 Ryan Gourley
+
+#include "PlatformPoolSubsystem.h"
+#include "Runtime/Engine/Classes/Engine/World.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "PlatformerCPP.h"
+#include "PlatformMaster.h"
+#include "NonPlatformMaster.h"
+
+namespace {
+	//Where pooled actors wait, well below anything playable
+	const FVector PoolLocation(0.0f, 0.0f, -HALF_WORLD_MAX / 2);
+}
+
+UPlatformPoolSubsystem::UPlatformPoolSubsystem(){
+	Hits = 0;
+	Misses = 0;
+}
+
+bool UPlatformPoolSubsystem::CanPool(const UClass* Class){
+	return Class && (Class->IsChildOf(APlatformMaster::StaticClass()) || Class->IsChildOf(ANonPlatformMaster::StaticClass()));
+}
+
+AActor* UPlatformPoolSubsystem::Acquire(TSubclassOf<AActor> Class, const FTransform& Transform){
+	if (!CanPool(Class)) {
+		UE_LOG(LogDimense, Error, TEXT("Platform pool only takes APlatformMaster and ANonPlatformMaster classes, not %s"), *GetNameSafe(Class));
+		return nullptr;
+	}
+	FPlatformPool* Pool = Pools.Find(Class);
+	while (Pool && Pool->Free.Num() > 0) {
+		AActor* Actor = Pool->Free.Pop(false);
+		if (IsValid(Actor)) {
+			Hits++;
+			INC_DWORD_STAT(STAT_DimensePoolHits);
+			Activate(Actor, Transform);
+			return Actor;
+		}
+	}
+	Misses++;
+	INC_DWORD_STAT(STAT_DimensePoolMisses);
+	return SpawnPooled(Class, Transform);
+}
+
+void UPlatformPoolSubsystem::Release(AActor* Actor){
+	if (!IsValid(Actor) || !CanPool(Actor->GetClass())) {
+		return;
+	}
+	FPlatformPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	//Releasing twice would hand the same actor out twice
+	checkSlow(!Pool.Free.Contains(Actor));
+	Deactivate(Actor);
+	Pool.Free.Add(Actor);
+}
+
+void UPlatformPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, const int32 Count){
+	if (!CanPool(Class)) {
+		return;
+	}
+	FPlatformPool& Pool = Pools.FindOrAdd(Class);
+	Pool.Free.Reserve(Count);
+	int32 Missing = Count - Pool.Free.Num();
+	FTransform Transform(PoolLocation);
+	for (int32 i = 0; i < Missing; i++) {
+		AActor* Actor = SpawnPooled(Class, Transform);
+		if (!Actor) {
+			return;
+		}
+		Deactivate(Actor);
+		//Find the pool again, spawning runs Blueprint code that may have added pools
+		Pools.FindOrAdd(Class).Free.Add(Actor);
+	}
+}
+
+int32 UPlatformPoolSubsystem::GetNumPooled(TSubclassOf<AActor> Class) const{
+	const FPlatformPool* Pool = Pools.Find(Class);
+	return Pool ? Pool->Free.Num() : 0;
+}
+
+float UPlatformPoolSubsystem::GetHitRate() const{
+	int64 Acquires = Hits + Misses;
+	return Acquires > 0 ? float(double(Hits) / double(Acquires)) : 0.0f;
+}
+
+void UPlatformPoolSubsystem::ResetStats(){
+	Hits = 0;
+	Misses = 0;
+}
+
+AActor* UPlatformPoolSubsystem::SpawnPooled(UClass* Class, const FTransform& Transform){
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AActor>(Class, Transform, Params);
+}
+
+void UPlatformPoolSubsystem::Deactivate(AActor* Actor){
+	//Out of the index first, so parking it doesn't reindex it
+	if (APlatformMaster* Platform = Cast<APlatformMaster>(Actor)) {
+		Platform->OnReleasedToPool();
+	}
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->SetActorLocation(PoolLocation, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void UPlatformPoolSubsystem::Activate(AActor* Actor, const FTransform& Transform){
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	if (APlatformMaster* Platform = Cast<APlatformMaster>(Actor)) {
+		Platform->OnAcquiredFromPool();
+	}
+}
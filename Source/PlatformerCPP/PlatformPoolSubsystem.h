@@ -0,0 +1,60 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlatformPoolSubsystem.generated.h"
+
+USTRUCT()
+struct FPlatformPool {
+	GENERATED_BODY()
+
+	UPROPERTY()
+		TArray<AActor*> Free;
+};
+
+/**
+ * Recycles APlatformMaster and ANonPlatformMaster actors instead of spawning and destroying them.
+ * A released actor is hidden, has its collision and tick turned off, leaves the projection index and is parked below the world;
+ * acquiring it moves it to the new transform and turns everything back on. Components, physics bodies and the actor itself are
+ * kept, so once a pool is warm acquiring and releasing doesn't allocate.
+ */
+UCLASS()
+class PLATFORMERCPP_API UPlatformPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPlatformPoolSubsystem();
+
+	UFUNCTION(BlueprintCallable, Category = "Platform Pool", meta = (DeterminesOutputType = "Class", Tooltip = "Takes a pooled actor of exactly this class and moves it to Transform, or spawns one when the pool is empty."))
+		AActor* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform Pool", meta = (Tooltip = "Deactivates the actor and keeps it for the next Acquire of its class."))
+		void Release(AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform Pool", meta = (Tooltip = "Spawns actors into the pool until it holds at least Count of this class, ahead of when they are needed."))
+		void Prewarm(TSubclassOf<AActor> Class, const int32 Count);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform Pool")
+		int32 GetNumPooled(TSubclassOf<AActor> Class) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform Pool", meta = (Tooltip = "Fraction (0-1) of Acquire calls served from the pool since the last reset."))
+		float GetHitRate() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform Pool")
+		void ResetStats();
+
+private:
+	UPROPERTY()
+		TMap<UClass*, FPlatformPool> Pools;
+
+	int64 Hits;
+	int64 Misses;
+
+	static bool CanPool(const UClass* Class);
+	AActor* SpawnPooled(UClass* Class, const FTransform& Transform);
+	void Deactivate(AActor* Actor);
+	void Activate(AActor* Actor, const FTransform& Transform);
+};
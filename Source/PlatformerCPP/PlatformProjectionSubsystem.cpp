@@ -0,0 +1,453 @@
+// Copyright 2020 Ryan Gourley
+
+#include "PlatformProjectionSubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "Components/PrimitiveComponent.h"
+#include "PlatformMaster.h"
+#include "InstancedPlatformManager.h"
+
+UPlatformProjectionSubsystem::UPlatformProjectionSubsystem(){
+	bValidate = false;
+	CellSize = 200.0f;
+	IndexedBounds = FBox(ForceInit);
+}
+
+void UPlatformProjectionSubsystem::RegisterPlatform(APlatformMaster* Platform){
+	if (!Platform || RecordIds.Contains(Platform)) {
+		return;
+	}
+	FPlatformRecord Record;
+	Record.Platform = Platform;
+	Record.Bounds = Platform->GetBounds();
+	Record.bSurface = Platform->IsSurface();
+	int32 Id = Records.Add(Record);
+	RecordIds.Add(Platform, Id);
+	AddToViews(Id);
+	AddToHeadroom(Id);
+}
+
+void UPlatformProjectionSubsystem::UpdatePlatform(APlatformMaster* Platform){
+	int32* Id = RecordIds.Find(Platform);
+	if (!Id) {
+		return;
+	}
+	const FBox& Bounds = Platform->GetBounds();
+	if (Bounds == Records[*Id].Bounds) {
+		return;
+	}
+	RemoveFromViews(*Id);
+	RemoveFromHeadroom(*Id);
+	Records[*Id].Bounds = Bounds;
+	AddToViews(*Id);
+	AddToHeadroom(*Id);
+}
+
+void UPlatformProjectionSubsystem::UnregisterPlatform(APlatformMaster* Platform){
+	int32 Id;
+	if (!RecordIds.RemoveAndCopyValue(Platform, Id)) {
+		return;
+	}
+	RemoveFromViews(Id);
+	RemoveFromHeadroom(Id);
+	Records.RemoveAt(Id);
+}
+
+void UPlatformProjectionSubsystem::RegisterInstance(UPrimitiveComponent* Component, const int32 Instance, const FBox& Bounds, const bool bSurface){
+	TPair<const UPrimitiveComponent*, int32> Key(Component, Instance);
+	if (!Component || InstanceRecordIds.Contains(Key)) {
+		return;
+	}
+	FPlatformRecord Record;
+	Record.Component = Component;
+	Record.Instance = Instance;
+	Record.Bounds = Bounds;
+	Record.bSurface = bSurface;
+	int32 Id = Records.Add(Record);
+	InstanceRecordIds.Add(Key, Id);
+	AddToViews(Id);
+	AddToHeadroom(Id);
+}
+
+void UPlatformProjectionSubsystem::UnregisterInstance(UPrimitiveComponent* Component, const int32 Instance){
+	int32 Id;
+	if (!InstanceRecordIds.RemoveAndCopyValue(TPair<const UPrimitiveComponent*, int32>(Component, Instance), Id)) {
+		return;
+	}
+	RemoveFromViews(Id);
+	RemoveFromHeadroom(Id);
+	Records.RemoveAt(Id);
+}
+
+int32 UPlatformProjectionSubsystem::FindRecordId(const APlatformMaster* Platform) const{
+	//Instance proxies aren't registered themselves, their instance is
+	const int32* Id = Platform && Platform->GetInstanceIndex() != INDEX_NONE
+		? InstanceRecordIds.Find(TPair<const UPrimitiveComponent*, int32>(Platform->GetInstanceComponent(), Platform->GetInstanceIndex()))
+		: RecordIds.Find(Platform);
+	return Id ? *Id : INDEX_NONE;
+}
+
+APlatformMaster* UPlatformProjectionSubsystem::GetRecordPlatform(const int32 Id) const{
+	const FPlatformRecord& Record = Records[Id];
+	if (Record.Instance == INDEX_NONE) {
+		return Record.Platform.Get();
+	}
+	UPrimitiveComponent* Component = Record.Component.Get();
+	AInstancedPlatformManager* Manager = Component ? Cast<AInstancedPlatformManager>(Component->GetOwner()) : nullptr;
+	return Manager ? Manager->GetInstancePlatform(Component, Record.Instance) : nullptr;
+}
+
+int32 UPlatformProjectionSubsystem::GetNumPlatforms() const{
+	return Records.Num();
+}
+
+FIntPoint UPlatformProjectionSubsystem::ToCell(const float Across, const float Z) const{
+	return FIntPoint(FMath::FloorToInt(Across / CellSize), FMath::FloorToInt(Z / CellSize));
+}
+
+int32 UPlatformProjectionSubsystem::GetViewForDirection(const FVector& Direction){
+	int32 Axis = FMath::Abs(Direction.X) >= FMath::Abs(Direction.Y) ? 0 : 1;
+	return Axis * 2 + (Direction[Axis] >= 0.0f ? 0 : 1);
+}
+
+FBox2D UPlatformProjectionSubsystem::GetProjectedRect(const FBox& Bounds, const int32 View) const{
+	int32 AcrossAxis = 1 - GetViewAxis(View);
+	return FBox2D(FVector2D(Bounds.Min[AcrossAxis], Bounds.Min.Z), FVector2D(Bounds.Max[AcrossAxis], Bounds.Max.Z));
+}
+
+void UPlatformProjectionSubsystem::AddToViews(const int32 Id){
+	const FBox& Bounds = Records[Id].Bounds;
+	IndexedBounds += Bounds;
+	for (int32 View = 0; View < NumViews; View++) {
+		int32 Axis = GetViewAxis(View);
+		int32 AcrossAxis = 1 - Axis;
+		float Sign = GetViewSign(View);
+		FCellEntry Entry;
+		Entry.Id = Id;
+		Entry.Near = Sign > 0.0f ? Bounds.Min[Axis] : -Bounds.Max[Axis];
+		Entry.Far = Sign > 0.0f ? Bounds.Max[Axis] : -Bounds.Min[Axis];
+		FIntPoint MinCell = ToCell(Bounds.Min[AcrossAxis], Bounds.Min.Z);
+		FIntPoint MaxCell = ToCell(Bounds.Max[AcrossAxis], Bounds.Max.Z);
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+				//Keep each cell sorted by the near face so lookups can stop at the first overlap
+				TArray<FCellEntry>& Cell = Views[View].Cells.FindOrAdd(FIntPoint(X, Y));
+				int32 Insert = Algo::UpperBoundBy(Cell, Entry.Near, &FCellEntry::Near);
+				Cell.Insert(Entry, Insert);
+			}
+		}
+		Views[View].Occlusion.RasterizeRect(GetProjectedRect(Bounds, View), Entry.Near);
+	}
+}
+
+void UPlatformProjectionSubsystem::RemoveFromViews(const int32 Id){
+	const FBox& Bounds = Records[Id].Bounds;
+	for (int32 View = 0; View < NumViews; View++) {
+		int32 AcrossAxis = 1 - GetViewAxis(View);
+		FIntPoint MinCell = ToCell(Bounds.Min[AcrossAxis], Bounds.Min.Z);
+		FIntPoint MaxCell = ToCell(Bounds.Max[AcrossAxis], Bounds.Max.Z);
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+				FIntPoint Key(X, Y);
+				TArray<FCellEntry>* Cell = Views[View].Cells.Find(Key);
+				if (!Cell) {
+					continue;
+				}
+				Cell->RemoveAll([Id](const FCellEntry& Entry) { return Entry.Id == Id; });
+				if (Cell->Num() == 0) {
+					Views[View].Cells.Remove(Key);
+				}
+			}
+		}
+		//A min-depth buffer can't subtract, so the tiles under the old rect are rebuilt from what is left in the cells
+		TArray<FIntPoint> DirtyTiles;
+		Views[View].Occlusion.GetTilesOverlapping(GetProjectedRect(Bounds, View), DirtyTiles);
+		for (const FIntPoint& Tile : DirtyTiles) {
+			RebuildOcclusionTile(View, Tile);
+		}
+	}
+}
+
+void UPlatformProjectionSubsystem::RebuildOcclusionTile(const int32 View, const FIntPoint& Tile){
+	FPlatformOcclusionBuffer& Occlusion = Views[View].Occlusion;
+	int32 AcrossAxis = 1 - GetViewAxis(View);
+	FBox2D TileRect = Occlusion.GetTileRect(Tile);
+	Occlusion.ClearTile(Tile);
+	FIntPoint MinCell = ToCell(TileRect.Min.X, TileRect.Min.Y);
+	FIntPoint MaxCell = ToCell(TileRect.Max.X, TileRect.Max.Y);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			const TArray<FCellEntry>* Cell = Views[View].Cells.Find(FIntPoint(X, Y));
+			if (!Cell) {
+				continue;
+			}
+			//Platforms spanning several cells get drawn more than once, which a min-depth write doesn't mind
+			for (const FCellEntry& Entry : *Cell) {
+				Occlusion.RasterizeRectInTile(Tile, GetProjectedRect(Records[Entry.Id].Bounds, View), Entry.Near);
+			}
+		}
+	}
+}
+
+bool UPlatformProjectionSubsystem::OverlapsXY(const FBox& A, const FBox& B){
+	return A.Min.X < B.Max.X && A.Max.X > B.Min.X && A.Min.Y < B.Max.Y && A.Max.Y > B.Min.Y;
+}
+
+void UPlatformProjectionSubsystem::AddToHeadroom(const int32 Id){
+	const FBox& Bounds = Records[Id].Bounds;
+	FIntPoint MinCell = ToCell(Bounds.Min.X, Bounds.Min.Y);
+	FIntPoint MaxCell = ToCell(Bounds.Max.X, Bounds.Max.Y);
+	TArray<int32> Stacked;
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			TArray<int32>& Cell = TopDownCells.FindOrAdd(FIntPoint(X, Y));
+			for (int32 Other : Cell) {
+				if (OverlapsXY(Bounds, Records[Other].Bounds)) {
+					Stacked.AddUnique(Other);
+				}
+			}
+			Cell.Add(Id);
+		}
+	}
+	//Anything reaching above a top face takes headroom from it, so a pair can be a span on both (interpenetrating platforms)
+	for (int32 Other : Stacked) {
+		const FBox& OtherBounds = Records[Other].Bounds;
+		if (OtherBounds.Max.Z > Bounds.Max.Z) {
+			Records[Id].Headroom.Add({ Other, GetFootprint(OtherBounds), FMath::Max(OtherBounds.Min.Z - Bounds.Max.Z, 0.0f) });
+		}
+		if (Bounds.Max.Z > OtherBounds.Max.Z) {
+			Records[Other].Headroom.Add({ Id, GetFootprint(Bounds), FMath::Max(Bounds.Min.Z - OtherBounds.Max.Z, 0.0f) });
+		}
+	}
+}
+
+void UPlatformProjectionSubsystem::RemoveFromHeadroom(const int32 Id){
+	const FBox& Bounds = Records[Id].Bounds;
+	FIntPoint MinCell = ToCell(Bounds.Min.X, Bounds.Min.Y);
+	FIntPoint MaxCell = ToCell(Bounds.Max.X, Bounds.Max.Y);
+	TArray<int32> Stacked;
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			FIntPoint Key(X, Y);
+			TArray<int32>* Cell = TopDownCells.Find(Key);
+			if (!Cell) {
+				continue;
+			}
+			Cell->RemoveSwap(Id);
+			for (int32 Other : *Cell) {
+				Stacked.AddUnique(Other);
+			}
+			if (Cell->Num() == 0) {
+				TopDownCells.Remove(Key);
+			}
+		}
+	}
+	for (int32 Other : Stacked) {
+		Records[Other].Headroom.RemoveAllSwap([Id](const FHeadroomSpan& Span) { return Span.Id == Id; });
+	}
+	Records[Id].Headroom.Reset();
+}
+
+APlatformMaster* UPlatformProjectionSubsystem::FindPlatformAbove(const APlatformMaster* Platform, const FBox2D& Footprint, float& OutHeadroom) const{
+	OutHeadroom = MAX_flt;
+	int32 Id = FindRecordId(Platform);
+	if (Id == INDEX_NONE) {
+		return nullptr;
+	}
+	int32 Lowest = FindLowestSpan(Id, Footprint, OutHeadroom);
+	return Lowest == INDEX_NONE ? nullptr : GetRecordPlatform(Lowest);
+}
+
+int32 UPlatformProjectionSubsystem::FindLowestSpan(const int32 Id, const FBox2D& Footprint, float& OutHeadroom) const{
+	OutHeadroom = MAX_flt;
+	int32 Lowest = INDEX_NONE;
+	for (const FHeadroomSpan& Span : Records[Id].Headroom) {
+		if (Span.Clearance < OutHeadroom && Span.Rect.Min.X < Footprint.Max.X && Span.Rect.Max.X > Footprint.Min.X && Span.Rect.Min.Y < Footprint.Max.Y && Span.Rect.Max.Y > Footprint.Min.Y) {
+			OutHeadroom = Span.Clearance;
+			Lowest = Span.Id;
+		}
+	}
+	return Lowest;
+}
+
+float UPlatformProjectionSubsystem::GetHeadroom(const APlatformMaster* Platform, const FVector2D& Center, const FVector2D& HalfSize) const{
+	float Headroom;
+	FindPlatformAbove(Platform, FBox2D(Center - HalfSize, Center + HalfSize), Headroom);
+	return Headroom;
+}
+
+bool UPlatformProjectionSubsystem::IsOccludedAlongAxis(const FVector& ViewDirection, const FVector& Point) const{
+	int32 View = GetViewForDirection(ViewDirection);
+	int32 Axis = GetViewAxis(View);
+	float Depth = Point[Axis] * GetViewSign(View);
+	return Views[View].Occlusion.GetDepth(FVector2D(Point[1 - Axis], Point.Z)) < Depth;
+}
+
+float UPlatformProjectionSubsystem::GetOccludedFraction(const FVector& ViewDirection, const FVector& Center, const FVector2D& HalfSize) const{
+	int32 View = GetViewForDirection(ViewDirection);
+	int32 Axis = GetViewAxis(View);
+	FVector2D Projected(Center[1 - Axis], Center.Z);
+	return Views[View].Occlusion.GetOccludedFraction(FBox2D(Projected - HalfSize, Projected + HalfSize), Center[Axis] * GetViewSign(View));
+}
+
+int32 UPlatformProjectionSubsystem::FindFirstAlongAxis(const FVector& Start, const FVector& End, const FVector& BoxExtent, float& OutDepth) const{
+	FVector Delta = End - Start;
+	int32 Axis = FMath::Abs(Delta.X) >= FMath::Abs(Delta.Y) ? 0 : 1;
+	int32 AcrossAxis = 1 - Axis;
+	if (FMath::IsNearlyZero(Delta[Axis])) {
+		return INDEX_NONE;
+	}
+	float Sign = FMath::Sign(Delta[Axis]);
+	int32 View = Axis * 2 + (Sign > 0.0f ? 0 : 1);
+
+	//Everything in the view's depth space: the box front face starts at StartDepth + BoxExtent and travels to EndDepth + BoxExtent
+	float StartDepth = Start[Axis] * Sign;
+	float EndDepth = End[Axis] * Sign;
+	float AlongExtent = BoxExtent[Axis];
+	float AcrossMin = Start[AcrossAxis] - BoxExtent[AcrossAxis];
+	float AcrossMax = Start[AcrossAxis] + BoxExtent[AcrossAxis];
+	float ZMin = Start.Z - BoxExtent.Z;
+	float ZMax = Start.Z + BoxExtent.Z;
+
+	int32 BestId = INDEX_NONE;
+	float BestDepth = EndDepth;
+	FIntPoint MinCell = ToCell(AcrossMin, ZMin);
+	FIntPoint MaxCell = ToCell(AcrossMax, ZMax);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			const TArray<FCellEntry>* Cell = Views[View].Cells.Find(FIntPoint(X, Y));
+			if (!Cell) {
+				continue;
+			}
+			for (const FCellEntry& Entry : *Cell) {
+				float HitDepth = FMath::Max(Entry.Near - AlongExtent, StartDepth);
+				if (HitDepth >= BestDepth) {
+					break; //Sorted by Near, nothing later in this cell can be closer
+				}
+				if (Entry.Far + AlongExtent <= StartDepth) {
+					continue; //Behind the start of the sweep
+				}
+				const FBox& Bounds = Records[Entry.Id].Bounds;
+				if (Bounds.Min[AcrossAxis] < AcrossMax && Bounds.Max[AcrossAxis] > AcrossMin && Bounds.Min.Z < ZMax && Bounds.Max.Z > ZMin) {
+					BestId = Entry.Id;
+					BestDepth = HitDepth;
+					break;
+				}
+			}
+		}
+	}
+	OutDepth = BestDepth;
+	return BestId;
+}
+
+bool UPlatformProjectionSubsystem::SweepAlongAxis(const FVector& Start, const FVector& End, const FVector& BoxExtent, FHitResult& HitResult) const{
+	HitResult = FHitResult(Start, End);
+	float BestDepth;
+	int32 BestId = FindFirstAlongAxis(Start, End, BoxExtent, BestDepth);
+	if (BestId == INDEX_NONE) {
+		return false;
+	}
+	FVector Delta = End - Start;
+	int32 Axis = FMath::Abs(Delta.X) >= FMath::Abs(Delta.Y) ? 0 : 1;
+	float Sign = FMath::Sign(Delta[Axis]);
+	float StartDepth = Start[Axis] * Sign;
+	float EndDepth = End[Axis] * Sign;
+	float AlongExtent = BoxExtent[Axis];
+
+	//Fill the hit the same way a sweep would: Location is the box center at impact, ImpactPoint is on the platform's near face
+	//Instances hit their manager's mesh with the instance as the Item, like a physics hit on an instanced mesh does
+	const FPlatformRecord& Record = Records[BestId];
+	UPrimitiveComponent* Component = Record.Instance == INDEX_NONE ? (Record.Platform.IsValid() ? Cast<UPrimitiveComponent>(Record.Platform->GetRootComponent()) : nullptr) : Record.Component.Get();
+	AActor* Actor = Record.Instance == INDEX_NONE ? Record.Platform.Get() : (Component ? Component->GetOwner() : nullptr);
+	if (!Actor) {
+		return false;
+	}
+	FVector Location = Start;
+	Location[Axis] = BestDepth * Sign;
+	FVector Normal = FVector::ZeroVector;
+	Normal[Axis] = -Sign;
+	HitResult = FHitResult(Actor, Component, Location, Normal);
+	HitResult.Item = Record.Instance;
+	HitResult.ImpactPoint[Axis] = (BestDepth + AlongExtent) * Sign;
+	HitResult.bBlockingHit = true;
+	HitResult.Time = (BestDepth - StartDepth) / (EndDepth - StartDepth);
+	HitResult.Distance = BestDepth - StartDepth;
+	HitResult.TraceStart = Start;
+	HitResult.TraceEnd = End;
+	return true;
+}
+
+void UPlatformProjectionSubsystem::FillIndexHit(const int32 Id, FPlatformIndexHit& OutHit) const{
+	OutHit.Id = Id;
+	OutHit.Bounds = Records[Id].Bounds;
+	OutHit.bSurface = Records[Id].bSurface;
+}
+
+bool UPlatformProjectionSubsystem::SweepBoundsAlongAxis(const FVector& Start, const FVector& End, const FVector& BoxExtent, FPlatformIndexHit& OutHit) const{
+	float BestDepth;
+	int32 BestId = FindFirstAlongAxis(Start, End, BoxExtent, BestDepth);
+	if (BestId == INDEX_NONE) {
+		return false;
+	}
+	FVector Delta = End - Start;
+	int32 Axis = FMath::Abs(Delta.X) >= FMath::Abs(Delta.Y) ? 0 : 1;
+	FillIndexHit(BestId, OutHit);
+	OutHit.Location = Start;
+	OutHit.Location[Axis] = BestDepth * FMath::Sign(Delta[Axis]);
+	return true;
+}
+
+int32 UPlatformProjectionSubsystem::FindInColumn(const FBox2D& Footprint, const float MinZ, const float MaxZ, const bool bHighestTop) const{
+	int32 BestId = INDEX_NONE;
+	float BestZ = bHighestTop ? -MAX_flt : MAX_flt;
+	FIntPoint MinCell = ToCell(Footprint.Min.X, Footprint.Min.Y);
+	FIntPoint MaxCell = ToCell(Footprint.Max.X, Footprint.Max.Y);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			const TArray<int32>* Cell = TopDownCells.Find(FIntPoint(X, Y));
+			if (!Cell) {
+				continue;
+			}
+			for (int32 Id : *Cell) {
+				const FBox& Bounds = Records[Id].Bounds;
+				float Z = bHighestTop ? Bounds.Max.Z : Bounds.Min.Z;
+				if (Z < MinZ || Z > MaxZ || (bHighestTop ? Z <= BestZ : Z >= BestZ)) {
+					continue;
+				}
+				if (Bounds.Min.X < Footprint.Max.X && Bounds.Max.X > Footprint.Min.X && Bounds.Min.Y < Footprint.Max.Y && Bounds.Max.Y > Footprint.Min.Y) {
+					BestId = Id;
+					BestZ = Z;
+				}
+			}
+		}
+	}
+	return BestId;
+}
+
+bool UPlatformProjectionSubsystem::FindGroundBelow(const FBox2D& Footprint, const float MinZ, const float MaxZ, FPlatformIndexHit& OutHit) const{
+	int32 Id = FindInColumn(Footprint, MinZ, MaxZ, true);
+	if (Id == INDEX_NONE) {
+		return false;
+	}
+	FillIndexHit(Id, OutHit);
+	OutHit.Location = FVector(Footprint.GetCenter(), OutHit.Bounds.Max.Z);
+	return true;
+}
+
+bool UPlatformProjectionSubsystem::FindCeilingAbove(const FBox2D& Footprint, const float MinZ, const float MaxZ, FPlatformIndexHit& OutHit) const{
+	int32 Id = FindInColumn(Footprint, MinZ, MaxZ, false);
+	if (Id == INDEX_NONE) {
+		return false;
+	}
+	FillIndexHit(Id, OutHit);
+	OutHit.Location = FVector(Footprint.GetCenter(), OutHit.Bounds.Min.Z);
+	return true;
+}
+
+float UPlatformProjectionSubsystem::GetHeadroomOf(const int32 Id, const FBox2D& Footprint) const{
+	if (!Records.IsValidIndex(Id)) {
+		return MAX_flt;
+	}
+	float Headroom;
+	FindLowestSpan(Id, Footprint, Headroom);
+	return Headroom;
+}
@@ -0,0 +1,147 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlatformOcclusionBuffer.h"
+#include "PlatformProjectionSubsystem.generated.h"
+
+class APlatformMaster;
+
+//What the plain data queries return instead of an FHitResult, nothing in it points at a UObject
+struct FPlatformIndexHit {
+	int32 Id = INDEX_NONE;
+	FBox Bounds;
+	FVector Location; //Box center at impact for sweeps, like FHitResult::Location
+	bool bSurface = false; //Has a USurfacePlatformComponent, the only platforms Transport lands on
+};
+
+/**
+ * Index of every APlatformMaster's bounds as seen from each of the four 90 degree camera orientations.
+ * Each orientation keeps a grid over the projected plane (the horizontal axis across the camera and Z), and every grid cell keeps
+ * its platforms sorted by their near face along the camera axis, so "first platform along the camera axis under this footprint"
+ * is a cell walk instead of a physics sweep through the whole level.
+ * Each orientation also keeps an occlusion buffer (nearest platform depth per pixel of the 2D view), so "is this point hidden
+ * behind a platform" is a pixel lookup instead of a ray cast from the camera.
+ * Every platform also keeps its headroom: the platforms hanging over regions of its top face and the free height under each, so
+ * "is there room to land here" is a walk over a few spans instead of a box sweep up from the top face.
+ */
+UCLASS()
+class PLATFORMERCPP_API UPlatformProjectionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPlatformProjectionSubsystem();
+
+	//Platforms add themselves on BeginPlay, update when their root moves and remove themselves on EndPlay
+	void RegisterPlatform(APlatformMaster* Platform);
+	void UpdatePlatform(APlatformMaster* Platform);
+	void UnregisterPlatform(APlatformMaster* Platform);
+
+	//Instanced platforms (AInstancedPlatformManager) are indexed by their mesh component and instance index instead
+	void RegisterInstance(UPrimitiveComponent* Component, const int32 Instance, const FBox& Bounds, const bool bSurface);
+	void UnregisterInstance(UPrimitiveComponent* Component, const int32 Instance);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Emulates SweepSingleByChannel for a box swept along the X or Y axis, against platforms only. Start to End must be axis aligned (a camera axis)."))
+		bool SweepAlongAxis(const FVector& Start, const FVector& End, const FVector& BoxExtent, FHitResult& HitResult) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Is there a platform in front of Point when looking along ViewDirection (an X or Y camera axis)?"))
+		bool IsOccludedAlongAxis(const FVector& ViewDirection, const FVector& Point) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Fraction (0-1) of the box (HalfSize across the view and in Z) around Center hidden by platforms when looking along ViewDirection."))
+		float GetOccludedFraction(const FVector& ViewDirection, const FVector& Center, const FVector2D& HalfSize) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Free height above the top face of Platform over the XY footprint (Center +- HalfSize). Very large when nothing hangs over it."))
+		float GetHeadroom(const APlatformMaster* Platform, const FVector2D& Center, const FVector2D& HalfSize) const;
+
+	//Lowest platform hanging over Footprint on Platform's top face, and the free height under it
+	APlatformMaster* FindPlatformAbove(const APlatformMaster* Platform, const FBox2D& Footprint, float& OutHeadroom) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform")
+		int32 GetNumPlatforms() const;
+
+	//Box around every platform indexed so far, the farthest any query can find one. Only grows, removals don't shrink it.
+	const FBox& GetIndexedBounds() const { return IndexedBounds; }
+
+	//Plain data versions of the queries above for worker threads (AGhostRunnerField). They only read the index, so they can run on
+	//any number of threads at once as long as no platform registers, moves or leaves meanwhile, e.g. inside a ParallelFor started
+	//from the game thread. The BlueprintCallable ones resolve actors and can create instance proxies, keep those on the game thread.
+
+	//SweepAlongAxis without the FHitResult
+	bool SweepBoundsAlongAxis(const FVector& Start, const FVector& End, const FVector& BoxExtent, FPlatformIndexHit& OutHit) const;
+
+	//Platform with the highest top face in [MinZ, MaxZ] under the XY footprint
+	bool FindGroundBelow(const FBox2D& Footprint, const float MinZ, const float MaxZ, FPlatformIndexHit& OutHit) const;
+
+	//Platform with the lowest bottom face in [MinZ, MaxZ] over the XY footprint
+	bool FindCeilingAbove(const FBox2D& Footprint, const float MinZ, const float MaxZ, FPlatformIndexHit& OutHit) const;
+
+	//GetHeadroom for a platform found by one of the queries above
+	float GetHeadroomOf(const int32 Id, const FBox2D& Footprint) const;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Platform", meta = (Tooltip = "Cross check every index answer against the physics sweep it replaces and log mismatches."))
+		bool bValidate;
+
+private:
+	//Size of one grid cell on the projected plane
+	float CellSize;
+
+	//A platform over part of another platform's top face
+	struct FHeadroomSpan {
+		int32 Id;
+		FBox2D Rect; //XY footprint of the platform above
+		float Clearance; //Free height between the top face and its underside, 0 if they overlap
+	};
+
+	struct FPlatformRecord {
+		TWeakObjectPtr<APlatformMaster> Platform;
+		TWeakObjectPtr<UPrimitiveComponent> Component; //Instanced platforms only
+		int32 Instance = INDEX_NONE;
+		FBox Bounds;
+		bool bSurface = false;
+		TArray<FHeadroomSpan> Headroom;
+	};
+
+	struct FCellEntry {
+		int32 Id;
+		float Near; //Near face along the view's camera axis (depth grows away from the camera)
+		float Far;
+	};
+
+	//One view per camera orientation: 0 = +X, 1 = -X, 2 = +Y, 3 = -Y
+	struct FProjectionView {
+		TMap<FIntPoint, TArray<FCellEntry>> Cells;
+		FPlatformOcclusionBuffer Occlusion;
+	};
+
+	static constexpr int32 NumViews = 4;
+
+	TSparseArray<FPlatformRecord> Records;
+	TMap<const APlatformMaster*, int32> RecordIds;
+	TMap<TPair<const UPrimitiveComponent*, int32>, int32> InstanceRecordIds;
+	FProjectionView Views[NumViews];
+	TMap<FIntPoint, TArray<int32>> TopDownCells; //Platforms by XY cell, to find the ones stacked over each other
+	FBox IndexedBounds;
+
+	int32 FindRecordId(const APlatformMaster* Platform) const;
+	APlatformMaster* GetRecordPlatform(const int32 Id) const;
+	void FillIndexHit(const int32 Id, FPlatformIndexHit& OutHit) const;
+	int32 FindFirstAlongAxis(const FVector& Start, const FVector& End, const FVector& BoxExtent, float& OutDepth) const;
+	int32 FindInColumn(const FBox2D& Footprint, const float MinZ, const float MaxZ, const bool bHighestTop) const;
+	int32 FindLowestSpan(const int32 Id, const FBox2D& Footprint, float& OutHeadroom) const;
+	static bool OverlapsXY(const FBox& A, const FBox& B);
+	static FBox2D GetFootprint(const FBox& Bounds) { return FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max)); }
+
+	static int32 GetViewAxis(const int32 View) { return View / 2; }
+	static float GetViewSign(const int32 View) { return View % 2 == 0 ? 1.0f : -1.0f; }
+	static int32 GetViewForDirection(const FVector& Direction);
+	FIntPoint ToCell(const float Across, const float Z) const;
+	FBox2D GetProjectedRect(const FBox& Bounds, const int32 View) const;
+	void RebuildOcclusionTile(const int32 View, const FIntPoint& Tile);
+	void AddToViews(const int32 Id);
+	void RemoveFromViews(const int32 Id);
+	void AddToHeadroom(const int32 Id);
+	void RemoveFromHeadroom(const int32 Id);
+};
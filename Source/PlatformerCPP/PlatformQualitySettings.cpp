@@ -0,0 +1,14 @@
+// Copyright 2020 Ryan Gourley
+
+#include "PlatformQualitySettings.h"
+
+UPlatformQualitySettings::UPlatformQualitySettings(){
+	CategoryName = TEXT("Game");
+	DistanceBands = { 2000.0f, 4000.0f };
+	TargetFrameRate = 60.0f;
+	DegradeAbove = 1.1f;
+	DegradeSeconds = 1.0f;
+	RecoverBelow = 0.8f;
+	RecoverSeconds = 4.0f;
+	ReassignInterval = 0.25f;
+}
@@ -0,0 +1,57 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "PlatformQualitySettings.generated.h"
+
+class UMaterialInterface;
+
+//A full quality platform material and its prebuilt cheaper instances
+USTRUCT(BlueprintType)
+struct FPlatformMaterialTiers {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quality", meta = (Tooltip = "Material the platforms are authored with (M_6SidesMaster, MS_DefaultMaterial, M_TronGlowMaster or one of their instances)."))
+		TSoftObjectPtr<UMaterialInterface> Source;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quality", meta = (Tooltip = "Cheaper instances, tier 1 first. Tiers past the end of the list use the last one."))
+		TArray<TSoftObjectPtr<UMaterialInterface>> Tiers;
+};
+
+/**
+ * Project Settings > Game > Platform Quality. What UPlatformQualitySubsystem swaps platform materials to, and when.
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Platform Quality"))
+class PLATFORMERCPP_API UPlatformQualitySettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UPlatformQualitySettings();
+
+	UPROPERTY(Config, EditAnywhere, Category = "Tiers")
+		TArray<FPlatformMaterialTiers> MaterialTiers;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Tiers", meta = (Tooltip = "Distances from the camera splitting platforms into bands, nearest first. Farther bands drop a tier before nearer ones."))
+		TArray<float> DistanceBands;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor", meta = (ClampMin = "1", Tooltip = "Frame rate the budget is worked out from. Matches the smoothed frame rate range in DefaultEngine.ini."))
+		float TargetFrameRate;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor", meta = (ClampMin = "1", Tooltip = "Drop a step when the frame costs more than this fraction of the budget..."))
+		float DegradeAbove;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor", meta = (ClampMin = "0", Tooltip = "...for this many seconds."))
+		float DegradeSeconds;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor", meta = (ClampMin = "0", ClampMax = "1", Tooltip = "Climb a step when the frame costs less than this fraction of the budget..."))
+		float RecoverBelow;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor", meta = (ClampMin = "0", Tooltip = "...for this many seconds. Longer than DegradeSeconds so a recovered step isn't dropped again straight away."))
+		float RecoverSeconds;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Governor", meta = (ClampMin = "0", Tooltip = "How often platforms are put back in their distance band as the camera moves, in seconds."))
+		float ReassignInterval;
+};
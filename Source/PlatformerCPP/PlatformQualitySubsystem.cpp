@@ -0,0 +1,228 @@
+// Copyright 2020 Ryan Gourley
+
+#include "PlatformQualitySubsystem.h"
+#include "Engine/World.h"
+#include "Components/MeshComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Materials/MaterialInterface.h"
+#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "RenderCore.h"
+#include "RHI.h"
+#include "PlatformerCPP.h"
+#include "PlatformQualitySettings.h"
+#include "PlatformMaster.h"
+
+namespace PlatformQuality {
+	int32 ForcedTier = -1;
+	static FAutoConsoleVariableRef CVarForcedTier(TEXT("dimense.MaterialTier"), ForcedTier, TEXT("Forces every platform onto this material tier (0 is full quality). -1 lets the frame time governor decide."));
+}
+
+UPlatformQualitySubsystem::UPlatformQualitySubsystem(){
+	MaxTier = 0;
+	NumDegraded = 0;
+	Level = 0;
+	AppliedForcedTier = -1;
+	FrameCostMs = 0.0f;
+	OverBudgetTime = 0.0f;
+	UnderBudgetTime = 0.0f;
+	ReassignTime = 0.0f;
+}
+
+void UPlatformQualitySubsystem::Initialize(FSubsystemCollectionBase& Collection){
+	Super::Initialize(Collection);
+	if (!GetWorld() || !GetWorld()->IsGameWorld()) {
+		return;
+	}
+	int32 Tier;
+	if (FParse::Value(FCommandLine::Get(), TEXT("DimenseMaterialTier="), Tier)) {
+		PlatformQuality::ForcedTier = Tier;
+	}
+	//Loaded up front so a swap never waits on a load
+	for (const FPlatformMaterialTiers& Entry : GetDefault<UPlatformQualitySettings>()->MaterialTiers) {
+		UMaterialInterface* Source = Entry.Source.LoadSynchronous();
+		if (!Source || Entry.Tiers.Num() == 0 || SetsBySource.Contains(Source)) {
+			continue;
+		}
+		TArray<UMaterialInterface*> Set;
+		Set.Add(Source);
+		for (const TSoftObjectPtr<UMaterialInterface>& TierMaterial : Entry.Tiers) {
+			UMaterialInterface* Material = TierMaterial.LoadSynchronous();
+			if (!Material) {
+				UE_LOG(LogDimense, Warning, TEXT("Material tier %s of %s could not be loaded, using the tier above"), *TierMaterial.ToString(), *Source->GetName());
+			}
+			Set.Add(Material ? Material : Set.Last());
+		}
+		LoadedMaterials.Append(Set);
+		MaxTier = FMath::Max(MaxTier, Set.Num() - 1);
+		SetsBySource.Add(Source, TierSets.Add(Set));
+	}
+}
+
+void UPlatformQualitySubsystem::RegisterPlatform(APlatformMaster* Platform){
+	if (!Platform || TierSets.Num() == 0 || RecordIds.Contains(Platform)) {
+		return;
+	}
+	FPlatformRecord Record;
+	TInlineComponentArray<UMeshComponent*> Meshes(Platform);
+	for (UMeshComponent* Mesh : Meshes) {
+		FTieredMesh Tiered;
+		Tiered.Mesh = Mesh;
+		for (int32 Slot = 0; Slot < Mesh->GetNumMaterials(); Slot++) {
+			if (const int32* Set = SetsBySource.Find(Mesh->GetMaterial(Slot))) {
+				Tiered.Slots.Add(FIntPoint(Slot, *Set));
+			}
+		}
+		if (Tiered.Slots.Num() > 0) {
+			Record.Meshes.Add(Tiered);
+		}
+	}
+	//Starts on its source materials, the next AssignTiers puts it in its band
+	if (Record.Meshes.Num() > 0) {
+		RecordIds.Add(Platform, Records.Add(Record));
+	}
+}
+
+void UPlatformQualitySubsystem::UnregisterPlatform(APlatformMaster* Platform){
+	int32 Id;
+	if (!RecordIds.RemoveAndCopyValue(Platform, Id)) {
+		return;
+	}
+	//Back on the source so it is recognised when its level is shown again
+	for (FTieredMesh& Tiered : Records[Id].Meshes) {
+		ApplyTier(Tiered, 0);
+	}
+	Records.RemoveAt(Id);
+}
+
+int32 UPlatformQualitySubsystem::GetQualityLevel() const{
+	return PlatformQuality::ForcedTier >= 0 ? FMath::Min(PlatformQuality::ForcedTier, MaxTier) : Level;
+}
+
+float UPlatformQualitySubsystem::GetFrameBudgetMs() const{
+	return 1000.0f / FMath::Max(GetDefault<UPlatformQualitySettings>()->TargetFrameRate, 1.0f);
+}
+
+float UPlatformQualitySubsystem::GetFrameCostMs() const{
+	return FrameCostMs;
+}
+
+bool UPlatformQualitySubsystem::IsTickable() const{
+	return !HasAnyFlags(RF_ClassDefaultObject) && GetWorld() && GetWorld()->IsGameWorld() && TierSets.Num() > 0;
+}
+
+TStatId UPlatformQualitySubsystem::GetStatId() const{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlatformQualitySubsystem, STATGROUP_Tickables);
+}
+
+void UPlatformQualitySubsystem::Tick(float DeltaTime){
+	DIMENSE_SCOPE(STAT_DimenseMaterialGovernor, MaterialGovernor);
+	//Real time, time dilation must not stretch the hysteresis
+	float RealDeltaTime = FApp::GetDeltaTime();
+	float MeasuredMs = MeasureFrameCostMs();
+	FrameCostMs = FrameCostMs > 0.0f ? FMath::Lerp(FrameCostMs, MeasuredMs, 0.1f) : MeasuredMs;
+	int32 PreviousLevel = Level;
+	UpdateLevel(RealDeltaTime);
+	ReassignTime -= RealDeltaTime;
+	if (Level != PreviousLevel || PlatformQuality::ForcedTier != AppliedForcedTier || ReassignTime <= 0.0f) {
+		ReassignTime = GetDefault<UPlatformQualitySettings>()->ReassignInterval;
+		AssignTiers();
+	}
+	SET_DWORD_STAT(STAT_DimenseMaterialLevel, GetQualityLevel());
+	SET_FLOAT_STAT(STAT_DimenseFrameBudgetMs, GetFrameBudgetMs());
+	SET_FLOAT_STAT(STAT_DimenseFrameCostMs, FrameCostMs);
+	CSV_CUSTOM_STAT(Dimense, MaterialLevel, GetQualityLevel(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Dimense, FrameCostMs, FrameCostMs, ECsvCustomStatOp::Set);
+}
+
+float UPlatformQualitySubsystem::MeasureFrameCostMs() const{
+	//Slowest of the three, as in stat unit. Excludes the wait for the frame rate limit, which would hide any headroom.
+	float GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	float RenderThreadMs = FPlatformTime::ToMilliseconds(GRenderThreadTime);
+	float GPUMs = FPlatformTime::ToMilliseconds(RHIGetGPUFrameCycles());
+	return FMath::Max3(GameThreadMs, RenderThreadMs, GPUMs);
+}
+
+void UPlatformQualitySubsystem::UpdateLevel(const float DeltaTime){
+	if (PlatformQuality::ForcedTier >= 0) {
+		OverBudgetTime = 0.0f;
+		UnderBudgetTime = 0.0f;
+		return;
+	}
+	const UPlatformQualitySettings* Settings = GetDefault<UPlatformQualitySettings>();
+	float BudgetMs = GetFrameBudgetMs();
+	int32 MaxLevel = MaxTier + Settings->DistanceBands.Num();
+	if (FrameCostMs > BudgetMs * Settings->DegradeAbove) {
+		UnderBudgetTime = 0.0f;
+		OverBudgetTime += DeltaTime;
+		if (OverBudgetTime >= Settings->DegradeSeconds && Level < MaxLevel) {
+			Level++;
+			OverBudgetTime = 0.0f;
+			UE_LOG(LogDimense, Log, TEXT("Platform quality level %d (frame %.1f ms, budget %.1f ms)"), Level, FrameCostMs, BudgetMs);
+		}
+	}else if (FrameCostMs < BudgetMs * Settings->RecoverBelow) {
+		OverBudgetTime = 0.0f;
+		UnderBudgetTime += DeltaTime;
+		if (UnderBudgetTime >= Settings->RecoverSeconds && Level > 0) {
+			Level--;
+			UnderBudgetTime = 0.0f;
+			UE_LOG(LogDimense, Log, TEXT("Platform quality level %d (frame %.1f ms, budget %.1f ms)"), Level, FrameCostMs, BudgetMs);
+		}
+	}else{
+		OverBudgetTime = 0.0f;
+		UnderBudgetTime = 0.0f;
+	}
+}
+
+void UPlatformQualitySubsystem::AssignTiers(){
+	int32 ForcedTier = PlatformQuality::ForcedTier;
+	AppliedForcedTier = ForcedTier;
+	if (ForcedTier < 0 && Level == 0 && NumDegraded == 0) {
+		return;
+	}
+	const TArray<float>& Bands = GetDefault<UPlatformQualitySettings>()->DistanceBands;
+	int32 FarthestBand = Bands.Num();
+	FVector CameraLocation = FVector::ZeroVector;
+	if (APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0)) {
+		CameraLocation = CameraManager->GetCameraLocation();
+	}
+	for (FPlatformRecord& Record : Records) {
+		for (FTieredMesh& Tiered : Record.Meshes) {
+			UMeshComponent* Mesh = Tiered.Mesh.Get();
+			if (!Mesh) {
+				continue;
+			}
+			int32 Tier;
+			if (ForcedTier >= 0) {
+				Tier = FMath::Min(ForcedTier, MaxTier);
+			}else{
+				//Each band lags the one beyond it by a step
+				float Distance = FVector::Dist(Mesh->Bounds.Origin, CameraLocation);
+				int32 Band = 0;
+				while (Band < Bands.Num() && Distance > Bands[Band]) {
+					Band++;
+				}
+				Tier = FMath::Clamp(Level - (FarthestBand - Band), 0, MaxTier);
+			}
+			ApplyTier(Tiered, Tier);
+		}
+	}
+}
+
+void UPlatformQualitySubsystem::ApplyTier(FTieredMesh& Tiered, const int32 Tier){
+	if (Tiered.Tier == Tier) {
+		return;
+	}
+	if (UMeshComponent* Mesh = Tiered.Mesh.Get()) {
+		for (const FIntPoint& Slot : Tiered.Slots) {
+			const TArray<UMaterialInterface*>& Set = TierSets[Slot.Y];
+			Mesh->SetMaterial(Slot.X, Set[FMath::Min(Tier, Set.Num() - 1)]);
+		}
+		INC_DWORD_STAT(STAT_DimenseMaterialSwaps);
+	}
+	NumDegraded += (Tier > 0 ? 1 : 0) - (Tiered.Tier > 0 ? 1 : 0);
+	Tiered.Tier = Tier;
+}
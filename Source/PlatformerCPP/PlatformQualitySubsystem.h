@@ -0,0 +1,87 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "PlatformQualitySubsystem.generated.h"
+
+class APlatformMaster;
+class UMaterialInterface;
+class UMeshComponent;
+
+/**
+ * Keeps the frame inside its budget by moving platform meshes between the material tiers of UPlatformQualitySettings.
+ * The frame cost is the slowest of the game thread, render thread and GPU (what "stat unit" shows), so waiting on the frame rate
+ * limit doesn't count. Going over DegradeAbove of the budget for DegradeSeconds drops the quality level a step, staying under
+ * RecoverBelow for RecoverSeconds climbs one back; between the two nothing changes.
+ * The level is spent distance first: step 1 puts the farthest band on tier 1, step 2 puts it on tier 2 and the next band on tier 1,
+ * and so on until every band is on the last tier.
+ * dimense.MaterialTier (or -DimenseMaterialTier=N on the command line) forces every platform onto one tier for reproducible runs.
+ */
+UCLASS()
+class PLATFORMERCPP_API UPlatformQualitySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UPlatformQualitySubsystem();
+
+	//USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	//Platforms add themselves on BeginPlay and remove themselves (back on their source materials) on EndPlay
+	void RegisterPlatform(APlatformMaster* Platform);
+	void UnregisterPlatform(APlatformMaster* Platform);
+
+	UFUNCTION(BlueprintCallable, Category = "Quality", meta = (Tooltip = "Governor step, 0 is full quality everywhere. The forced tier when dimense.MaterialTier is set."))
+		int32 GetQualityLevel() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Quality", meta = (Tooltip = "Frame budget in ms, from the target frame rate."))
+		float GetFrameBudgetMs() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Quality", meta = (Tooltip = "Smoothed frame cost in ms the governor decides on."))
+		float GetFrameCostMs() const;
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	//Material slots of one mesh that have tiers, as (slot, tier set)
+	struct FTieredMesh {
+		TWeakObjectPtr<UMeshComponent> Mesh;
+		TArray<FIntPoint> Slots;
+		int32 Tier = 0;
+	};
+
+	struct FPlatformRecord {
+		TArray<FTieredMesh> Meshes;
+	};
+
+	//Every material of every tier set, loaded and kept alive here
+	UPROPERTY()
+		TArray<UMaterialInterface*> LoadedMaterials;
+
+	TArray<TArray<UMaterialInterface*>> TierSets; //Index 0 is the source
+	TMap<const UMaterialInterface*, int32> SetsBySource;
+	int32 MaxTier;
+
+	TSparseArray<FPlatformRecord> Records;
+	TMap<const APlatformMaster*, int32> RecordIds;
+	int32 NumDegraded;
+
+	int32 Level;
+	int32 AppliedForcedTier;
+	float FrameCostMs;
+	float OverBudgetTime;
+	float UnderBudgetTime;
+	float ReassignTime;
+
+	float MeasureFrameCostMs() const;
+	void UpdateLevel(const float DeltaTime);
+	void AssignTiers();
+	void ApplyTier(FTieredMesh& Tiered, const int32 Tier);
+};
@@ -4,3 +4,48 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, PlatformerCPP, "PlatformerCPP" );
+
+DEFINE_LOG_CATEGORY(LogDimense);
+
+CSV_DEFINE_CATEGORY_MODULE(PLATFORMERCPP_API, Dimense, true);
+UE_TRACE_CHANNEL_DEFINE(DimenseChannel);
+
+DEFINE_STAT(STAT_DimenseMovementQueries);
+DEFINE_STAT(STAT_DimenseTick);
+DEFINE_STAT(STAT_DimenseUpdateVariables);
+DEFINE_STAT(STAT_DimensePlatformChecks);
+DEFINE_STAT(STAT_DimenseVisibilityCheck);
+DEFINE_STAT(STAT_DimenseHorizontalHitCheck);
+DEFINE_STAT(STAT_DimenseTryTransport);
+DEFINE_STAT(STAT_DimenseTryMoveAround);
+DEFINE_STAT(STAT_DimenseSpinPrepare);
+DEFINE_STAT(STAT_DimensePlatformAbove);
+DEFINE_STAT(STAT_DimensePickupTrace);
+DEFINE_STAT(STAT_DimensePickupBatch);
+DEFINE_STAT(STAT_DimenseCoinField);
+DEFINE_STAT(STAT_DimenseGhostRunners);
+DEFINE_STAT(STAT_DimenseGhostRunnerStep);
+DEFINE_STAT(STAT_DimenseLevelStreaming);
+DEFINE_STAT(STAT_DimenseEntranceStreaming);
+DEFINE_STAT(STAT_DimenseMaterialGovernor);
+DEFINE_STAT(STAT_DimenseLineTraces);
+DEFINE_STAT(STAT_DimenseSweeps);
+DEFINE_STAT(STAT_DimenseBoundsQueries);
+DEFINE_STAT(STAT_DimenseAsyncProbes);
+DEFINE_STAT(STAT_DimenseSyncQueryMs);
+DEFINE_STAT(STAT_DimenseAsyncQueryMs);
+DEFINE_STAT(STAT_DimenseQueryMsSaved);
+DEFINE_STAT(STAT_DimenseBoundsRecomputes);
+DEFINE_STAT(STAT_DimenseGhostRunnerCount);
+DEFINE_STAT(STAT_DimenseLevelChunks);
+DEFINE_STAT(STAT_DimenseEntranceLevels);
+DEFINE_STAT(STAT_DimenseMaterialLevel);
+DEFINE_STAT(STAT_DimenseFrameBudgetMs);
+DEFINE_STAT(STAT_DimenseFrameCostMs);
+DEFINE_STAT(STAT_DimenseMaterialSwaps);
+DEFINE_STAT(STAT_DimensePoolHits);
+DEFINE_STAT(STAT_DimensePoolMisses);
+DEFINE_STAT(STAT_DimensePickupCandidates);
+DEFINE_STAT(STAT_DimenseNetCorrections);
+DEFINE_STAT(STAT_DimenseNetTeleports);
+DEFINE_STAT(STAT_DimenseNetTeleportsRejected);
@@ -3,4 +3,76 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogDimense, Log, All);
+
+//Object type of every platform collider (PlatformStatic/PlatformDynamic profiles). Movement queries look for this type only, so scenery on WorldStatic costs them nothing.
+#define ECC_Platform ECC_GameTraceChannel1
+
+//Stats for the Dimense movement system (view in game with "stat Dimense")
+DECLARE_STATS_GROUP(TEXT("Dimense"), STATGROUP_Dimense, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement Queries"), STAT_DimenseMovementQueries, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Tick"), STAT_DimenseTick, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateMovementSystemVariables"), STAT_DimenseUpdateVariables, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DoLineTracesAndPlatformChecks"), STAT_DimensePlatformChecks, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("VisibilityCheck"), STAT_DimenseVisibilityCheck, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HorizontalHitCheck"), STAT_DimenseHorizontalHitCheck, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TryTransport"), STAT_DimenseTryTransport, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TryMoveAround"), STAT_DimenseTryMoveAround, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera Spin Prepare"), STAT_DimenseSpinPrepare, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PlatformAbovePlatformCheck"), STAT_DimensePlatformAbove, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pickup Obstacle Trace"), STAT_DimensePickupTrace, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pickup Batch"), STAT_DimensePickupBatch, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Coin Field"), STAT_DimenseCoinField, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ghost Runners"), STAT_DimenseGhostRunners, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ghost Runner Step"), STAT_DimenseGhostRunnerStep, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Level Chunk Streaming"), STAT_DimenseLevelStreaming, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Entrance Streaming"), STAT_DimenseEntranceStreaming, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Material Governor"), STAT_DimenseMaterialGovernor, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Line Traces"), STAT_DimenseLineTraces, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sweeps"), STAT_DimenseSweeps, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bounds Queries"), STAT_DimenseBoundsQueries, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Probes Submitted"), STAT_DimenseAsyncProbes, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Sync Query Cost (ms)"), STAT_DimenseSyncQueryMs, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Async Query Cost (ms)"), STAT_DimenseAsyncQueryMs, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Game Thread ms Saved"), STAT_DimenseQueryMsSaved, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Platform Bounds Recomputes"), STAT_DimenseBoundsRecomputes, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Ghost Runner Count"), STAT_DimenseGhostRunnerCount, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Level Chunks Loaded"), STAT_DimenseLevelChunks, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Entrance Levels Cached"), STAT_DimenseEntranceLevels, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Material Quality Level"), STAT_DimenseMaterialLevel, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Frame Budget (ms)"), STAT_DimenseFrameBudgetMs, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Frame Cost (ms)"), STAT_DimenseFrameCostMs, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Material Swaps"), STAT_DimenseMaterialSwaps, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Platform Pool Hits"), STAT_DimensePoolHits, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Platform Pool Misses"), STAT_DimensePoolMisses, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pickup Candidates"), STAT_DimensePickupCandidates, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Net Corrections"), STAT_DimenseNetCorrections, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Net Teleports"), STAT_DimenseNetTeleports, STATGROUP_Dimense, PLATFORMERCPP_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Net Teleports Rejected"), STAT_DimenseNetTeleportsRejected, STATGROUP_Dimense, PLATFORMERCPP_API);
+
+//Same timers and counters for the CSV profiler (csvprofile start/stop) and Unreal Insights (-trace=cpu,dimense)
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(PLATFORMERCPP_API, Dimense);
+UE_TRACE_CHANNEL_EXTERN(DimenseChannel, PLATFORMERCPP_API);
+
+//Times the rest of the scope in all three profilers. Name is the CSV/Insights name of the timer.
+#define DIMENSE_SCOPE(Stat, Name) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	CSV_SCOPED_TIMING_STAT(Dimense, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, DimenseChannel)
+
+//Per frame query counters
+#define DIMENSE_COUNT_LINE_TRACES(Count) \
+	INC_DWORD_STAT_BY(STAT_DimenseLineTraces, Count); \
+	CSV_CUSTOM_STAT(Dimense, LineTraces, Count, ECsvCustomStatOp::Accumulate)
+
+#define DIMENSE_COUNT_SWEEPS(Count) \
+	INC_DWORD_STAT_BY(STAT_DimenseSweeps, Count); \
+	CSV_CUSTOM_STAT(Dimense, Sweeps, Count, ECsvCustomStatOp::Accumulate)
+
+#define DIMENSE_COUNT_BOUNDS_QUERIES(Count) \
+	INC_DWORD_STAT_BY(STAT_DimenseBoundsQueries, Count); \
+	CSV_CUSTOM_STAT(Dimense, BoundsQueries, Count, ECsvCustomStatOp::Accumulate)
@@ -3,18 +3,111 @@
 #include "PlatformerCPPGameModeBase.h"
 #include "Runtime/Engine/Classes/Engine/World.h"
 #include "DimenseCharacter.h"
+#include "DimenseBenchmark.h"
+#include "DimenseDebug.h"
+#include "DimensePlayerController.h"
+#include "PlatformProjectionSubsystem.h"
+#include "EntranceStreamingSubsystem.h"
 #include "Runtime/Engine/Classes/Engine/Engine.h"
+#include "Misc/App.h"
+#include "PlatformerCPP.h"
 
 void APlatformerCPPGameModeBase::Debug()
 {
+	//Toggle debug if the command is entered (same as dimense.Debug 0/1, the channels are dimense.Debug.*)
+#if DIMENSE_DEBUG_ENABLED
+	DimenseDebug::SetEnabled(!DimenseDebug::IsEnabled());
+#endif
+}
+
+void APlatformerCPPGameModeBase::AsyncQueries()
+{
+	PlayerReference = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	//Toggle between the async movement probe batch and the synchronous traces
+	PlayerReference->bAsyncMovementQueries = !PlayerReference->bAsyncMovementQueries;
+	GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::White, PlayerReference->bAsyncMovementQueries ? TEXT("Movement queries: async") : TEXT("Movement queries: sync"));
+}
+
+void APlatformerCPPGameModeBase::ValidatePlatformIndex()
+{
+	//Toggle cross checking of the platform projection index against physics sweeps (mismatches go to the log)
+	UPlatformProjectionSubsystem* ProjectionIndex = GetWorld()->GetSubsystem<UPlatformProjectionSubsystem>();
+	ProjectionIndex->bValidate = !ProjectionIndex->bValidate;
+	GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::White, ProjectionIndex->bValidate ? TEXT("Platform index validation: on") : TEXT("Platform index validation: off"));
+}
+
+void APlatformerCPPGameModeBase::FixedStep(const bool bScriptedInput)
+{
+	PlayerReference = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	//Toggle the fixed step simulation. Scripted input replaces the player's input so checksums can be compared between frame rates (t.MaxFPS).
+	PlayerReference->bFixedStepSimulation = !PlayerReference->bFixedStepSimulation;
+	PlayerReference->bFixedStepScriptedInput = PlayerReference->bFixedStepSimulation && bScriptedInput;
+	GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::White, PlayerReference->bFixedStepSimulation ? TEXT("Movement: fixed step") : TEXT("Movement: per frame"));
+}
+
+void APlatformerCPPGameModeBase::FixedStepChecksum()
+{
+	PlayerReference = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
+	FString Message = FString::Printf(TEXT("Fixed step %d: decision checksum %08x"), PlayerReference->SimulationStep, uint32(PlayerReference->GetDecisionChecksum()));
+	UE_LOG(LogDimense, Log, TEXT("%s"), *Message);
+	GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::White, Message);
+}
+
+void APlatformerCPPGameModeBase::FixedStepDeterminism(const int32 Steps)
+{
+	//Runs the scripted fixed steps from the same state at 30, 60 and 240 fps and compares the checksums. Headless: -game -nullrhi -unattended -ExecCmds="FixedStepDeterminism 600" exits with 1 on a mismatch.
 	PlayerReference = Cast<ADimenseCharacter>(GetWorld()->GetFirstPlayerController()->GetPawn());
-	//Toggle debug if the command is entered
-	if (PlayerReference->bDebug) {
-		PlayerReference->bDebug = false;
-		PlayerReference->bDebugPlatformRemote = false;
+	int32 Checksum30 = 0;
+	int32 Checksum60 = 0;
+	int32 Checksum240 = 0;
+	bool bMatch = PlayerReference && PlayerReference->CheckFixedStepDeterminism(Steps, Checksum30, Checksum60, Checksum240);
+	FString Message = FString::Printf(TEXT("Fixed step determinism over %d steps: %s (30 fps %08x, 60 fps %08x, 240 fps %08x)"), Steps, bMatch ? TEXT("passed") : TEXT("FAILED"), uint32(Checksum30), uint32(Checksum60), uint32(Checksum240));
+	UE_LOG(LogDimense, Display, TEXT("%s"), *Message);
+	GEngine->AddOnScreenDebugMessage(-1, 5.0f, bMatch ? FColor::Green : FColor::Red, Message);
+	if (FApp::IsUnattended()) {
+		FPlatformMisc::RequestExitWithStatus(false, bMatch ? 0 : 1);
+	}
+}
+
+void APlatformerCPPGameModeBase::DimenseBenchmark(const int32 DecorationsPerPlatform)
+{
+	//Spawns the platform scaling benchmark, which writes a CSV to Saved/Profiling/Dimense when done. "DimenseBenchmark 4" runs it on a decorated grid.
+	ADimenseBenchmark* Benchmark = GetWorld()->SpawnActorDeferred<ADimenseBenchmark>(ADimenseBenchmark::StaticClass(), FTransform::Identity);
+	Benchmark->DecorationsPerPlatform = FMath::Max(DecorationsPerPlatform, 0);
+	Benchmark->FinishSpawning(FTransform::Identity);
+}
+
+void APlatformerCPPGameModeBase::DimenseRecord(const FString& Name)
+{
+	//Toggle recording the player's input to Saved/Recordings (replay it with DimenseReplay)
+	ADimensePlayerController* Controller = Cast<ADimensePlayerController>(GetWorld()->GetFirstPlayerController());
+	if (!Controller) {
+		return;
 	}
-	else {
-		PlayerReference->bDebug = true;
-		PlayerReference->bDebugPlatformRemote = true;
+	if (Controller->IsRecording()) {
+		Controller->StopRecording();
+	}else{
+		Controller->StartRecording(Name);
+	}
+	GEngine->AddOnScreenDebugMessage(-1, 2.0f, FColor::White, Controller->IsRecording() ? TEXT("Recording: on") : TEXT("Recording: off"));
+}
+
+void APlatformerCPPGameModeBase::DimenseReplay(const FString& Name)
+{
+	//Plays a recording back and writes its frame times to Saved/Profiling/Dimense. Headless: -game -nullrhi -unattended -ExecCmds="DimenseReplay <Name>"
+	ADimensePlayerController* Controller = Cast<ADimensePlayerController>(GetWorld()->GetFirstPlayerController());
+	if (!Controller || !Controller->StartPlayback(Name, false)) {
+		UE_LOG(LogDimense, Error, TEXT("Could not play back %s"), *Name);
+		if (FApp::IsUnattended()) {
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+}
+
+void APlatformerCPPGameModeBase::DimenseTransitions()
+{
+	//Logs how long the recent entrance transitions took to show their level, and whether it was preloaded
+	if (UEntranceStreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UEntranceStreamingSubsystem>()) {
+		Streaming->LogTransitions();
 	}
-}
\ No newline at end of file
+}
@@ -20,6 +20,33 @@ public:
 	UFUNCTION(Exec, Category = "Debug")
 	void Debug();
 
+	UFUNCTION(Exec, Category = "Debug")
+	void AsyncQueries();
+
+	UFUNCTION(Exec, Category = "Debug")
+	void ValidatePlatformIndex();
+
+	UFUNCTION(Exec, Category = "Debug")
+	void FixedStep(const bool bScriptedInput);
+
+	UFUNCTION(Exec, Category = "Debug")
+	void FixedStepChecksum();
+
+	UFUNCTION(Exec, Category = "Debug")
+	void FixedStepDeterminism(const int32 Steps = 600);
+
+	UFUNCTION(Exec, Category = "Debug")
+	void DimenseBenchmark(const int32 DecorationsPerPlatform = 0);
+
+	UFUNCTION(Exec, Category = "Debug")
+	void DimenseRecord(const FString& Name);
+
+	UFUNCTION(Exec, Category = "Debug")
+	void DimenseReplay(const FString& Name);
+
+	UFUNCTION(Exec, Category = "Debug")
+	void DimenseTransitions();
+
 	UPROPERTY(VisibleAnywhere, Category = "Pickup Variables", meta = (AllowPrivateAccess = "true", Tooltip = "Reference to the player as DimenseCharacter."))
 	ADimenseCharacter* PlayerReference;
 };
@@ -2,6 +2,10 @@
 
 
 #include "SurfacePlatformComponent.h"
+#include "Engine/World.h"
+#include "PlatformerCPP.h"
+#include "PlatformMaster.h"
+#include "SurfacePlatformSubsystem.h"
 
 // Sets default values for this component's properties
 USurfacePlatformComponent::USurfacePlatformComponent()
@@ -19,10 +23,28 @@ void USurfacePlatformComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
+	APlatformMaster* Platform = Cast<APlatformMaster>(GetOwner());
+	if (!Platform) {
+		UE_LOG(LogDimense, Warning, TEXT("%s is on %s, surface platforms have to be APlatformMaster"), *GetName(), *GetNameSafe(GetOwner()));
+		return;
+	}
+	if (USurfacePlatformSubsystem* Surfaces = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>()) {
+		Surfaces->RegisterSurface(Platform);
+	}
 	
 }
 
+// Called when the owner is destroyed or its level is unloaded
+void USurfacePlatformComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	APlatformMaster* Platform = Cast<APlatformMaster>(GetOwner());
+	USurfacePlatformSubsystem* Surfaces = GetWorld()->GetSubsystem<USurfacePlatformSubsystem>();
+	if (Platform && Surfaces) {
+		Surfaces->UnregisterSurface(Platform);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
 
 // Called every frame
 void USurfacePlatformComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -6,7 +6,7 @@
 #include "Components/ActorComponent.h"
 #include "SurfacePlatformComponent.generated.h"
 
-
+//Marks its owning APlatformMaster as a platform the player can Transport onto, by registering it with USurfacePlatformSubsystem
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class PLATFORMERCPP_API USurfacePlatformComponent : public UActorComponent
 {
@@ -20,6 +20,9 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	// Called when the owner is destroyed or its level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
@@ -0,0 +1,120 @@
+// Copyright 2020 Ryan Gourley
+
+#include "SurfacePlatformSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "PlatformMaster.h"
+
+void USurfacePlatformSubsystem::RegisterSurface(APlatformMaster* Platform){
+	if (!Platform || Platform->SurfaceId != INDEX_NONE) {
+		return;
+	}
+	//A proxy takes over the entry its instance already has
+	if (const int32* InstanceId = InstanceIds.Find(FInstanceKey(Platform->GetInstanceComponent(), Platform->GetInstanceIndex()))) {
+		Platforms[*InstanceId] = Platform;
+		Platform->SurfaceId = *InstanceId;
+		return;
+	}
+	Platform->SurfaceId = AddSurface(Platform, Platform->GetBounds(), GetFlagsOf(Platform), Platform->GetInstanceComponent(), Platform->GetInstanceIndex());
+}
+
+void USurfacePlatformSubsystem::RegisterInstanceSurface(UPrimitiveComponent* Component, const int32 Instance, const FBox& InstanceBounds){
+	if (!Component || InstanceIds.Contains(FInstanceKey(Component, Instance))) {
+		return;
+	}
+	uint8 InstanceFlags = ESurfaceFlag::Instance | (Component->Mobility == EComponentMobility::Movable ? Movable : 0);
+	InstanceIds.Add(FInstanceKey(Component, Instance), AddSurface(nullptr, InstanceBounds, InstanceFlags, Component, Instance));
+}
+
+void USurfacePlatformSubsystem::UnregisterInstanceSurface(const UPrimitiveComponent* Component, const int32 Instance){
+	int32 Id;
+	if (InstanceIds.RemoveAndCopyValue(FInstanceKey(Component, Instance), Id)) {
+		RemoveSurface(Id);
+	}
+}
+
+int32 USurfacePlatformSubsystem::AddSurface(APlatformMaster* Platform, const FBox& SurfaceBounds, const uint8 SurfaceFlags, UPrimitiveComponent* Component, const int32 Instance){
+	Bounds.Add(SurfaceBounds);
+	Flags.Add(SurfaceFlags);
+	InstanceComponents.Add(Component);
+	InstanceIndices.Add(Instance);
+	return Platforms.Add(Platform);
+}
+
+void USurfacePlatformSubsystem::UpdateSurface(APlatformMaster* Platform){
+	if (!Platform || !Platforms.IsValidIndex(Platform->SurfaceId)) {
+		return;
+	}
+	Bounds[Platform->SurfaceId] = Platform->GetBounds();
+	Flags[Platform->SurfaceId] = GetFlagsOf(Platform);
+}
+
+void USurfacePlatformSubsystem::UnregisterSurface(APlatformMaster* Platform){
+	if (!Platform || !Platforms.IsValidIndex(Platform->SurfaceId)) {
+		return;
+	}
+	int32 Id = Platform->SurfaceId;
+	Platform->SurfaceId = INDEX_NONE;
+	//A proxy going away leaves its instance registered, the instance is only removed with UnregisterInstanceSurface
+	if (InstanceIds.Contains(FInstanceKey(InstanceComponents[Id].Get(), InstanceIndices[Id]))) {
+		Platforms[Id] = nullptr;
+		return;
+	}
+	RemoveSurface(Id);
+}
+
+void USurfacePlatformSubsystem::RemoveSurface(const int32 Id){
+	if (Platforms[Id].IsValid()) {
+		Platforms[Id]->SurfaceId = INDEX_NONE;
+	}
+	//The last surface takes the freed id
+	Platforms.RemoveAtSwap(Id, 1, false);
+	Bounds.RemoveAtSwap(Id, 1, false);
+	Flags.RemoveAtSwap(Id, 1, false);
+	InstanceComponents.RemoveAtSwap(Id, 1, false);
+	InstanceIndices.RemoveAtSwap(Id, 1, false);
+	if (!Platforms.IsValidIndex(Id)) {
+		return;
+	}
+	if (Platforms[Id].IsValid()) {
+		Platforms[Id]->SurfaceId = Id;
+	}
+	if (int32* MovedId = InstanceIds.Find(FInstanceKey(InstanceComponents[Id].Get(), InstanceIndices[Id]))) {
+		*MovedId = Id;
+	}
+}
+
+int32 USurfacePlatformSubsystem::GetNumSurfaces() const{
+	return Platforms.Num();
+}
+
+APlatformMaster* USurfacePlatformSubsystem::GetSurface(const int32 Id) const{
+	return Platforms.IsValidIndex(Id) ? Platforms[Id].Get() : nullptr;
+}
+
+bool USurfacePlatformSubsystem::GetSurfaceInstance(const int32 Id, UPrimitiveComponent*& OutComponent, int32& OutInstance) const{
+	OutComponent = InstanceComponents.IsValidIndex(Id) ? InstanceComponents[Id].Get() : nullptr;
+	OutInstance = OutComponent ? InstanceIndices[Id] : INDEX_NONE;
+	return OutComponent != nullptr;
+}
+
+FBox USurfacePlatformSubsystem::GetSurfaceBounds(const int32 Id) const{
+	return Bounds.IsValidIndex(Id) ? Bounds[Id] : FBox(ForceInit);
+}
+
+void USurfacePlatformSubsystem::GetSurfaces(TArray<APlatformMaster*>& OutSurfaces) const{
+	OutSurfaces.Reset(Platforms.Num());
+	for (const TWeakObjectPtr<APlatformMaster>& Platform : Platforms) {
+		OutSurfaces.Add(Platform.Get());
+	}
+}
+
+uint8 USurfacePlatformSubsystem::GetFlagsOf(const APlatformMaster* Platform){
+	uint8 Result = 0;
+	if (Platform->GetInstanceIndex() != INDEX_NONE) {
+		Result |= Instance;
+	}
+	if (Platform->GetRootComponent() && Platform->GetRootComponent()->Mobility == EComponentMobility::Movable) {
+		Result |= Movable;
+	}
+	return Result;
+}
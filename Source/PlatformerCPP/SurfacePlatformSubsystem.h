@@ -0,0 +1,78 @@
+// Copyright 2020 Ryan Gourley
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SurfacePlatformSubsystem.generated.h"
+
+class APlatformMaster;
+class UPrimitiveComponent;
+
+/**
+ * Every platform the player can Transport onto (the owners of a USurfacePlatformComponent), kept in dense arrays by surface id.
+ * The component adds its owner on BeginPlay and removes it on EndPlay, and the platform keeps its id, so "is this a surface" is a
+ * field read (APlatformMaster::IsSurface) instead of a component search on the hit actor.
+ * Removing a surface moves the last one into its slot, so ids always run 0 to GetNumSurfaces() - 1 and anything that wants every
+ * surface platform walks the arrays instead of iterating actors. Ids change on removal, don't keep them across frames.
+ * Instanced surface platforms are added by AInstancedPlatformManager as (component, instance) when the instance is added. They
+ * have no actor until a hit makes a proxy for them, so GetSurface returns null for them until then; GetSurfaceInstance always works.
+ */
+UCLASS()
+class PLATFORMERCPP_API USurfacePlatformSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	enum ESurfaceFlag : uint8 {
+		Instance = 1 << 0, //AInstancedPlatformManager instance, with or without a proxy
+		Movable = 1 << 1, //Root is movable, the bounds follow it
+	};
+
+	//Surface components add and remove their owner, platforms update their bounds when their root moves
+	void RegisterSurface(APlatformMaster* Platform);
+	void UpdateSurface(APlatformMaster* Platform);
+	void UnregisterSurface(APlatformMaster* Platform);
+
+	//Instanced surfaces, added and removed with the instance. A proxy made for one takes over its id instead of adding another.
+	void RegisterInstanceSurface(UPrimitiveComponent* Component, const int32 Instance, const FBox& InstanceBounds);
+	void UnregisterInstanceSurface(const UPrimitiveComponent* Component, const int32 Instance);
+
+	UFUNCTION(BlueprintCallable, Category = "Platform")
+		int32 GetNumSurfaces() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Surface platform with this id (0 to GetNumSurfaces - 1). None for an instanced surface the player hasn't touched yet."))
+		APlatformMaster* GetSurface(const int32 Id) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Instanced mesh and instance of the surface with this id. False for actor platforms."))
+		bool GetSurfaceInstance(const int32 Id, UPrimitiveComponent*& OutComponent, int32& OutInstance) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Cached world space bounds of the surface platform with this id."))
+		FBox GetSurfaceBounds(const int32 Id) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Platform", meta = (Tooltip = "Every surface platform, in id order. None for instanced surfaces without a proxy."))
+		void GetSurfaces(TArray<APlatformMaster*>& OutSurfaces) const;
+
+	//ESurfaceFlag bits of the surface with this id
+	uint8 GetSurfaceFlags(const int32 Id) const { return Flags.IsValidIndex(Id) ? Flags[Id] : 0; }
+
+	//Bounds and flags of every surface by id, for loops that don't need the actors
+	const TArray<FBox>& GetAllBounds() const { return Bounds; }
+	const TArray<uint8>& GetAllFlags() const { return Flags; }
+
+private:
+	typedef TPair<const UPrimitiveComponent*, int32> FInstanceKey;
+
+	//One entry per surface in each
+	TArray<TWeakObjectPtr<APlatformMaster>> Platforms;
+	TArray<FBox> Bounds;
+	TArray<uint8> Flags;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> InstanceComponents; //Null for actor platforms
+	TArray<int32> InstanceIndices; //INDEX_NONE for actor platforms
+
+	TMap<FInstanceKey, int32> InstanceIds;
+
+	int32 AddSurface(APlatformMaster* Platform, const FBox& SurfaceBounds, const uint8 SurfaceFlags, UPrimitiveComponent* Component, const int32 Instance);
+	void RemoveSurface(const int32 Id);
+	static uint8 GetFlagsOf(const APlatformMaster* Platform);
+};
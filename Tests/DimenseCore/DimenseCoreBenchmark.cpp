@@ -0,0 +1,117 @@
+// Copyright 2020 Ryan Gourley
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "DimenseCore.h"
+
+using namespace DimenseCore;
+
+//ns per call of each DimenseCore function, over inputs varied enough that nothing folds away.
+//Usage: DimenseCoreBenchmark [iterations]
+namespace {
+	volatile float FloatSink = 0.0f;
+	volatile int IntSink = 0;
+
+	template <typename FBody>
+	void Measure(const char* Name, const int Iterations, FBody&& Body){
+		//Warm up, then time
+		Body(Iterations / 10 + 1);
+		auto Start = std::chrono::steady_clock::now();
+		Body(Iterations);
+		auto End = std::chrono::steady_clock::now();
+		double Ns = std::chrono::duration<double, std::nano>(End - Start).count();
+		std::printf("%-32s %8.2f ns/call\n", Name, Ns / Iterations);
+	}
+}
+
+int main(int argc, char** argv){
+	int Iterations = argc > 1 ? std::atoi(argv[1]) : 10000000;
+	if (Iterations <= 0) {
+		Iterations = 10000000;
+	}
+	//Power of two so the index wraps with a mask
+	const int NumInputs = 1024;
+	std::vector<FVec3> Vectors(NumInputs);
+	std::vector<FVec3> Forwards(NumInputs);
+	std::vector<FVec3> Rights(NumInputs);
+	std::vector<int> Views(NumInputs);
+	std::vector<FViewBasis> Bases(NumInputs);
+	std::vector<int> Sides(NumInputs);
+	std::srand(1);
+	for (int i = 0; i < NumInputs; i++) {
+		float Jitter = float(std::rand() % 200 - 100) * 0.0004f;
+		Views[i] = std::rand() % 4;
+		Sides[i] = std::rand() % 2 ? 1 : -1;
+		FViewBasis Basis = GetViewBasis(Views[i]);
+		Bases[i] = Basis;
+		Forwards[i] = Basis.Forward * (1.0f - std::fabs(Jitter)) + Basis.Right * Jitter;
+		Rights[i] = Basis.Right * (1.0f - std::fabs(Jitter)) - Basis.Forward * Jitter;
+		Vectors[i] = FVec3(float(std::rand() % 2000 - 1000), float(std::rand() % 2000 - 1000), float(std::rand() % 2000 - 1000));
+	}
+	const FVec3 Padding(40.0f, 40.0f, 0.0f);
+	const int Mask = NumInputs - 1;
+
+	Measure("RoundVector", Iterations, [&](const int Count){
+		float Sum = 0.0f;
+		for (int i = 0; i < Count; i++) {
+			Sum += RoundVector(Forwards[i & Mask] * 0.7f).X;
+		}
+		FloatSink = Sum;
+	});
+	Measure("GetViewBasis(Forward, Right)", Iterations, [&](const int Count){
+		int Sum = 0;
+		for (int i = 0; i < Count; i++) {
+			Sum += GetViewBasis(Forwards[i & Mask], Rights[i & Mask]).CamSign;
+		}
+		IntSink = Sum;
+	});
+	Measure("GetViewBasis(int)", Iterations, [&](const int Count){
+		int Sum = 0;
+		for (int i = 0; i < Count; i++) {
+			Sum += GetViewBasis(Views[i & Mask]).CamSide;
+		}
+		IntSink = Sum;
+	});
+	Measure("GetMovementDirection", Iterations, [&](const int Count){
+		int Direction = 0;
+		for (int i = 0; i < Count; i++) {
+			Direction = GetMovementDirection(Vectors[i & Mask], Sides[i & Mask], Direction);
+		}
+		IntSink = Direction;
+	});
+	Measure("GetTransportOffset", Iterations, [&](const int Count){
+		float Sum = 0.0f;
+		for (int i = 0; i < Count; i++) {
+			const FViewBasis& Basis = Bases[i & Mask];
+			Sum += GetTransportOffset(Vectors[i & Mask], 50.0f, Vectors[(i + 1) & Mask], Basis.Forward, Padding, Basis.CamSide, Basis.CamSign, Sides[i & Mask]).X;
+		}
+		FloatSink = Sum;
+	});
+	Measure("GetMoveAroundOffset", Iterations, [&](const int Count){
+		float Sum = 0.0f;
+		for (int i = 0; i < Count; i++) {
+			const FViewBasis& Basis = Bases[i & Mask];
+			Sum += GetMoveAroundOffset(Vectors[i & Mask], Vectors[(i + 1) & Mask], Basis.Forward, Padding, Basis.CamSide, Basis.CamSign, Sides[i & Mask]).X;
+		}
+		FloatSink = Sum;
+	});
+	Measure("TView::TransportOffset", Iterations, [&](const int Count){
+		float Sum = 0.0f;
+		for (int i = 0; i < Count; i++) {
+			Sum += DispatchView(GetViewOrientation(Views[i & Mask]), [&](auto ViewType){
+				return decltype(ViewType)::TransportOffset(Vectors[i & Mask], Vectors[(i + 1) & Mask], Padding, Sides[i & Mask]).X;
+			});
+		}
+		FloatSink = Sum;
+	});
+	Measure("IsAbovePlatform", Iterations, [&](const int Count){
+		int Sum = 0;
+		for (int i = 0; i < Count; i++) {
+			Sum += IsAbovePlatform(Vectors[i & Mask].Z, Vectors[(i + 1) & Mask].Z, Sides[i & Mask] > 0) ? 1 : 0;
+		}
+		IntSink = Sum;
+	});
+	return 0;
+}
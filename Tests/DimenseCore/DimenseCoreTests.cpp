@@ -0,0 +1,142 @@
+// Copyright 2020 Ryan Gourley
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include "DimenseCore.h"
+
+using namespace DimenseCore;
+
+namespace {
+	int NumChecks = 0;
+	int NumFailures = 0;
+
+	void Check(const bool bPassed, const char* What, const int View, const int VisibilitySide){
+		NumChecks++;
+		if (!bPassed) {
+			NumFailures++;
+			std::printf("FAILED: %s (view %d, visibility side %d)\n", What, View, VisibilitySide);
+		}
+	}
+
+	void Check(const bool bPassed, const char* What){
+		Check(bPassed, What, -1, 0);
+	}
+
+	//Expected basis of each view index, worked out by hand from the spring arm yaw
+	struct FExpectedView {
+		FVec3 Forward;
+		FVec3 Right;
+		int CamSign;
+		int CamSide;
+	};
+
+	const FExpectedView ExpectedViews[4] = {
+		{ FVec3(1.0f, 0.0f, 0.0f), FVec3(0.0f, 1.0f, 0.0f), 1, 1 },
+		{ FVec3(0.0f, 1.0f, 0.0f), FVec3(-1.0f, 0.0f, 0.0f), -1, -1 },
+		{ FVec3(-1.0f, 0.0f, 0.0f), FVec3(0.0f, -1.0f, 0.0f), -1, 1 },
+		{ FVec3(0.0f, -1.0f, 0.0f), FVec3(1.0f, 0.0f, 0.0f), 1, -1 },
+	};
+
+	bool SameBasis(const FViewBasis& Basis, const FExpectedView& Expected){
+		return Basis.Forward == Expected.Forward && Basis.Right == Expected.Right && Basis.CamSign == Expected.CamSign && Basis.CamSide == Expected.CamSide;
+	}
+
+	void TestRoundVector(){
+		Check(RoundVector(FVec3(0.49f, -0.49f, 1.51f)) == FVec3(0.0f, 0.0f, 2.0f), "RoundVector rounds to nearest");
+		//Half up, as FMath::RoundToInt
+		Check(RoundVector(FVec3(0.5f, -0.5f, 1.5f)) == FVec3(1.0f, 0.0f, 2.0f), "RoundVector rounds halves up");
+		Check(RoundVector(FVec3(-0.51f, -1.5f, -2.5f)) == FVec3(-1.0f, -1.0f, -2.0f), "RoundVector negative values");
+		Check(RoundVector(FVec3(0.9999f, 0.0001f, -0.9999f)) == FVec3(1.0f, 0.0f, -1.0f), "RoundVector nearly unit camera vectors");
+	}
+
+	void TestGetViewBasis(){
+		for (int View = 0; View < 4; View++) {
+			const FExpectedView& Expected = ExpectedViews[View];
+			Check(SameBasis(GetViewBasis(View), Expected), "GetViewBasis(int)", View, 0);
+			Check(SameBasis(GetViewBasis(View + 4), Expected) && SameBasis(GetViewBasis(View - 4), Expected), "GetViewBasis(int) wraps", View, 0);
+			//A camera a hair off the axis, as the spring arm leaves it mid lerp
+			FVec3 Forward = Expected.Forward * 0.999f + Expected.Right * 0.04f;
+			FVec3 Right = Expected.Right * 0.999f - Expected.Forward * 0.04f;
+			Check(SameBasis(GetViewBasis(Forward, Right), Expected), "GetViewBasis(Forward, Right) snaps to the axes", View, 0);
+			Check(GetViewIndex(Expected.Forward) == View, "GetViewIndex", View, 0);
+			Check(GetViewOrientation(View) == static_cast<EViewOrientation>(View) && GetViewOrientation(View - 4) == static_cast<EViewOrientation>(View), "GetViewOrientation", View, 0);
+		}
+	}
+
+	template <EViewOrientation View>
+	void TestViewConstants(){
+		const FExpectedView& Expected = ExpectedViews[static_cast<int>(View)];
+		const int Index = static_cast<int>(View);
+		Check(TView<View>::CamSign == Expected.CamSign && TView<View>::CamSide == Expected.CamSide, "TView signs", Index, 0);
+		Check(TView<View>::Forward(1.0f) == Expected.Forward && TView<View>::Right(1.0f) == Expected.Right, "TView basis", Index, 0);
+		Check(TView<View>::RightAndForward(2.0f, 3.0f) == Expected.Right * 2.0f + Expected.Forward * 3.0f, "TView RightAndForward", Index, 0);
+	}
+
+	void TestGetMovementDirection(){
+		for (int View = 0; View < 4; View++) {
+			FViewBasis Basis = GetViewBasis(View);
+			for (int Previous = -1; Previous <= 1; Previous++) {
+				Check(GetMovementDirection(Basis.Right * 600.0f, Basis.CamSign, Previous) == 1, "GetMovementDirection right", View, 0);
+				Check(GetMovementDirection(Basis.Right * -600.0f, Basis.CamSign, Previous) == -1, "GetMovementDirection left", View, 0);
+				Check(GetMovementDirection(Basis.Right * 600.0f + FVec3(0.0f, 0.0f, -900.0f), Basis.CamSign, Previous) == 1, "GetMovementDirection right while falling", View, 0);
+				Check(GetMovementDirection(FVec3(), Basis.CamSign, Previous) == 0, "GetMovementDirection standing still", View, 0);
+				//No horizontal motion is standing still, jumping in place included
+				Check(GetMovementDirection(FVec3(0.0f, 0.0f, 900.0f), Basis.CamSign, Previous) == 0, "GetMovementDirection vertical only", View, 0);
+				//The only way to keep Previous: no comparison holds
+				const float NaN = std::numeric_limits<float>::quiet_NaN();
+				Check(GetMovementDirection(FVec3(NaN, NaN, 0.0f), Basis.CamSign, Previous) == Previous, "GetMovementDirection keeps Previous", View, 0);
+			}
+		}
+	}
+
+	void TestOffsets(){
+		const FVec3 HitLocation(100.0f, 200.0f, 0.0f);
+		const float TopZ = 50.0f;
+		const FVec3 Location(10.0f, 20.0f, 30.0f);
+		const FVec3 Padding(40.0f, 40.0f, 0.0f);
+		//Camera axis component of each offset, by view then visibility side (-1, 1). Worked out by hand.
+		const float TransportExpected[4][2] = { { 50.0f, 130.0f }, { 140.0f, 220.0f }, { 130.0f, 50.0f }, { 220.0f, 140.0f } };
+		const float MoveAroundExpected[4][2] = { { 130.0f, 50.0f }, { 220.0f, 140.0f }, { 50.0f, 130.0f }, { 140.0f, 220.0f } };
+		for (int View = 0; View < 4; View++) {
+			FViewBasis Basis = GetViewBasis(View);
+			int Axis = View % 2;
+			for (int VisibilitySide = -1; VisibilitySide <= 1; VisibilitySide += 2) {
+				int Side = VisibilitySide > 0 ? 1 : 0;
+				FVec3 Transport = GetTransportOffset(HitLocation, TopZ, Location, Basis.Forward, Padding, Basis.CamSide, Basis.CamSign, VisibilitySide);
+				FVec3 TransportWanted = Axis == 0 ? FVec3(TransportExpected[View][Side], 0.0f, 0.0f) : FVec3(0.0f, TransportExpected[View][Side], 0.0f);
+				Check(Transport == TransportWanted, "GetTransportOffset", View, VisibilitySide);
+				FVec3 MoveAround = GetMoveAroundOffset(HitLocation, Location, Basis.Forward, Padding, Basis.CamSide, Basis.CamSign, VisibilitySide);
+				FVec3 MoveAroundWanted = Axis == 0 ? FVec3(MoveAroundExpected[View][Side], 0.0f, 0.0f) : FVec3(0.0f, MoveAroundExpected[View][Side], 0.0f);
+				Check(MoveAround == MoveAroundWanted, "GetMoveAroundOffset", View, VisibilitySide);
+				//The templated hot path must agree with the FVec3 version
+				DispatchView(GetViewOrientation(View), [&](auto ViewType){
+					typedef decltype(ViewType) FView;
+					Check(FView::TransportOffset(HitLocation, Location, Padding, VisibilitySide) == Transport, "TView::TransportOffset matches", View, VisibilitySide);
+					Check(FView::MoveAroundOffset(HitLocation, Location, Padding, VisibilitySide) == MoveAround, "TView::MoveAroundOffset matches", View, VisibilitySide);
+				});
+			}
+		}
+	}
+
+	void TestIsAbovePlatform(){
+		Check(IsAbovePlatform(100.0f, 50.0f, false), "IsAbovePlatform feet above");
+		Check(IsAbovePlatform(50.0f, 50.0f, false), "IsAbovePlatform feet level with the top");
+		Check(!IsAbovePlatform(49.0f, 50.0f, false), "IsAbovePlatform feet below");
+		Check(IsAbovePlatform(-100.0f, 50.0f, true), "IsAbovePlatform standing on it");
+	}
+}
+
+int main(){
+	TestRoundVector();
+	TestGetViewBasis();
+	TestViewConstants<EViewOrientation::PosX>();
+	TestViewConstants<EViewOrientation::PosY>();
+	TestViewConstants<EViewOrientation::NegX>();
+	TestViewConstants<EViewOrientation::NegY>();
+	TestGetMovementDirection();
+	TestOffsets();
+	TestIsAbovePlatform();
+	std::printf("%d checks, %d failed\n", NumChecks, NumFailures);
+	return NumFailures == 0 ? 0 : 1;
+}